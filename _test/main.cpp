@@ -1,12 +1,27 @@
 #include <iostream>
 #include <chrono>
 #include <vector>
+#include <set>
+#include <mutex>
+#include <string>
+#include <map>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
 
 #include "./handler/testHandler.hpp"
 #include "../include/NEAT/Population.hpp"
 #include "../include/NEAT/SpeciesHandler.hpp"
 #include "../include/NEAT/Species.hpp"
 #include "../include/NEAT/Genome.hpp"
+#include "../include/NEAT/FlatGenome.hpp"
+#include "../include/NEAT/NativeGenome.hpp"
+#include "../include/NEAT/HeaderExporter.hpp"
+#include "../include/NEAT/SimdKernels.hpp"
 #include "../include/NEAT/Activation.hpp"
 #include "../include/NEAT/GeneHistory.hpp"
 #include "../include/NEAT/Helper.hpp"
@@ -16,6 +31,12 @@
 void testForGenome();
 void crossOverTest();
 void populationTest(int);
+bool populationEvaluateTest();
+bool flatGenomeTest();
+bool nativeGenomeTest();
+bool simdKernelsTest();
+bool evaluationModeTest();
+bool headerExporterTest();
 template <typename dType, typename T2>
 void forceSkipGeneration(NEAT::TestHandler<dType, T2>* testHandler, NEAT::Population<dType, T2>* population, int n);
 template <typename dType, typename T2>
@@ -24,8 +45,15 @@ template <typename dType, typename T2>
 void EnvTest_XOR(NEAT::TestHandler<dType, T2>* testHandler, NEAT::Population<dType, T2>* population, int n);
 
 int main() {
+    bool passed = true;
+    passed &= populationEvaluateTest();
+    passed &= flatGenomeTest();
+    passed &= nativeGenomeTest();
+    passed &= simdKernelsTest();
+    passed &= evaluationModeTest();
+    passed &= headerExporterTest();
     populationTest(2);
-    return 0;
+    return passed ? 0 : 1;
     NEAT::ActivationFunction_Factory<>* AfFactory = NEAT::getActivationFunction_Factory<>();
     const int inputSize = 2;
     const int outputSize = 1;
@@ -117,8 +145,7 @@ void EnvTest_XOR(NEAT::TestHandler<dType, T2>* testHandler, NEAT::Population<dTy
 };
 
 template <typename dType, typename T2>
-void forceMutate(NEAT::Genome<dType, T2>* genome) {
-    NEAT::GeneHistory<dType, T2> geneHistory;
+void forceMutate(NEAT::Genome<dType, T2>* genome, NEAT::GeneHistory<dType, T2>& geneHistory) {
     genome->mutate(geneHistory);
 };
 
@@ -207,7 +234,7 @@ void testForGenome() {
     NEAT::GeneHistory<double, int> geneHistory;
     geneHistory.init(inputSize, outputSize);
     for (int i = 0; i < 1000; i++) {
-        forceMutate(dynamicGenome);
+        forceMutate(dynamicGenome, geneHistory);
     }
     std::cout << "mutated genome" << std::endl;
     dynamicGenome->print();
@@ -219,3 +246,427 @@ void testForGenome() {
     delete dynamicGenome;
 }
 
+/**
+ * @brief Report a failed check
+ *
+ * @return bool the condition
+ */
+bool expect(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cout << "FAILED: " << message << std::endl;
+    }
+    return condition;
+}
+
+bool populationEvaluateTest() {
+    bool passed = true;
+    NEAT::Population<double, int> population(3, 2, 40, NEAT::MutationConfig<double>(), NEAT::SpeciesConfig<double>());
+    for (unsigned int numThreads : { 1u, 4u }) {
+        // the fitness function must see the genomes of the population, not copies
+        std::set<const NEAT::Genome<double, int>*> seen;
+        std::mutex seenMutex;
+        population.evaluate([&](NEAT::Genome<double, int>& genome) {
+            std::lock_guard<std::mutex> lock(seenMutex);
+            seen.insert(&genome);
+            return static_cast<double>(genome.getEdges().size()) + 0.25;
+            }, numThreads);
+        const std::vector<NEAT::Genome<double, int>*>& genomes = population.getGenomes();
+        passed &= expect(seen == std::set<const NEAT::Genome<double, int>*>(genomes.begin(), genomes.end()), "evaluate passes every genome once by reference");
+        for (NEAT::Genome<double, int>* genome : genomes) {
+            passed &= expect(genome->getFitness() == static_cast<double>(genome->getEdges().size()) + 0.25, "evaluate sets the returned fitness");
+        }
+        population.startNextGeneration();
+    }
+    std::cout << "Population evaluate Test Done." << std::endl;
+    return passed;
+}
+
+bool flatGenomeTest() {
+    bool passed = true;
+    NEAT::GeneHistory<double, int> geneHistory;
+    geneHistory.init(4, 3);
+    const NEAT::MutationConfig<double> mutationConfig = { 0.3, 0.5, 0.1, 0.8, 0.2, 0.5 };
+    const std::vector<double> inputs = { 0.5, -1, 0.25, 2 };
+    // the genome is mutated as flat genes, its clones share them until then
+    NEAT::Genome<double, int> genome(4, 3);
+    std::vector<NEAT::Genome<double, int>*> clones;
+    std::vector<std::vector<double>> cloneOutputs;
+    for (int i = 0; i < 200; i++) {
+        if (i % 20 == 0) {
+            clones.push_back(genome.clone());
+            cloneOutputs.push_back(genome.feedForward(inputs));
+        }
+        genome.mutate(geneHistory, mutationConfig);
+    }
+    for (std::size_t i = 0; i < clones.size(); i++) {
+        passed &= expect(clones[i]->feedForward(inputs) == cloneOutputs[i], "mutation does not change the genes of a clone");
+        delete clones[i];
+    }
+    const NEAT::FlatGenome<double, int>& genes = genome.getFlatGenome();
+    const std::vector<std::uint32_t>& nodeOrder = genes.getNodeOrder();
+    passed &= expect(genes.getNodeCount() > 7 && nodeOrder.size() == genes.getNodeCount(), "mutation adds nodes to the flat genes");
+    for (std::uint32_t i = 0; i < genes.getEdgeCount(); i++) {
+        passed &= expect(nodeOrder[genes.getEdgeFrom()[i]] < nodeOrder[genes.getEdgeTo()[i]], "the topological order of the flat genes holds for every edge");
+    }
+    // the nodes and edges built from the flat genes have the same genes
+    const std::vector<double> outputs = genome.feedForward(inputs);
+    passed &= expect(genome.getNumberOfGenes() == static_cast<int>(genome.getNodes().size() + genome.getEdges().size()), "nodes and edges are built from the flat genes");
+    const NEAT::FlatGenome<double, int> rebuilt(genome);
+    passed &= expect(rebuilt.getNodeIds() == genes.getNodeIds() && rebuilt.getNodeBiases() == genes.getNodeBiases()
+        && rebuilt.getNodeActivations() == genes.getNodeActivations() && rebuilt.getInnovations() == genes.getInnovations()
+        && rebuilt.getEdgeFrom() == genes.getEdgeFrom() && rebuilt.getEdgeTo() == genes.getEdgeTo()
+        && rebuilt.getEdgeWeights() == genes.getEdgeWeights(), "nodes and edges match the flat genes");
+    for (std::uint32_t i = 0; i < genes.getEdgeCount(); i++) {
+        passed &= expect(rebuilt.isEnabled(i) == genes.isEnabled(i), "enabled flags match the flat genes");
+    }
+    genome.invalidateCache();
+    passed &= expect(genome.feedForward(inputs) == outputs, "nodes and edges evaluate as the flat genes");
+    std::cout << "Flat Genome Test Done." << std::endl;
+    return passed;
+}
+
+/**
+ * @brief Check that two outputs are the same bits, any NaN matches any NaN
+ *
+ */
+template <typename dType>
+bool sameBits(dType a, dType b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return std::memcmp(&a, &b, sizeof(dType)) == 0;
+}
+
+template <typename dType>
+bool nativeGenomeTest(NEAT::GeneHistory<dType, int>& geneHistory) {
+    bool passed = true;
+    const NEAT::MutationConfig<dType> mutationConfig = { 0.3, 0.5, 0.1, 0.8, 0.2, 0.5 };
+    NEAT::Genome<dType, int> genome(3, 2);
+    for (int i = 0; i < 60; i++) {
+        genome.mutate(geneHistory, mutationConfig);
+    }
+    // an enabled edge of weight 0 from an input to an output, 0 * inf is NaN, the initial edges are never removed
+    NEAT::Edge<dType, int>* zeroWeight = genome.getEdge(0);
+    zeroWeight->enable();
+    zeroWeight->setWeight(0);
+    genome.invalidateCache();
+    // the same genome is compiled from several threads at once
+    std::vector<std::unique_ptr<NEAT::NativeGenome<dType, int>>> natives(4);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < natives.size(); i++) {
+        threads.emplace_back([&natives, &genome, i]() { natives[i].reset(new NEAT::NativeGenome<dType, int>(genome)); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const dType inf = std::numeric_limits<dType>::infinity();
+    const dType nan = std::numeric_limits<dType>::quiet_NaN();
+    const std::vector<std::vector<dType>> inputs = {
+        { 0.5, -1, 2 }, { inf, 0, 0 }, { 0, inf, 0 }, { 0, 0, -inf }, { -inf, nan, 0 }, { nan, nan, nan }, { -0.0, -0.0, -0.0 }, { 1e30, -1e30, 1e-30 },
+    };
+    NEAT::ActivationWorkspace<dType> workspace;
+    for (const std::unique_ptr<NEAT::NativeGenome<dType, int>>& native : natives) {
+        passed &= expect(native->isNative(), "the genome is compiled");
+        for (const std::vector<dType>& input : inputs) {
+            std::vector<dType> expected(2), actual(2);
+            genome.getExecutionPlan().evaluate(input.data(), expected.data(), workspace);
+            native->evaluate(input.data(), actual.data());
+            passed &= expect(sameBits(expected[0], actual[0]) && sameBits(expected[1], actual[1]), "native code computes the values of the execution plan");
+        }
+    }
+    return passed;
+}
+
+bool nativeGenomeTest() {
+    if (!NEAT::NativeCodeCache::isAvailable()) {
+        std::cout << "Native Genome Test Skipped, no compiler." << std::endl;
+        return true;
+    }
+    bool passed = true;
+    const std::string previousDirectory = NEAT::NativeCodeCache::getDirectory();
+    // a quote in the directory has to reach the compiler intact
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "neatcpy-test's cache";
+    std::filesystem::remove_all(directory);
+    NEAT::NativeCodeCache::setDirectory(directory.string());
+    NEAT::GeneHistory<double, int> geneHistory;
+    geneHistory.init(3, 2);
+    passed &= nativeGenomeTest<double>(geneHistory);
+    NEAT::GeneHistory<float, int> geneHistoryFloat;
+    geneHistoryFloat.init(3, 2);
+    passed &= nativeGenomeTest<float>(geneHistoryFloat);
+    NEAT::NativeCodeCache::setDirectory(previousDirectory);
+    std::filesystem::remove_all(directory);
+    std::cout << "Native Genome Test Done." << std::endl;
+    return passed;
+}
+
+/**
+ * @brief Reference of SimdKernels::weightedSum and laneWeightedSum, edges added in order without fused multiply-add
+ *
+ */
+template <typename dType>
+void referenceWeightedSum(std::vector<dType>& target, const std::vector<dType>& biases, const std::vector<std::vector<dType>>& sources, const std::vector<dType>& weights, bool lanes) {
+    const std::size_t count = target.size();
+    for (std::size_t i = 0; i < count; i++) {
+        target[i] += biases[lanes ? i : 0];
+    }
+    for (std::size_t e = 0; e < sources.size(); e++) {
+        for (std::size_t i = 0; i < count; i++) {
+            target[i] += weights[lanes ? e * count + i : e] * sources[e][i];
+        }
+    }
+}
+
+template <typename dType>
+bool simdKernelsTest(NEAT::InstructionSet instructionSet, dType tolerance) {
+    bool passed = true;
+    const dType inf = std::numeric_limits<dType>::infinity();
+    const dType nan = std::numeric_limits<dType>::quiet_NaN();
+    // dense sweep over the range where sigmoid and tanh are not saturated, then special values in the padded tail
+    std::vector<dType> values;
+    for (int i = -40 * 256; i <= 40 * 256; i++) {
+        values.push_back(static_cast<dType>(i) / 256);
+    }
+    for (dType value : { inf, -inf, nan, static_cast<dType>(-0.0), static_cast<dType>(1000), static_cast<dType>(-1000),
+        std::numeric_limits<dType>::max(), std::numeric_limits<dType>::lowest(), std::numeric_limits<dType>::denorm_min() }) {
+        values.push_back(value);
+    }
+    for (NEAT::ActivationType type : { NEAT::ActivationType::SIGMOID, NEAT::ActivationType::TANH, NEAT::ActivationType::RELU,
+        NEAT::ActivationType::STEP, NEAT::ActivationType::IDENTITY }) {
+        std::vector<dType> activated = values;
+        NEAT::SimdKernels::activate(type, activated.data(), activated.size());
+        const bool exact = type != NEAT::ActivationType::SIGMOID && type != NEAT::ActivationType::TANH;
+        bool withinTolerance = true;
+        for (std::size_t i = 0; i < values.size(); i++) {
+            const dType expected = NEAT::applyActivation(type, values[i]);
+            if (exact || std::isnan(expected) || std::isinf(expected)) {
+                withinTolerance &= sameBits(expected, activated[i]);
+            } else {
+                withinTolerance &= std::fabs(expected - activated[i]) <= tolerance;
+            }
+        }
+        passed &= expect(withinTolerance, "vectorized activation " + std::to_string(static_cast<int>(type)) + " of instruction set "
+            + std::to_string(static_cast<int>(instructionSet)) + " matches the scalar fallback");
+    }
+    // weighted sums, a count that leaves a tail for every width, with infinities, NaN and negative zero as sources
+    const std::size_t count = 37;
+    const std::size_t edgeCount = 6;
+    std::vector<std::vector<dType>> sources(edgeCount, std::vector<dType>(count));
+    std::vector<dType> weights(edgeCount * count), biases(count), initial(count);
+    for (std::size_t i = 0; i < count; i++) {
+        biases[i] = NEAT::uniformDistribution<dType>(-1, 1);
+        initial[i] = NEAT::uniformDistribution<dType>(-1, 1);
+        for (std::size_t e = 0; e < edgeCount; e++) {
+            sources[e][i] = NEAT::uniformDistribution<dType>(-10, 10);
+            weights[e * count + i] = NEAT::uniformDistribution<dType>(-2, 2);
+        }
+    }
+    sources[0][3] = inf;
+    sources[1][5] = -inf;
+    sources[2][7] = nan;
+    sources[3][count - 1] = static_cast<dType>(-0.0);
+    std::vector<const dType*> sourcePointers;
+    for (const std::vector<dType>& source : sources) {
+        sourcePointers.push_back(source.data());
+    }
+    // mul and add are exact against the reference, fused multiply-add only changes the rounding of each step
+    const bool fused = instructionSet >= NEAT::InstructionSet::AVX2;
+    for (bool lanes : { false, true }) {
+        std::vector<dType> expected = initial, actual = initial;
+        referenceWeightedSum(expected, biases, sources, weights, lanes);
+        if (lanes) {
+            NEAT::SimdKernels::laneWeightedSum(actual.data(), count, biases.data(), sourcePointers.data(), weights.data(), edgeCount);
+        } else {
+            NEAT::SimdKernels::weightedSum(actual.data(), count, biases[0], sourcePointers.data(), weights.data(), edgeCount);
+        }
+        bool matches = true;
+        for (std::size_t i = 0; i < count; i++) {
+            if (!fused || std::isnan(expected[i]) || std::isinf(expected[i])) {
+                matches &= sameBits(expected[i], actual[i]);
+                continue;
+            }
+            dType magnitude = std::fabs(initial[i]) + std::fabs(biases[lanes ? i : 0]);
+            for (std::size_t e = 0; e < edgeCount; e++) {
+                magnitude += std::fabs(weights[lanes ? e * count + i : e] * sources[e][i]);
+            }
+            matches &= std::fabs(expected[i] - actual[i]) <= 2 * edgeCount * std::numeric_limits<dType>::epsilon() * magnitude;
+        }
+        passed &= expect(matches, std::string(lanes ? "laneWeightedSum" : "weightedSum") + " of instruction set "
+            + std::to_string(static_cast<int>(instructionSet)) + " matches the scalar fallback");
+    }
+    return passed;
+}
+
+bool simdKernelsTest() {
+    bool passed = true;
+    const NEAT::InstructionSet previous = NEAT::SimdKernels::getInstructionSet();
+    for (NEAT::InstructionSet instructionSet : { NEAT::InstructionSet::SCALAR, NEAT::InstructionSet::SSE2, NEAT::InstructionSet::AVX2, NEAT::InstructionSet::AVX512 }) {
+        // instruction sets the cpu does not support are capped, and tested as the supported one
+        if (NEAT::SimdKernels::setInstructionSet(instructionSet) != instructionSet) continue;
+        passed &= simdKernelsTest<double>(instructionSet, NEAT::SimdKernels::TOLERANCE);
+        passed &= simdKernelsTest<float>(instructionSet, NEAT::SimdKernels::TOLERANCE_FLOAT);
+    }
+    NEAT::SimdKernels::setInstructionSet(previous);
+    std::cout << "Simd Kernels Test Done." << std::endl;
+    return passed;
+}
+
+template <typename dType>
+bool evaluationModeTest(dType tolerance) {
+    bool passed = true;
+    const int inputSize = 5;
+    const int outputSize = 3;
+    // few structural mutations, so that many genomes share a structure and form groups
+    const NEAT::MutationConfig<dType> mutationConfig = { 0.05, 0.05, 0.05, 0.8, 0.2, 0.5 };
+    NEAT::Population<dType, int> population(inputSize, outputSize, 120, mutationConfig, NEAT::SpeciesConfig<dType>());
+    for (int generation = 0; generation < 3; generation++) {
+        population.evaluate([](NEAT::Genome<dType, int>& genome) {
+            return static_cast<dType>(1 + genome.getNumberOfGenes() % 7);
+            }, 1);
+        population.startNextGeneration();
+    }
+    const std::vector<NEAT::Genome<dType, int>*>& genomes = population.getGenomes();
+    std::map<std::vector<std::uint32_t>, std::size_t> structures;
+    std::size_t largestStructure = 0;
+    for (NEAT::Genome<dType, int>* genome : genomes) {
+        const NEAT::ExecutionPlan<dType, int>& plan = genome->getExecutionPlan();
+        std::vector<std::uint32_t> key(plan.getEdgeOffsets());
+        key.insert(key.end(), plan.getEdgeSources().begin(), plan.getEdgeSources().end());
+        for (NEAT::ActivationType type : plan.getActivations()) {
+            key.push_back(static_cast<std::uint32_t>(type));
+        }
+        largestStructure = std::max(largestStructure, ++structures[key]);
+    }
+    // a topology group has at least 4 genomes
+    passed &= expect(largestStructure >= 4, "at least 4 genomes share a structure");
+    std::vector<dType> observations(genomes.size() * inputSize);
+    for (dType& observation : observations) {
+        observation = NEAT::uniformDistribution<dType>(-3, 3);
+    }
+    // structural and weight mutations of a changed genome make its next plan differ from the one of the last step
+    const NEAT::MutationConfig<dType> changeConfig = { 0.5, 0.5, 0.5, 1, 0.5, 1 };
+    NEAT::ActivationWorkspace<dType> workspace;
+    const NEAT::InstructionSet previous = NEAT::SimdKernels::getInstructionSet();
+    for (NEAT::InstructionSet instructionSet : { NEAT::InstructionSet::SCALAR, NEAT::SimdKernels::getSupportedInstructionSet() }) {
+        NEAT::SimdKernels::setInstructionSet(instructionSet);
+        const std::string setName = "instruction set " + std::to_string(static_cast<int>(instructionSet));
+        for (unsigned int numThreads : { 1u, 4u }) {
+            for (int round = 0; round < 2; round++) {
+                std::vector<dType> expected(genomes.size() * outputSize);
+                for (std::size_t i = 0; i < genomes.size(); i++) {
+                    genomes[i]->getExecutionPlan().evaluate(observations.data() + i * inputSize, expected.data() + i * outputSize, workspace);
+                }
+                for (NEAT::EvaluationMode mode : { NEAT::EvaluationMode::TOPOLOGY_GROUPS, NEAT::EvaluationMode::POPULATION_GRAPH }) {
+                    population.setEvaluationMode(mode);
+                    const std::vector<dType> actions = population.step(observations, numThreads);
+                    bool matches = true;
+                    for (std::size_t i = 0; i < expected.size(); i++) {
+                        if (instructionSet == NEAT::InstructionSet::SCALAR) {
+                            // the scalar kernels add and activate in the order of the plan
+                            matches &= sameBits(expected[i], actions[i]);
+                            continue;
+                        }
+                        // the error of the fused sums and the polynomial activations compounds once per slot of the plan
+                        const std::size_t slots = genomes[i / outputSize]->getExecutionPlan().getNodeCount();
+                        matches &= std::fabs(expected[i] - actions[i]) <= tolerance * slots * std::max<dType>(1, std::fabs(expected[i]));
+                    }
+                    passed &= expect(matches, "step of evaluation mode " + std::to_string(static_cast<int>(mode)) + " with " + setName + ", "
+                        + std::to_string(numThreads) + " threads in round " + std::to_string(round) + " matches the execution plans");
+                }
+                for (std::size_t i = 0; i < genomes.size(); i += 3) {
+                    genomes[i]->mutate(population.getGeneHistory(), changeConfig);
+                }
+            }
+        }
+    }
+    NEAT::SimdKernels::setInstructionSet(previous);
+    population.setEvaluationMode(NEAT::EvaluationMode::TOPOLOGY_GROUPS);
+    return passed;
+}
+
+bool evaluationModeTest() {
+    bool passed = true;
+    passed &= evaluationModeTest<double>(4.4e-16);
+    passed &= evaluationModeTest<float>(2.4e-7f);
+    std::cout << "Evaluation Mode Test Done." << std::endl;
+    return passed;
+}
+
+/**
+ * @brief Quote a path for the shell
+ *
+ */
+std::string shellPath(const std::filesystem::path& path) {
+    std::string quoted = "'";
+    for (char c : path.string()) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+bool headerExporterTest() {
+    if (!NEAT::NativeCodeCache::isAvailable()) {
+        std::cout << "Header Exporter Test Skipped, no compiler." << std::endl;
+        return true;
+    }
+    bool passed = true;
+    NEAT::GeneHistory<float, int> geneHistory;
+    geneHistory.init(3, 2);
+    const NEAT::MutationConfig<float> mutationConfig = { 0.3, 0.5, 0.1, 0.8, 0.2, 0.5 };
+    NEAT::Genome<float, int> genome(3, 2);
+    for (int i = 0; i < 60; i++) {
+        genome.mutate(geneHistory, mutationConfig);
+    }
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "neatcpy-header-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    NEAT::HeaderExporter<float, int>::write(genome, (directory / "exported.hpp").string(), "exported");
+    // the driver reads input rows and prints the outputs of the header exactly
+    std::ofstream(directory / "driver.cpp") << "#include <cstdio>\n"
+        << "#include \"exported.hpp\"\n"
+        << "int main() {\n"
+        << "    float inputs[exported::INPUT_SIZE], outputs[exported::OUTPUT_SIZE];\n"
+        << "    while (true) {\n"
+        << "        for (std::size_t i = 0; i < exported::INPUT_SIZE; i++) {\n"
+        << "            if (std::scanf(\"%a\", &inputs[i]) != 1) return 0;\n"
+        << "        }\n"
+        << "        exported::evaluate(inputs, outputs);\n"
+        << "        for (std::size_t i = 0; i < exported::OUTPUT_SIZE; i++) {\n"
+        << "            std::printf(\"%a\\n\", outputs[i]);\n"
+        << "        }\n"
+        << "    }\n"
+        << "}\n";
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<std::vector<float>> inputs = {
+        { 0.5f, -1, 2 }, { inf, 0, 0 }, { 0, -inf, nan }, { -0.0f, -0.0f, -0.0f }, { 1e30f, -1e30f, 1e-30f },
+    };
+    for (int i = 0; i < 20; i++) {
+        inputs.push_back({ NEAT::uniformDistribution<float>(-3, 3), NEAT::uniformDistribution<float>(-3, 3), NEAT::uniformDistribution<float>(-3, 3) });
+    }
+    {
+        std::ofstream inputFile(directory / "inputs.txt");
+        char buffer[64];
+        for (const std::vector<float>& input : inputs) {
+            for (float value : input) {
+                std::snprintf(buffer, sizeof(buffer), "%a\n", value);
+                inputFile << buffer;
+            }
+        }
+    }
+    // the header has to compile as C++11
+    const std::string command = NEAT::NativeCodeCache::getCompiler() + " -std=c++11 -O2 -o " + shellPath(directory / "driver") + " " + shellPath(directory / "driver.cpp")
+        + " && " + shellPath(directory / "driver") + " < " + shellPath(directory / "inputs.txt") + " > " + shellPath(directory / "outputs.txt");
+    passed &= expect(std::system(command.c_str()) == 0, "the exported header compiles and runs");
+    std::ifstream outputFile(directory / "outputs.txt");
+    for (const std::vector<float>& input : inputs) {
+        const std::vector<float> expected = genome.feedForward(input);
+        for (float value : expected) {
+            std::string token;
+            outputFile >> token;
+            passed &= expect(!token.empty() && sameBits(value, std::strtof(token.c_str(), nullptr)), "the exported header computes the outputs of feedForward");
+        }
+    }
+    outputFile.close();
+    std::filesystem::remove_all(directory);
+    std::cout << "Header Exporter Test Done." << std::endl;
+    return passed;
+}
@@ -2,6 +2,12 @@
 #define __NEAT_ACTIVATION_HPP__
 
 #include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <math.h>
 #include "./Helper.hpp"
 
@@ -9,7 +15,56 @@ namespace NEAT {
 
     // forward declaration
     template <typename dType>
-    struct ActivationFunction_Factory;
+    class ActivationFunction_Factory;
+
+    /**
+     * @brief Tag of the activation function of a node
+     *
+     * Built-in activations are applied through a switch over the tag, so they can be inlined into the evaluation loops.
+     * Tags from USER_DEFINED on are handed out by ActivationFunction_Factory::registerActivationFunction.
+     */
+    enum class ActivationType : std::uint8_t {
+        SIGMOID,
+        TANH,
+        RELU,
+        STEP,
+        IDENTITY,
+        USER_DEFINED
+    };
+
+    /**
+     * @brief Compile-time kernel of a built-in activation function
+     *
+     * @tparam type tag of the activation function
+     * @tparam dType data type of the input and output
+     */
+    template <ActivationType type, typename dType>
+    struct ActivationKernel;
+
+    template <typename dType>
+    struct ActivationKernel<ActivationType::SIGMOID, dType> {
+        static dType apply(dType x) { return 1 / (1 + exp(-x)); }
+    };
+
+    template <typename dType>
+    struct ActivationKernel<ActivationType::TANH, dType> {
+        static dType apply(dType x) { return tanh(x); }
+    };
+
+    template <typename dType>
+    struct ActivationKernel<ActivationType::RELU, dType> {
+        static dType apply(dType x) { return x > 0 ? x : 0; }
+    };
+
+    template <typename dType>
+    struct ActivationKernel<ActivationType::STEP, dType> {
+        static dType apply(dType x) { return x > 0 ? 1 : 0; }
+    };
+
+    template <typename dType>
+    struct ActivationKernel<ActivationType::IDENTITY, dType> {
+        static dType apply(dType x) { return x; }
+    };
 
     // Base class for all activation functions
     template <typename dType = double>
@@ -18,7 +73,7 @@ namespace NEAT {
     };
 
     /**
-     * @brief Abstract class for all single input activation functions
+     * @brief Abstract class for all single input activation functions, base of user-defined activation functions
      *
      * @tparam dType data type of the input and output
      */
@@ -41,117 +96,122 @@ namespace NEAT {
         virtual std::vector<dType> operator()(std::vector<dType>) = 0;
     };
 
-    template <typename dType = double>
-    struct Sigmoid final : public ActivationFunction_Single<dType> {
+    /**
+     * @brief Object form of a built-in activation function, evaluates the same kernel as the tag
+     *
+     * @tparam type tag of the activation function
+     * @tparam dType data type of the input and output
+     */
+    template <ActivationType type, typename dType = double>
+    struct BuiltinActivationFunction final : public ActivationFunction_Single<dType> {
         dType operator()(dType x) override {
-            return 1 / (1 + exp(-x));
+            return ActivationKernel<type, dType>::apply(x);
         }
     private:
-        template <typename dType2>
-        friend ActivationFunction_Factory<dType2>* getActivationFunction_Factory();
-        Sigmoid() = default;
-        Sigmoid(const Sigmoid&) = delete;
-        Sigmoid& operator=(const Sigmoid&) = delete;
+        friend class ActivationFunction_Factory<dType>;
+        BuiltinActivationFunction() = default;
+        BuiltinActivationFunction(const BuiltinActivationFunction&) = delete;
+        BuiltinActivationFunction& operator=(const BuiltinActivationFunction&) = delete;
     };
 
     template <typename dType = double>
-    struct Tanh final : public ActivationFunction_Single<dType> {
-        dType operator()(dType x) override {
-            return (exp(x) - exp(-x)) / (exp(x) + exp(-x));
-        }
-    private:
-        template <typename dType2>
-        friend ActivationFunction_Factory<dType2>* getActivationFunction_Factory();
-        Tanh() = default;
-        Tanh(const Tanh&) = delete;
-        Tanh& operator=(const Tanh&) = delete;
-
-    };
-
+    using Sigmoid = BuiltinActivationFunction<ActivationType::SIGMOID, dType>;
     template <typename dType = double>
-    struct ReLU final : public ActivationFunction_Single<dType> {
-        dType operator()(dType x) override {
-            return x > 0 ? x : 0;
-        }
-    private:
-        template <typename dType2>
-        friend ActivationFunction_Factory<dType2>* getActivationFunction_Factory();
-        ReLU() = default;
-        ReLU(const ReLU&) = delete;
-        ReLU& operator=(const ReLU&) = delete;
-    };
-
+    using Tanh = BuiltinActivationFunction<ActivationType::TANH, dType>;
     template <typename dType = double>
-    struct Step final : public ActivationFunction_Single<dType> {
-        dType operator()(dType x) override {
-            return x > 0 ? 1 : 0;
-        }
-    private:
-        template <typename dType2>
-        friend ActivationFunction_Factory<dType2>* getActivationFunction_Factory();
-        Step() = default;
-        Step(const Step&) = delete;
-        Step& operator=(const Step&) = delete;
-    };
-
+    using ReLU = BuiltinActivationFunction<ActivationType::RELU, dType>;
     template <typename dType = double>
-    struct Identity final : public ActivationFunction_Single<dType> {
-        dType operator()(dType x) override {
-            return x;
-        }
-    private:
-        template <typename dType2>
-        friend ActivationFunction_Factory<dType2>* getActivationFunction_Factory();
-        Identity() = default;
-        Identity(const Identity&) = delete;
-        Identity& operator=(const Identity&) = delete;
-    };
+    using Step = BuiltinActivationFunction<ActivationType::STEP, dType>;
+    template <typename dType = double>
+    using Identity = BuiltinActivationFunction<ActivationType::IDENTITY, dType>;
 
     /**
      * @brief Factory class for all activation functions
      *
+     * Maps tags to activation function objects and hands out tags for user-defined activation functions.
+     * Lookups are lock-free, registrations are serialized.
+     *
      * @tparam dType data type of the input and output
      */
-
     template <typename dType = double>
     class ActivationFunction_Factory final {
     public:
-        Sigmoid<dType>* sigmoid = nullptr;
-        Tanh<dType>* tanh = nullptr;
-        ReLU<dType>* reLU = nullptr;
-        Step<dType>* step = nullptr;
-        Identity<dType>* identity = nullptr;
-        bool init = false;
-
-        ActivationFunction<dType>* getRandomActivationFunction_single() const {
-            return functions_single[uniformIntDistribution(0, static_cast<int>(functions_single.size() - 1))];
+        Sigmoid<dType>* const sigmoid = new Sigmoid<dType>();
+        Tanh<dType>* const tanh = new Tanh<dType>();
+        ReLU<dType>* const reLU = new ReLU<dType>();
+        Step<dType>* const step = new Step<dType>();
+        Identity<dType>* const identity = new Identity<dType>();
+
+        static constexpr std::size_t MAX_FUNCTIONS = 256;
+
+        /**
+         * @brief Register a user-defined activation function, nodes refer to it by the returned tag
+         *
+         * @param function activation function, owned by the factory
+         * @return ActivationType tag of the function
+         */
+        ActivationType registerActivationFunction(ActivationFunction_Single<dType>* function) {
+            if (function == nullptr) {
+                throw std::invalid_argument("ActivationFunction_Factory<dType>::registerActivationFunction - function is nullptr");
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            const std::size_t count = functionCount.load(std::memory_order_relaxed);
+            if (count == MAX_FUNCTIONS) {
+                delete function;
+                throw std::invalid_argument("ActivationFunction_Factory<dType>::registerActivationFunction - too many activation functions");
+            }
+            functions_single[count].store(function, std::memory_order_relaxed);
+            functionCount.store(count + 1, std::memory_order_release);
+            return static_cast<ActivationType>(count);
+        }
+
+        /**
+         * @brief Get the activation function object of a tag
+         *
+         * @param type tag of the function
+         * @return ActivationFunction_Single<dType>* function, nullptr if the tag is not registered
+         */
+        ActivationFunction_Single<dType>* getActivationFunction(ActivationType type) const {
+            const std::size_t index = static_cast<std::size_t>(type);
+            if (index >= functionCount.load(std::memory_order_acquire)) return nullptr;
+            return functions_single[index].load(std::memory_order_relaxed);
         }
 
-        ActivationFunction<dType>* getRandomActivationFunction_Multiple() const {
-            if (functions_multiple.size() == 0) return nullptr;
-            return functions_multiple[uniformIntDistribution(0, static_cast<int>(functions_multiple.size() - 1))];
+        /**
+         * @brief Get the number of registered activation functions, built-in ones included
+         *
+         * @return std::size_t number of functions
+         */
+        std::size_t getActivationFunctionCount() const {
+            return functionCount.load(std::memory_order_acquire);
         }
 
-        ActivationFunction<dType>* getRandomActivationFunction() const {
-            return functions[uniformIntDistribution(0, static_cast<int>(functions.size() - 1))];
+        /**
+         * @brief Get the tag of a random single input activation function, built-in or user-defined
+         *
+         * @return ActivationType tag of the function
+         */
+        ActivationType getRandomActivationType_single() const {
+            const int count = static_cast<int>(functionCount.load(std::memory_order_acquire));
+            return static_cast<ActivationType>(uniformIntDistribution(0, count - 1));
         }
 
         ~ActivationFunction_Factory() {
-            delete sigmoid;
-            delete tanh;
-            delete reLU;
-            delete step;
-            delete identity;
+            for (std::size_t i = 0; i < functionCount.load(std::memory_order_acquire); i++) {
+                delete functions_single[i].load(std::memory_order_relaxed);
+            }
         }
     private:
-        const std::vector<ActivationFunction_Single<dType>*> functions_single =
-        { sigmoid, tanh, reLU, step, identity };
-        const std::vector<ActivationFunction_Multiple<dType>*> functions_multiple =
-        {};
-        std::vector<ActivationFunction<dType>*> functions = {};
+        // functions by tag, built-in functions take the tags below USER_DEFINED
+        std::array<std::atomic<ActivationFunction_Single<dType>*>, MAX_FUNCTIONS> functions_single {};
+        std::atomic<std::size_t> functionCount { 0 };
+        // serializes registrations
+        std::mutex mutex;
         ActivationFunction_Factory() {
-            functions.insert(functions.end(), functions_single.begin(), functions_single.end());
-            functions.insert(functions.end(), functions_multiple.begin(), functions_multiple.end());
+            for (ActivationFunction_Single<dType>* function : std::vector<ActivationFunction_Single<dType>*>{ sigmoid, tanh, reLU, step, identity }) {
+                functions_single[functionCount.load(std::memory_order_relaxed)].store(function, std::memory_order_relaxed);
+                functionCount.fetch_add(1, std::memory_order_release);
+            }
         }
         template <typename dType2>
         friend ActivationFunction_Factory<dType2>* getActivationFunction_Factory();
@@ -168,15 +228,82 @@ namespace NEAT {
     template <typename dType = double>
     ActivationFunction_Factory<dType>* getActivationFunction_Factory() {
         static ActivationFunction_Factory<dType> factory;
-        if (factory.init) return &factory;
-        factory.sigmoid = new Sigmoid<dType>();
-        factory.tanh = new Tanh<dType>();
-        factory.reLU = new ReLU<dType>();
-        factory.step = new Step<dType>();
-        factory.identity = new Identity<dType>();
-        factory.init = true;
         return &factory;
     }
+
+    /**
+     * @brief Register a user-defined activation function
+     *
+     * @tparam dType data type of the input and output
+     * @param function activation function, owned by the factory
+     * @return ActivationType tag to give to nodes
+     */
+    template <typename dType = double>
+    ActivationType registerActivationFunction(ActivationFunction_Single<dType>* function) {
+        return getActivationFunction_Factory<dType>()->registerActivationFunction(function);
+    }
+
+    /**
+     * @brief Apply the activation function of a tag to a value
+     *
+     * Built-in activations are inlined, user-defined ones are a virtual call, unregistered tags pass the value through.
+     *
+     * @tparam dType data type of the input and output
+     * @param type tag of the function
+     * @param x input
+     * @return dType output
+     */
+    template <typename dType>
+    inline dType applyActivation(ActivationType type, dType x) {
+        switch (type) {
+        case ActivationType::SIGMOID: return ActivationKernel<ActivationType::SIGMOID, dType>::apply(x);
+        case ActivationType::TANH: return ActivationKernel<ActivationType::TANH, dType>::apply(x);
+        case ActivationType::RELU: return ActivationKernel<ActivationType::RELU, dType>::apply(x);
+        case ActivationType::STEP: return ActivationKernel<ActivationType::STEP, dType>::apply(x);
+        case ActivationType::IDENTITY: return x;
+        default: {
+            ActivationFunction_Single<dType>* function = getActivationFunction_Factory<dType>()->getActivationFunction(type);
+            return (function != nullptr) ? (*function)(x) : x;
+        }
+        }
+    }
+
+    /**
+     * @brief Apply a compile-time kernel to contiguous values in place
+     *
+     */
+    template <ActivationType type, typename dType>
+    inline void applyActivationKernel(dType* values, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            values[i] = ActivationKernel<type, dType>::apply(values[i]);
+        }
+    }
+
+    /**
+     * @brief Apply the activation function of a tag to contiguous values in place, dispatched once per call
+     *
+     * @tparam dType data type of the input and output
+     * @param type tag of the function
+     * @param values values to activate
+     * @param count number of values
+     */
+    template <typename dType>
+    inline void applyActivation(ActivationType type, dType* values, std::size_t count) {
+        switch (type) {
+        case ActivationType::SIGMOID: applyActivationKernel<ActivationType::SIGMOID>(values, count); return;
+        case ActivationType::TANH: applyActivationKernel<ActivationType::TANH>(values, count); return;
+        case ActivationType::RELU: applyActivationKernel<ActivationType::RELU>(values, count); return;
+        case ActivationType::STEP: applyActivationKernel<ActivationType::STEP>(values, count); return;
+        case ActivationType::IDENTITY: return;
+        default: {
+            ActivationFunction_Single<dType>* function = getActivationFunction_Factory<dType>()->getActivationFunction(type);
+            if (function == nullptr) return;
+            for (std::size_t i = 0; i < count; i++) {
+                values[i] = (*function)(values[i]);
+            }
+        }
+        }
+    }
 }
 
 
@@ -2,7 +2,9 @@
 #define __NEAT_EDGE_HPP__
 
 #include <vector>
+#include <cstdint>
 #include "./Node.hpp"
+#include "./GeneArena.hpp"
 #include "./Genome.hpp"
 
 namespace NEAT {
@@ -54,6 +56,17 @@ namespace NEAT {
          */
         Edge(T2 from_id, T2 to_id, dType weight, T2 innovationNumber, bool disabled = false);
         ~Edge();
+
+        /**
+         * @brief Allocate from the active GeneArena of the thread, or the heap
+         *
+         */
+        static void* operator new(std::size_t size) {
+            return GeneArena::allocate(size);
+        }
+        static void operator delete(void* pointer) noexcept {
+            GeneArena::deallocate(pointer);
+        }
         /**
          * @brief Disable the edge
          *
@@ -69,6 +82,13 @@ namespace NEAT {
          *
          */
         void toggle();
+        /**
+         * @brief Check if the edge is disabled
+         *
+         * @return true edge is disabled
+         * @return false edge is enabled
+         */
+        bool isDisabled() const;
 
         /**
          * @brief Get the Weight of the edge
@@ -112,7 +132,30 @@ namespace NEAT {
         const T2& getInnovationNumber() const;
 
         /**
-         * @brief Get the From Node
+         * @brief Attach the edge to the genome owning it, set by the genome when the edge is added
+         *
+         * @param owner genome owning the edge
+         * @param fromIndex genome-local index of the from node, NO_INDEX if not in the genome yet
+         * @param toIndex genome-local index of the to node, NO_INDEX if not in the genome yet
+         */
+        void bind(const Genome<dType, T2>* owner, std::uint32_t fromIndex, std::uint32_t toIndex);
+
+        /**
+         * @brief Get the genome-local index of the from node
+         *
+         * @return const std::uint32_t& index, NO_INDEX if unresolved
+         */
+        const std::uint32_t& getFromIndex() const;
+
+        /**
+         * @brief Get the genome-local index of the to node
+         *
+         * @return const std::uint32_t& index, NO_INDEX if unresolved
+         */
+        const std::uint32_t& getToIndex() const;
+
+        /**
+         * @brief Get the From Node, an array index if genome owns the edge, a lookup by id otherwise
          *
          * @param genome pointer to the genome
          * @return Node<dType, T2>* pointer to the from node
@@ -120,13 +163,27 @@ namespace NEAT {
         Node<dType, T2>* getFrom(const Genome<dType, T2>* genome) const;
 
         /**
-         * @brief Get the To Node
+         * @brief Get the To Node, an array index if genome owns the edge, a lookup by id otherwise
          *
          * @param genome pointer to the genome
          * @return Node<dType, T2>* pointer to the to node
          */
         Node<dType, T2>* getTo(const Genome<dType, T2>* genome) const;
 
+        /**
+         * @brief Get the id of the from node
+         *
+         * @return const T2& id of the from node
+         */
+        const T2& getFromId() const;
+
+        /**
+         * @brief Get the id of the to node
+         *
+         * @return const T2& id of the to node
+         */
+        const T2& getToId() const;
+
         /**
          * @brief clone the edge (deep copy)
          *
@@ -140,6 +197,8 @@ namespace NEAT {
          */
         void print(int tabSize = 0) const;
 
+        static constexpr std::uint32_t NO_INDEX = static_cast<std::uint32_t>(-1);
+
     private:
         /**
          * @brief innovation number of the edge
@@ -181,6 +240,13 @@ namespace NEAT {
          *
          */
         EdgeState state = EdgeState::DISABLED;
+        /**
+         * @brief genome owning the edge, the node indices are only valid in this genome
+         *
+         */
+        const Genome<dType, T2>* owner = nullptr;
+        std::uint32_t fromIndex = NO_INDEX;
+        std::uint32_t toIndex = NO_INDEX;
 
         // prevent copy and assignment
         Edge(const Edge<dType, T2>& edge) = delete;
@@ -0,0 +1,162 @@
+#ifndef __NEAT_EXECUTION_PLAN_HPP__
+#define __NEAT_EXECUTION_PLAN_HPP__
+
+#include <vector>
+#include <cstdint>
+
+#include "./Activation.hpp"
+
+namespace NEAT {
+
+    // forward declaration
+    template <typename dType, typename T2>
+    class Genome;
+    template <typename dType, typename T2>
+    class FlatGenome;
+
+    /**
+     * @brief Reusable buffers for evaluating execution plans
+     *
+     * Holds all mutable state of an evaluation, so one genome can be evaluated from several threads at once
+     * with one workspace per thread.
+     *
+     * @tparam dType type of data
+     */
+    template <typename dType = double>
+    struct ActivationWorkspace final {
+        /**
+         * @brief node values of the last evaluation, slot-major for batches
+         *
+         */
+        std::vector<dType> values;
+        /**
+         * @brief source values of the incoming edges of the slot being evaluated in a batch
+         *
+         */
+        std::vector<const dType*> sources;
+    };
+
+    /**
+     * @brief Compiled, flat form of a genome used for inference
+     *
+     * Every node of the genome is given a slot, slots are ordered topologically so that all sources of a node are
+     * evaluated before the node itself. The enabled incoming edges of each slot are stored in CSR form, edges of slot s
+     * are [edgeOffsets[s], edgeOffsets[s + 1]) in edgeSources and edgeWeights.
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    class ExecutionPlan final {
+    public:
+        /**
+         * @brief Compile a genome into an execution plan
+         *
+         * @param genome genome to compile, input and output nodes must exist
+         */
+        ExecutionPlan(const Genome<dType, T2>& genome);
+        /**
+         * @brief Compile the genes of a flat genome into an execution plan
+         *
+         * @param genome flat genome to compile, input and output nodes must exist
+         */
+        ExecutionPlan(const FlatGenome<dType, T2>& genome);
+
+        /**
+         * @brief Evaluate the plan for a single input vector
+         *
+         * @param inputs pointer to inputSize input values
+         * @param outputs pointer to outputSize values to write
+         * @param workspace buffers of the evaluation
+         */
+        void evaluate(const dType* inputs, dType* outputs, ActivationWorkspace<dType>& workspace) const;
+
+        /**
+         * @brief Evaluate the plan for a batch of input rows
+         *
+         * Node values are kept node-major, the value of every node is a contiguous vector over the batch,
+         * so the weighted sum and the activation of a node are vectorized over the batch by SimdKernels.
+         *
+         * @param inputs row-major input block of rows x inputSize values
+         * @param rows number of rows in the batch
+         * @param outputs row-major output block of rows x outputSize values to write
+         * @param workspace buffers of the evaluation
+         */
+        void evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace) const;
+
+        const T2& getInputSize() const;
+        const T2& getOutputSize() const;
+        std::uint32_t getNodeCount() const;
+        std::uint32_t getEdgeCount() const;
+
+        const std::vector<T2>& getNodeIds() const;
+        const std::vector<dType>& getBiases() const;
+        const std::vector<ActivationType>& getActivations() const;
+        const std::vector<std::uint32_t>& getEdgeOffsets() const;
+        const std::vector<std::uint32_t>& getEdgeSources() const;
+        const std::vector<dType>& getEdgeWeights() const;
+        const std::vector<std::uint32_t>& getInputSlots() const;
+        const std::vector<std::uint32_t>& getOutputSlots() const;
+
+        /**
+         * @brief Get the hash of the structure, plans of equal structure differ only in weights and biases
+         *
+         * @return std::size_t hash of the slots, their activation functions and their incoming edges
+         */
+        std::size_t getStructureHash() const;
+        /**
+         * @brief Check whether two plans have the same slots, activation functions and incoming edges
+         *
+         * @param other plan to compare with
+         * @return true if the plans only differ in weights and biases
+         */
+        bool hasSameStructure(const ExecutionPlan<dType, T2>& other) const;
+
+    private:
+        T2 inputSize;
+        T2 outputSize;
+        /**
+         * @brief node id of each slot
+         *
+         */
+        std::vector<T2> nodeIds;
+        /**
+         * @brief bias of each slot
+         *
+         */
+        std::vector<dType> biases;
+        /**
+         * @brief activation function tag of each slot
+         *
+         */
+        std::vector<ActivationType> activations;
+        /**
+         * @brief offset of the first incoming edge of each slot, size is number of slots + 1
+         *
+         */
+        std::vector<std::uint32_t> edgeOffsets;
+        /**
+         * @brief source slot of each incoming edge
+         *
+         */
+        std::vector<std::uint32_t> edgeSources;
+        /**
+         * @brief weight of each incoming edge
+         *
+         */
+        std::vector<dType> edgeWeights;
+        /**
+         * @brief slot of each input node, in input order
+         *
+         */
+        std::vector<std::uint32_t> inputSlots;
+        /**
+         * @brief slot of each output node, in output order
+         *
+         */
+        std::vector<std::uint32_t> outputSlots;
+        std::size_t structureHash = 0;
+    };
+}
+
+#endif // __NEAT_EXECUTION_PLAN_HPP__
@@ -0,0 +1,185 @@
+#ifndef __NEAT_FLAT_GENOME_HPP__
+#define __NEAT_FLAT_GENOME_HPP__
+
+#include <vector>
+#include <cstdint>
+
+#include "./Activation.hpp"
+
+namespace NEAT {
+
+    // forward declaration
+    template <typename dType, typename T2>
+    class Genome;
+    enum class NodeType;
+
+    /**
+     * @brief Struct-of-arrays form of the genes of a genome
+     *
+     * Nodes are stored as parallel arrays sorted by id, edges as parallel arrays sorted by innovation number.
+     * Edge endpoints are indices into the node arrays, enabled flags are packed into 64 bit words.
+     * It is the primary storage of a genome until its nodes and edges are accessed, the mutations edit it in place,
+     * distance computation and crossover merge over these arrays instead of chasing node and edge pointers.
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    class FlatGenome final {
+    public:
+        /**
+         * @brief Construct an empty FlatGenome object
+         *
+         * @param inputSize input size of genome
+         * @param outputSize output size of genome
+         */
+        FlatGenome(T2 inputSize, T2 outputSize);
+        /**
+         * @brief Flatten the genes of a genome
+         *
+         * @param genome genome to flatten
+         */
+        FlatGenome(const Genome<dType, T2>& genome);
+
+        /**
+         * @brief Append a node, ids have to be appended in increasing order
+         *
+         * @return std::uint32_t index of the node
+         */
+        std::uint32_t addNode(T2 id, NodeType type, int layer, dType bias, ActivationType activation);
+        /**
+         * @brief Append an edge, innovation numbers have to be appended in increasing order
+         *
+         * @param from index of the from node
+         * @param to index of the to node
+         */
+        void addEdge(T2 innovation, std::uint32_t from, std::uint32_t to, dType weight, bool enabled);
+        /**
+         * @brief Insert a node at its place by id, the node is placed right before another node in the topological order
+         *
+         * @param before index of the node that follows the new node in the topological order, before the insertion
+         * @return std::uint32_t index of the new node, NOT_FOUND if the id exists, indices from it on are shifted by one
+         */
+        std::uint32_t insertNode(T2 id, NodeType type, int layer, dType bias, ActivationType activation, std::uint32_t before);
+        /**
+         * @brief Insert an edge at its place by innovation number, the topological order has to hold for it, see orderEdge
+         *
+         * @param from index of the from node
+         * @param to index of the to node
+         * @return true if the edge is inserted, false if the innovation number exists
+         */
+        bool insertEdge(T2 innovation, std::uint32_t from, std::uint32_t to, dType weight, bool enabled);
+        /**
+         * @brief Check if there is a path between two nodes over all edges, enabled or not
+         *
+         * @param from index of the first node
+         * @param to index of the last node
+         */
+        bool hasPath(std::uint32_t from, std::uint32_t to) const;
+        /**
+         * @brief Repair the topological order for a new edge before it is inserted, Pearce-Kelly dynamic topological sort
+         *
+         * @param from index of the from node
+         * @param to index of the to node
+         * @return true the order is valid with the edge
+         * @return false the edge would close a cycle, the order is unchanged
+         */
+        bool orderEdge(std::uint32_t from, std::uint32_t to);
+
+        void setEnabled(std::uint32_t edge, bool enabled);
+        void setEdgeWeight(std::uint32_t edge, dType weight);
+        void setNodeBias(std::uint32_t node, dType bias);
+        void setNodeActivation(std::uint32_t node, ActivationType activation);
+
+        /**
+         * @brief Build a genome with a copy of the genes
+         *
+         * @return Genome<dType, T2>* new genome, owned by the caller
+         */
+        Genome<dType, T2>* toGenome() const;
+        /**
+         * @brief Build the nodes and edges of a genome without nodes and edges
+         *
+         * @param genome genome without nodes and edges
+         */
+        void fillGenome(Genome<dType, T2>& genome) const;
+
+        /**
+         * @brief Find the index of a node by id with a binary search
+         *
+         * @param id node id
+         * @return std::uint32_t index of the node, NOT_FOUND if missing
+         */
+        std::uint32_t findNode(T2 id) const;
+
+        const T2& getInputSize() const;
+        const T2& getOutputSize() const;
+        std::uint32_t getNodeCount() const;
+        std::uint32_t getEdgeCount() const;
+        bool isEnabled(std::uint32_t edge) const;
+        /**
+         * @brief Get the sum of all edge weights
+         *
+         * @return dType sum of weights
+         */
+        dType getWeightSum() const;
+
+        const std::vector<T2>& getNodeIds() const;
+        const std::vector<NodeType>& getNodeTypes() const;
+        const std::vector<int>& getNodeLayers() const;
+        const std::vector<dType>& getNodeBiases() const;
+        const std::vector<ActivationType>& getNodeActivations() const;
+        const std::vector<T2>& getInnovations() const;
+        const std::vector<std::uint32_t>& getEdgeFrom() const;
+        const std::vector<std::uint32_t>& getEdgeTo() const;
+        const std::vector<dType>& getEdgeWeights() const;
+        /**
+         * @brief Get the position of every node in a topological order of the genome
+         *
+         * @return const std::vector<std::uint32_t>& positions by node index, empty if unknown
+         */
+        const std::vector<std::uint32_t>& getNodeOrder() const;
+        /**
+         * @brief Set the position of every node in a topological order, has to hold for every edge
+         *
+         * @param nodeOrder positions by node index, empty if unknown
+         */
+        void setNodeOrder(std::vector<std::uint32_t> nodeOrder);
+
+        static constexpr std::uint32_t NOT_FOUND = static_cast<std::uint32_t>(-1);
+
+    private:
+        /**
+         * @brief Build the topological order over all edges with Kahn's algorithm
+         *
+         */
+        void buildNodeOrder();
+        /**
+         * @brief Build the outgoing or incoming adjacency of every node over all edges
+         *
+         * @param outgoing outgoing edges if true, incoming otherwise
+         * @param offsets neighbours of node i are [offsets[i], offsets[i + 1])
+         * @param neighbours node indices
+         */
+        void buildAdjacency(bool outgoing, std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& neighbours) const;
+        T2 inputSize;
+        T2 outputSize;
+        // nodes, sorted by id
+        std::vector<T2> nodeIds;
+        std::vector<NodeType> nodeTypes;
+        std::vector<int> nodeLayers;
+        std::vector<dType> nodeBiases;
+        std::vector<ActivationType> nodeActivations;
+        // edges, sorted by innovation number
+        std::vector<T2> innovations;
+        std::vector<std::uint32_t> edgeFrom;
+        std::vector<std::uint32_t> edgeTo;
+        std::vector<dType> edgeWeights;
+        // enabled flag of edge i is bit i % 64 of word i / 64
+        std::vector<std::uint64_t> enabledBits;
+        // position of each node in a topological order, empty if unknown
+        std::vector<std::uint32_t> nodeOrder;
+    };
+}
+
+#endif // __NEAT_FLAT_GENOME_HPP__
@@ -0,0 +1,113 @@
+#ifndef __NEAT_GENE_ARENA_HPP__
+#define __NEAT_GENE_ARENA_HPP__
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace NEAT {
+
+    /**
+     * @brief Bump allocator owning the genomes, nodes and edges of a generation
+     *
+     * Genome, Node and Edge allocate from the arena made active on the calling thread by a GeneArenaScope,
+     * or from the heap when no arena is active. Deleting an object allocated from an arena runs its destructor
+     * but keeps the memory, the chunks of the arena are freed in one step once the owner has called release
+     * and every object allocated from the arena has been deleted. Objects can therefore outlive the generation
+     * they were allocated in. Every thread bumps through a chunk of its own, the arena is only locked to hand out
+     * a new chunk.
+     */
+    class GeneArena final {
+    public:
+        /**
+         * @brief Construct a new Gene Arena object, the caller owns a reference to the arena
+         *
+         * @param chunkSize size of the memory chunks in bytes, every allocating thread holds one partly used chunk
+         */
+        GeneArena(std::size_t chunkSize = 1 << 16);
+
+        /**
+         * @brief Drop the reference of the owner, the arena is freed once no object allocated from it is alive
+         *
+         */
+        void release();
+
+        /**
+         * @brief Allocate memory from the active arena of this thread, or from the heap if there is none
+         *
+         * @param size size in bytes
+         * @return void* memory aligned to alignof(std::max_align_t)
+         */
+        static void* allocate(std::size_t size);
+
+        /**
+         * @brief Return memory obtained from allocate
+         *
+         * @param pointer pointer returned by allocate, may be nullptr
+         */
+        static void deallocate(void* pointer) noexcept;
+
+        /**
+         * @brief Get the arena used by allocate on this thread
+         *
+         * @return GeneArena* active arena, nullptr if the heap is used
+         */
+        static GeneArena* getActive();
+
+        /**
+         * @brief Get the number of bytes reserved in chunks
+         *
+         * @return std::size_t reserved bytes
+         */
+        std::size_t getReservedBytes() const;
+
+        /**
+         * @brief Get the number of live objects allocated from the arena
+         *
+         * @return std::size_t live objects
+         */
+        std::size_t getLiveCount() const;
+
+    private:
+        ~GeneArena();
+        void* allocateBlock(std::size_t size);
+        void dropReference() noexcept;
+
+        const std::size_t chunkSize;
+        // identifies the arena in the chunk cursors of the threads, unlike its address it is never reused
+        const std::uint64_t id;
+        // guards chunks and reservedBytes
+        mutable std::mutex mutex;
+        std::vector<char*> chunks;
+        std::size_t reservedBytes = 0;
+        // the reference of the owner and one per live object
+        std::atomic<std::size_t> references { 1 };
+        static thread_local GeneArena* active;
+        friend class GeneArenaScope;
+        GeneArena(const GeneArena&) = delete;
+        GeneArena& operator=(const GeneArena&) = delete;
+    };
+
+    /**
+     * @brief Make an arena the source of Genome, Node and Edge allocations on this thread until the scope ends
+     *
+     */
+    class GeneArenaScope final {
+    public:
+        /**
+         * @brief Construct a new Gene Arena Scope object
+         *
+         * @param arena arena to allocate from, nullptr allocates from the heap
+         */
+        GeneArenaScope(GeneArena* arena);
+        ~GeneArenaScope();
+    private:
+        GeneArena* previous;
+        GeneArenaScope(const GeneArenaScope&) = delete;
+        GeneArenaScope& operator=(const GeneArenaScope&) = delete;
+    };
+}
+
+#endif // __NEAT_GENE_ARENA_HPP__
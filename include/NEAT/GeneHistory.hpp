@@ -1,7 +1,11 @@
 #ifndef __NEAT_GENE_HISTORY_HPP__
 #define __NEAT_GENE_HISTORY_HPP__
 
-#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <utility>
 
 #include "./Node.hpp"
 #include "./Edge.hpp"
@@ -16,7 +20,11 @@ namespace NEAT {
     class Edge;
 
     /**
-     * @brief Class for mutation history, innovation number of the current generation
+     * @brief Registry of innovation numbers, owned by a population
+     *
+     * Structural mutations that happen again get the innovation number of their first occurrence. Lookups and inserts
+     * can be made from several threads at once, entries are split over shards with a lock each. Entries remember the
+     * generation they were last used in, so old entries can be removed with expire.
      *
      * @tparam dType
      * @tparam T2
@@ -24,80 +32,102 @@ namespace NEAT {
     template <typename dType, typename T2>
     class GeneHistory final {
     public:
-        GeneHistory() { };
-        void init(T2 inputSize, T2 outputSize) {
-            // add input nodes
-            for (T2 i = 0; i < inputSize; i++) {
-                nodes[i] = { i };
-            }
-            // add output nodes
-            for (T2 i = 0; i < outputSize; i++) {
-                nodes[i + inputSize] = { i + inputSize };
-            }
-            // add edges
-            for (T2 i = 0; i < inputSize; i++) {
-                for (T2 j = 0; j < outputSize; j++) {
-                    edges[{ i, j + inputSize }] = { i * outputSize + j };
-                }
-            }
-            // set innovation number
-            edgeInnovationNumber = inputSize * outputSize;
-            nodeInnovationNumber = inputSize + outputSize;
-        }
-        T2 addNode(const T2 fromId, const T2 toId, const T2 edgeInnovationNumber) {
-            // find if the node already exists
-            typename std::map<T2, NodeHistory>::iterator it = nodes.find(edgeInnovationNumber);
-            if (it != nodes.end()) {
-                // if the node already exists, return the node id
-                return it->second.nodeId;
-            }
-            // if the node does not exist, create a new node
-            T2 nodeId = getNextNodeInnovationNumber();
-            nodes[edgeInnovationNumber] = { nodeId };
-            return nodeId;
-        }
-        T2 addEdge(const T2 fromId, const T2 toId) {
-            // find if the edge already exists
-            typename std::map<std::pair<T2, T2>, EdgeHistory>::iterator it = edges.find({ fromId, toId });
-            if (it != edges.end()) {
-                // if the edge already exists, return the edge id
-                return it->second.edgeInnovationNumber;
-            }
-            // if the edge does not exist, create a new edge
-            T2 edgeId = getNextEdgeInnovationNumber();
-            edges[{ fromId, toId }] = { edgeId };
-            return edgeId;
-        }
+        GeneHistory();
+
+        /**
+         * @brief Register the nodes and edges of fully connected genomes, these entries never expire
+         *
+         * @param inputSize number of input nodes
+         * @param outputSize number of output nodes
+         */
+        void init(T2 inputSize, T2 outputSize);
+
+        /**
+         * @brief Get the id of the node splitting an edge, a new id if the edge has not been split before
+         *
+         * @param fromId from node id of the split edge
+         * @param toId to node id of the split edge
+         * @param edgeInnovationNumber innovation number of the split edge
+         * @return T2 node id
+         */
+        T2 addNode(const T2 fromId, const T2 toId, const T2 edgeInnovationNumber);
+
+        /**
+         * @brief Get the innovation number of an edge, a new innovation number if the edge has not been added before
+         *
+         * @param fromId from node id
+         * @param toId to node id
+         * @return T2 innovation number
+         */
+        T2 addEdge(const T2 fromId, const T2 toId);
+
+        /**
+         * @brief Set the current generation, entries used from now on are marked with it
+         *
+         * @param generation current generation
+         */
+        void setGeneration(T2 generation);
+        const T2& getGeneration() const;
+
+        /**
+         * @brief Remove entries not used in the last maxAge generations before the current one
+         *
+         * Removed structures get a new innovation number if they appear again. Entries from init are kept.
+         *
+         * @param maxAge number of generations an unused entry is kept
+         * @return std::size_t number of entries removed
+         */
+        std::size_t expire(T2 maxAge);
+
+        /**
+         * @brief Get the number of node and edge entries
+         *
+         * @return std::size_t number of entries
+         */
+        std::size_t size() const;
 
     private:
+        struct EdgeKeyHash {
+            std::size_t operator()(const std::pair<T2, T2>& key) const {
+                const std::size_t h1 = std::hash<T2>()(key.first);
+                const std::size_t h2 = std::hash<T2>()(key.second);
+                return h1 ^ (h2 + 0x9E3779B97F4A7C15ULL + (h1 << 6) + (h1 >> 2));
+            }
+        };
 
-        struct EdgeHistory {
-            T2 edgeInnovationNumber;
+        struct Entry {
+            T2 id;
+            // generation of the last use
+            T2 generation;
+            // entries from init are never removed
+            bool permanent;
         };
 
-        struct NodeHistory {
-            T2 nodeId;
+        static const std::size_t SHARD_COUNT = 16;
+
+        template <typename Key, typename Hash>
+        struct Shard {
+            mutable std::mutex mutex;
+            std::unordered_map<Key, Entry, Hash> entries;
         };
 
-        T2 getNextEdgeInnovationNumber() const {
-            return edgeInnovationNumber++;
-        }
-        T2 getNextNodeInnovationNumber() const {
-            return nodeInnovationNumber++;
-        }
-        static T2 edgeInnovationNumber;
-        static T2 nodeInnovationNumber;
-        // edgeInnovationNumber, NodeHistory
-        std::map< T2, NodeHistory > nodes;
-        // fromId, toId, EdgeHistory
-        std::map< std::pair<T2, T2>, EdgeHistory > edges;
-    };
+        typedef Shard<T2, std::hash<T2>> NodeShard;
+        typedef Shard<std::pair<T2, T2>, EdgeKeyHash> EdgeShard;
 
-    // Explicit instantiation
-    template <typename dType, typename T2>
-    T2 GeneHistory<dType, T2>::edgeInnovationNumber = 0;
-    template <typename dType, typename T2>
-    T2 GeneHistory<dType, T2>::nodeInnovationNumber = 0;
+        T2 getNextEdgeInnovationNumber();
+        T2 getNextNodeInnovationNumber();
+
+        std::atomic<T2> edgeInnovationNumber { 0 };
+        std::atomic<T2> nodeInnovationNumber { 0 };
+        T2 generation = 0;
+        // edgeInnovationNumber of the split edge, node id
+        NodeShard nodes[SHARD_COUNT];
+        // fromId, toId, edgeInnovationNumber
+        EdgeShard edges[SHARD_COUNT];
+        // prevent copying
+        GeneHistory(const GeneHistory<dType, T2>&) = delete;
+        GeneHistory<dType, T2>& operator=(const GeneHistory<dType, T2>&) = delete;
+    };
 
 }
 
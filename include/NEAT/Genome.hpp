@@ -4,9 +4,16 @@
 // Inherit this class to create player
 
 #include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include "./Node.hpp"
 #include "./Edge.hpp"
 #include "./GeneHistory.hpp"
+#include "./ExecutionPlan.hpp"
+#include "./FlatGenome.hpp"
+#include "./GeneArena.hpp"
 #include "./config.hpp"
 
 namespace NEAT {
@@ -43,8 +50,25 @@ namespace NEAT {
          * @param init initialise genome with edges and nodes
          */
         Genome(T2 inputSize, T2 outputSize, bool init = true);
+        /**
+         * @brief Construct a new Genome object stored as flat genes, its nodes and edges are built when first accessed
+         *
+         * @param genes genes of the genome, not changed by the genome while shared with other genomes
+         */
+        Genome(std::shared_ptr<FlatGenome<dType, T2>> genes);
         virtual ~Genome();
 
+        /**
+         * @brief Allocate from the active GeneArena of the thread, or the heap
+         *
+         */
+        static void* operator new(std::size_t size) {
+            return GeneArena::allocate(size);
+        }
+        static void operator delete(void* pointer) noexcept {
+            GeneArena::deallocate(pointer);
+        }
+
         /**
          * @brief Get the Input Size object
          *
@@ -85,6 +109,15 @@ namespace NEAT {
          * @return Node<dType, T2>* Node pointer if found, nullptr otherwise
          */
         Node<dType, T2>* getNode(T2 id) const;
+        /**
+         * @brief Get pointer to node by genome-local index, see Node::getIndex
+         *
+         * @param index node index, has to be less than the number of nodes
+         * @return Node<dType, T2>* Node pointer
+         */
+        Node<dType, T2>* getNodeByIndex(std::uint32_t index) const {
+            return nodeList[index];
+        }
 
         /**
          * @brief Add a edge to the genome by cloning
@@ -110,6 +143,13 @@ namespace NEAT {
          * @return true add success
          */
         bool addNode_noClone(Node<dType, T2>* node);
+        /**
+         * @brief add an edge to the genome without cloning
+         *
+         * @param edge edge to add
+         * @return true add success
+         */
+        bool addEdge_noClone(Edge<dType, T2>* edge);
 
         // 
         /**
@@ -159,11 +199,36 @@ namespace NEAT {
         const dType& getFitness() const;
 
         /**
-         * @brief Mutate the genome
+         * @brief set the Species Id of genome, used as a hint for speciation of the genome and its offspring
+         *
+         */
+        void setSpeciesId(T2 speciesId);
+
+        /**
+         * @brief Get the Species Id of genome
+         *
+         * @return T2 species id, -1 if the genome has not been assigned a species
+         */
+        const T2& getSpeciesId() const;
+
+        /**
+         * @brief Mutate the genome, mutateStructure followed by mutateParameters
          *
          */
         void mutate(GeneHistory<dType, T2>& geneHistory, const MutationConfig<dType>& mutationConfig = MutationConfig<dType>());
 
+        /**
+         * @brief Add node and add edge mutations, these register new genes in the gene history
+         *
+         */
+        void mutateStructure(GeneHistory<dType, T2>& geneHistory, const MutationConfig<dType>& mutationConfig = MutationConfig<dType>());
+
+        /**
+         * @brief Toggle edge, weight, activation function and bias mutations, these only touch this genome
+         *
+         */
+        void mutateParameters(const MutationConfig<dType>& mutationConfig = MutationConfig<dType>());
+
         /**
          * @brief get the prediction from the genome
          *
@@ -172,6 +237,43 @@ namespace NEAT {
          */
         void feedForward(const std::vector<dType>& inputs, std::vector<dType>& outputs);
         std::vector<dType> feedForward(const std::vector<dType>& inputs);
+        /**
+         * @brief get the prediction from the genome without touching any state of the genome
+         *
+         * Safe to call from several threads at once on the same genome, as long as each thread uses its own workspace
+         * and the genome is not modified meanwhile.
+         *
+         * @param inputs input vector
+         * @param outputs output vector, outputs are appended
+         * @param workspace buffers of the evaluation
+         */
+        void feedForward(const std::vector<dType>& inputs, std::vector<dType>& outputs, ActivationWorkspace<dType>& workspace) const;
+
+        /**
+         * @brief get the predictions of the genome for a batch of inputs
+         *
+         * @param inputs row-major input block of rows x inputSize values
+         * @param rows number of rows
+         * @param outputs row-major output block, resized to rows x outputSize
+         */
+        void feedForwardBatch(const std::vector<dType>& inputs, std::size_t rows, std::vector<dType>& outputs);
+        /**
+         * @brief get the predictions of the genome for a batch of inputs
+         *
+         * @param inputs pointer to a row-major input block of rows x inputSize values
+         * @param rows number of rows
+         * @param outputs pointer to a row-major output block of rows x outputSize values
+         */
+        void feedForwardBatch(const dType* inputs, std::size_t rows, dType* outputs);
+        /**
+         * @brief get the predictions of the genome for a batch of inputs without touching any state of the genome
+         *
+         * @param inputs pointer to a row-major input block of rows x inputSize values
+         * @param rows number of rows
+         * @param outputs pointer to a row-major output block of rows x outputSize values
+         * @param workspace buffers of the evaluation
+         */
+        void feedForwardBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace) const;
 
         /**
          * @brief get the prediction from the genome
@@ -180,10 +282,64 @@ namespace NEAT {
          * @return T2 prediction class
          */
         T2 predict(const std::vector<dType>& inputs);
+        /**
+         * @brief get the prediction from the genome without touching any state of the genome
+         *
+         * @param inputs input vector
+         * @param workspace buffers of the evaluation
+         * @return T2 prediction class
+         */
+        T2 predict(const std::vector<dType>& inputs, ActivationWorkspace<dType>& workspace) const;
+
+        /**
+         * @brief Get the compiled execution plan of the genome, the plan is compiled on first use and cached until the genome changes
+         *
+         * Compilation is guarded, concurrent callers get the same plan.
+         *
+         * @return const ExecutionPlan<dType, T2>& execution plan
+         */
+        const ExecutionPlan<dType, T2>& getExecutionPlan() const;
+        /**
+         * @brief Get the compiled execution plan with shared ownership, the plan stays valid after the genome changes
+         *
+         * @return std::shared_ptr<const ExecutionPlan<dType, T2>> execution plan
+         */
+        std::shared_ptr<const ExecutionPlan<dType, T2>> getSharedExecutionPlan() const;
+
+        /**
+         * @brief Get a topological order of the nodes over all edges, enabled or not
+         *
+         * The order is kept up to date by the structural mutations and rebuilt only after other changes.
+         *
+         * @return const std::vector<std::uint32_t>& node indices in topological order, see getNodeByIndex
+         */
+        const std::vector<std::uint32_t>& getTopologicalOrder();
+
+        /**
+         * @brief Get the struct-of-arrays form of the genes
+         *
+         * It is the storage of a genome whose nodes and edges have not been accessed. Otherwise it is built from the
+         * nodes and edges on first use and cached until the genome changes, building is guarded, concurrent callers
+         * get the same flat genome.
+         *
+         * @return const FlatGenome<dType, T2>& flat genome
+         */
+        const FlatGenome<dType, T2>& getFlatGenome() const;
+
+        /**
+         * @brief Drop the cached execution plan and flat genome, required after editing nodes or edges obtained from getNode or getEdge
+         *
+         * Accessing the nodes and edges makes them the storage of the genome, the flat genome is then a cache.
+         *
+         */
+        void invalidateCache();
 
         /**
          * @brief clone a genome with the same nodes, edges, and fitness
          *
+         * The clone is copy-on-write, it shares the flat genome and execution plan of this genome, a mutation of
+         * the clone copies the flat genome, its nodes and edges are only built when first accessed.
+         *
          * @return Genome<dType, T2>* cloned genome
          */
         Genome<dType, T2>* clone() const;
@@ -195,6 +351,22 @@ namespace NEAT {
         void print(int tabSize = 0) const;
         // 
     private:
+        friend class FlatGenome<dType, T2>;
+
+        /**
+         * @brief Build the nodes and edges of a genome stored as flat genes, no-op if already built
+         *
+         * Guarded, concurrent callers build the nodes and edges once.
+         */
+        void materialize() const;
+        /**
+         * @brief Get the flat genes of a genome stored as flat genes for editing, copied first if shared with other genomes
+         *
+         * Drops the cached execution plan.
+         *
+         * @return FlatGenome<dType, T2>& flat genome owned by this genome
+         */
+        FlatGenome<dType, T2>& editFlatGenome();
 
         /**
          * @brief Mutate the genome by adding a node
@@ -235,17 +407,30 @@ namespace NEAT {
         void mutateBias();
 
         /**
-         * @brief Mutate the genome by changing the bias of a node
+         * @brief Get a random edge from the genome in O(1) through edgeList
          *
+         * @return Edge<dType, T2>* random edge pointer, nullptr if the genome has no edge
          */
         Edge<dType, T2>* getRandomEdge();
 
         /**
-         * @brief Get a random node from the genome
+         * @brief Get a random node from the genome in O(1), hidden nodes are always allowed
+         *
+         * A single index is drawn over the allowed node lists, there is no retry loop.
          *
+         * @param allowInput allow input nodes
+         * @param allowOutput allow output nodes
          * @return Node<dType, T2>* random node pointer, nullptr unable to satisfy condition
          */
         Node<dType, T2>* getRandomNode(bool allowInput = false, bool allowOutput = false);
+        /**
+         * @brief Get a random node of the flat genes, same index space as getRandomNode with nodes in id order
+         *
+         * @param allowInput allow input nodes
+         * @param allowOutput allow output nodes
+         * @return std::uint32_t index of the node in the flat genome, FlatGenome::NOT_FOUND unable to satisfy condition
+         */
+        std::uint32_t getRandomFlatNode(bool allowInput = false, bool allowOutput = false) const;
 
         /**
          * @brief Add a node to the genome
@@ -268,6 +453,31 @@ namespace NEAT {
          * @return std::vector<bool> vector of bools indicating if the node is added
          */
         std::vector<bool> addEdge(std::vector<Edge<dType, T2>* > edges);
+        /**
+         * @brief Get the index of an edge endpoint, from the node pointer if it belongs to this genome, by id otherwise
+         *
+         * @param node node pointer held by the edge, may be nullptr
+         * @param id node id held by the edge
+         * @return std::uint32_t node index, Edge::NO_INDEX if the node is not in the genome
+         */
+        std::uint32_t resolveNodeIndex(const Node<dType, T2>* node, T2 id) const;
+        /**
+         * @brief Rebuild the topological order from all edges with Kahn's algorithm
+         *
+         */
+        void buildTopologicalOrder();
+        /**
+         * @brief Repair the topological order for a new edge before it is added, Pearce-Kelly dynamic topological sort
+         *
+         * Only the nodes between the two endpoints in the current order that are reachable from the target
+         * or reach the source are visited and reordered.
+         *
+         * @param from index of the from node
+         * @param to index of the to node
+         * @return true the order is valid with the edge
+         * @return false the edge would close a cycle, the order is unchanged
+         */
+        bool insertTopologicalEdge(std::uint32_t from, std::uint32_t to);
         // input size
         T2 inputSize;
         // output size
@@ -276,8 +486,40 @@ namespace NEAT {
         std::map<T2, Node<dType, T2>*> nodes;
         // Map of edges, key is innovation number
         std::map<T2, Edge<dType, T2>*> edges;
+        // Indexable views of edges and nodes for O(1) random selection, kept in sync by addNode and addEdge
+        std::vector<Edge<dType, T2>*> edgeList;
+        // Nodes by genome-local index, edges resolve their endpoints through it
+        std::vector<Node<dType, T2>*> nodeList;
+        // Node indices in topological order, and the position of every node index in it
+        std::vector<std::uint32_t> topologicalOrder;
+        std::vector<std::uint32_t> topologicalPosition;
+        // Visit marks of insertTopologicalEdge, all zero between calls
+        std::vector<std::uint8_t> topologicalMark;
+        // False until the order is built, and after an edge is added against the order outside the structural mutations
+        bool topologicalOrderValid = false;
+        std::vector<Node<dType, T2>*> inputNodes;
+        std::vector<Node<dType, T2>*> outputNodes;
+        std::vector<Node<dType, T2>*> hiddenNodes;
         // Fitness of genome
         dType fitness = 0;
+        // Id of the species of the genome or its parent, -1 if none
+        T2 speciesId = -1;
+        // False while the flat genome is the storage of the genome and its nodes and edges have not been built
+        mutable std::atomic<bool> materialized { true };
+        // Guards materialize
+        mutable std::mutex structureMutex;
+        // Cached execution plan, shared with clones, nullptr if not compiled
+        mutable std::shared_ptr<const ExecutionPlan<dType, T2>> sharedExecutionPlan;
+        mutable std::atomic<const ExecutionPlan<dType, T2>*> executionPlan { nullptr };
+        // Guards compilation of the execution plan
+        mutable std::mutex executionPlanMutex;
+        // Flat genome, the storage of the genome if not materialized and a cache otherwise, shared with clones, nullptr if not built
+        mutable std::shared_ptr<FlatGenome<dType, T2>> sharedFlatGenome;
+        mutable std::atomic<const FlatGenome<dType, T2>*> flatGenome { nullptr };
+        // Guards building of the flat genome
+        mutable std::mutex flatGenomeMutex;
+        // Workspace of the non-const feedForward and feedForwardBatch
+        ActivationWorkspace<dType> workspace;
     };
 }
 
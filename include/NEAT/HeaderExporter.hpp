@@ -0,0 +1,50 @@
+#ifndef __NEAT_HEADER_EXPORTER_HPP__
+#define __NEAT_HEADER_EXPORTER_HPP__
+
+#include <string>
+
+#include "./ExecutionPlan.hpp"
+
+namespace NEAT {
+
+    // forward declaration
+    template <typename dType, typename T2>
+    class Genome;
+
+    /**
+     * @brief Export of a genome as a self-contained C++ header for deployment without neatcpy
+     *
+     * The header defines a namespace with the input and output size as compile-time constants, the execution plan
+     * of the genome as constexpr float arrays and an inline evaluate(const float* inputs, float* outputs) that keeps
+     * its node values on the stack. It only includes <cmath> and <cstddef> and compiles as C++11. The evaluation
+     * follows ExecutionPlan::evaluate, so a genome of type float gives the same outputs as Genome::feedForward,
+     * weights and biases of other types are rounded to float.
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    class HeaderExporter final {
+    public:
+        HeaderExporter() = delete;
+
+        /**
+         * @brief Generate the header of a plan
+         *
+         * @param plan plan to export, without user-defined activation functions
+         * @param name name of the namespace of the header, a C++ identifier
+         * @return std::string content of the header
+         */
+        static std::string generate(const ExecutionPlan<dType, T2>& plan, const std::string& name);
+        /**
+         * @brief Write the header of a genome to a file
+         *
+         * @param genome genome to export, without user-defined activation functions
+         * @param path path of the header to write
+         * @param name name of the namespace of the header, a C++ identifier
+         */
+        static void write(const Genome<dType, T2>& genome, const std::string& path, const std::string& name);
+    };
+}
+
+#endif // __NEAT_HEADER_EXPORTER_HPP__
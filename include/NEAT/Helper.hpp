@@ -6,6 +6,7 @@
 #include <random>
 #include <math.h>
 #include <iostream>
+#include <cstdint>
 
 namespace NEAT {
 
@@ -28,6 +29,73 @@ namespace NEAT {
 
     unsigned int getSeed();
 
+    /**
+     * @brief Counter-based random number generator, the n-th number only depends on the key and n
+     *
+     * Streams keyed by (seed, generation, index, phase) give every offspring its own sequence,
+     * independent of the thread and the order it is produced in.
+     */
+    class RandomStream final {
+    public:
+        typedef std::uint64_t result_type;
+
+        RandomStream(std::uint64_t seed, std::uint64_t generation, std::uint64_t index, std::uint64_t phase = 0);
+
+        static constexpr result_type min() {
+            return 0;
+        }
+        static constexpr result_type max() {
+            return UINT64_MAX;
+        }
+        result_type operator()() {
+            return mix(key + (++counter) * 0x9E3779B97F4A7C15ULL);
+        }
+
+        /**
+         * @brief Get the stream used by the random distributions on this thread
+         *
+         * @return RandomStream* active stream, nullptr if the global generator is used
+         */
+        static RandomStream* getActive();
+
+    private:
+        // splitmix64 finalizer
+        static std::uint64_t mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+        std::uint64_t key;
+        std::uint64_t counter = 0;
+        static thread_local RandomStream* active;
+        friend class RandomStreamScope;
+    };
+
+    /**
+     * @brief Make a stream the source of the random distributions on this thread until the scope ends
+     *
+     */
+    class RandomStreamScope final {
+    public:
+        RandomStreamScope(RandomStream& stream);
+        ~RandomStreamScope();
+    private:
+        RandomStream* previous;
+        RandomStreamScope(const RandomStreamScope&) = delete;
+        RandomStreamScope& operator=(const RandomStreamScope&) = delete;
+    };
+
+    /**
+     * @brief Draw from a distribution with the active stream of this thread, or the global generator
+     *
+     */
+    template <typename Distribution>
+    typename Distribution::result_type sampleDistribution(Distribution& distribution) {
+        RandomStream* stream = RandomStream::getActive();
+        if (stream != nullptr) return distribution(*stream);
+        return distribution(Seed::getGenerator());
+    }
+
 
 
     /**
@@ -40,9 +108,8 @@ namespace NEAT {
      */
     template<typename dType = double>
     dType gaussianDistribution(dType mean, dType stdDeviation) {
-        std::mt19937& gen = Seed::getGenerator();
         std::normal_distribution<dType> d(mean, stdDeviation);
-        return d(gen);
+        return sampleDistribution(d);
     }
 
     /**
@@ -55,9 +122,8 @@ namespace NEAT {
      */
     template <typename dType = double>
     dType uniformDistribution(dType min, dType max) {
-        std::mt19937& gen = Seed::getGenerator();
         std::uniform_real_distribution<dType> d(min, max);
-        return d(gen);
+        return sampleDistribution(d);
     }
 
     /**
@@ -70,9 +136,8 @@ namespace NEAT {
      */
     template <typename dType = int>
     dType uniformIntDistribution(dType min, dType max) {
-        std::mt19937& gen = Seed::getGenerator();
         std::uniform_int_distribution<dType> d(min, max);
-        return d(gen);
+        return sampleDistribution(d);
     }
 
     inline void coutTab(int tabSize) {
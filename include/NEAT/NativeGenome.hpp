@@ -0,0 +1,156 @@
+#ifndef __NEAT_NATIVE_GENOME_HPP__
+#define __NEAT_NATIVE_GENOME_HPP__
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+#include "./ExecutionPlan.hpp"
+
+namespace NEAT {
+
+    // forward declaration
+    template <typename dType, typename T2>
+    class Genome;
+
+    /**
+     * @brief Compiler and on-disk cache of generated shared objects, shared by all NativeGenome types
+     *
+     * Generated sources are compiled once into the cache directory and loaded with dlopen. A shared object is found
+     * again by the name derived from its source, by later genomes of this process and by later processes. Loaded
+     * objects stay open while a NativeGenome uses them. Concurrent loads of one name compile it once, loads of other
+     * names are not blocked while the compiler runs.
+     */
+    class NativeCodeCache final {
+    public:
+        NativeCodeCache() = delete;
+
+        /**
+         * @brief Set the compiler command, default is $CXX or c++
+         *
+         * @param compiler shell command invoking a C++ compiler accepting -O2 -shared -fPIC -o, the file names are quoted
+         */
+        static void setCompiler(const std::string& compiler);
+        static std::string getCompiler();
+        /**
+         * @brief Set the directory of generated sources and shared objects, default is neatcpy-native in the temporary directory
+         *
+         * @param directory directory to use, created when missing
+         */
+        static void setDirectory(const std::string& directory);
+        static std::string getDirectory();
+        /**
+         * @brief Check if generated code can be compiled and loaded on this platform
+         *
+         * @return true if the compiler runs, checked once per compiler command
+         */
+        static bool isAvailable();
+
+        /**
+         * @brief Compile a source into a shared object unless cached, and load it
+         *
+         * @param source complete C++ translation unit
+         * @param name file name of the source and shared object without extension, unique per source
+         * @return std::shared_ptr<void> handle of the loaded object, nullptr if it could not be compiled or loaded
+         */
+        static std::shared_ptr<void> load(const std::string& source, const std::string& name);
+        /**
+         * @brief Look up a symbol of a loaded object
+         *
+         * @return void* address of the symbol, nullptr if missing
+         */
+        static void* getSymbol(const std::shared_ptr<void>& library, const char* symbol);
+    };
+
+    /**
+     * @brief Genome compiled to native code, a straight-line forward pass with its weights and biases as constants
+     *
+     * The generated function follows the slot order of the execution plan and adds the edges of a slot in the same
+     * order, so it computes the same values as ExecutionPlan::evaluate, infinities and NaN included. Slots that no
+     * output depends on are removed, weights of 1 and -1 become additions and subtractions, and slots whose sources are
+     * all constant are evaluated at generation time. Edges of weight 0 are kept, as 0 * inf is NaN. Plans with user-defined activation functions, platforms without
+     * dlopen and failed compilations fall back to the execution plan.
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    class NativeGenome final {
+    public:
+        /**
+         * @brief Compile a genome
+         *
+         * @param genome genome to compile, later changes of the genome are not seen
+         */
+        NativeGenome(const Genome<dType, T2>& genome);
+        /**
+         * @brief Compile an execution plan
+         *
+         * @param plan plan to compile
+         */
+        NativeGenome(const std::shared_ptr<const ExecutionPlan<dType, T2>>& plan);
+
+        /**
+         * @brief Evaluate for a single input vector
+         *
+         * @param inputs pointer to inputSize input values
+         * @param outputs pointer to outputSize values to write
+         */
+        void evaluate(const dType* inputs, dType* outputs) const;
+        /**
+         * @brief Evaluate for a batch of input rows
+         *
+         * @param inputs row-major input block of rows x inputSize values
+         * @param rows number of rows in the batch
+         * @param outputs row-major output block of rows x outputSize values to write
+         */
+        void evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs) const;
+        /**
+         * @brief Evaluate for a single input vector
+         *
+         * @param inputs input values
+         * @return std::vector<dType> output values
+         */
+        std::vector<dType> feedForward(const std::vector<dType>& inputs) const;
+        /**
+         * @brief Get the index of the largest output, as Genome::predict
+         *
+         * @param inputs input values
+         * @return T2 index of the largest output
+         */
+        T2 predict(const std::vector<dType>& inputs) const;
+
+        /**
+         * @brief Check if the genome runs as native code
+         *
+         * @return false if it falls back to the execution plan
+         */
+        bool isNative() const;
+        const T2& getInputSize() const;
+        const T2& getOutputSize() const;
+
+        /**
+         * @brief Generate the C++ source of a plan
+         *
+         * Defines extern "C" functions functionName(const dType* inputs, dType* outputs) and
+         * functionName_batch(const dType* inputs, std::size_t rows, dType* outputs).
+         *
+         * @param plan plan to generate, without user-defined activation functions
+         * @param functionName name of the generated function
+         * @return std::string complete translation unit
+         */
+        static std::string generateSource(const ExecutionPlan<dType, T2>& plan, const std::string& functionName);
+
+    private:
+        typedef void (*Function)(const dType*, dType*);
+        typedef void (*BatchFunction)(const dType*, std::size_t, dType*);
+
+        std::shared_ptr<const ExecutionPlan<dType, T2>> plan;
+        std::shared_ptr<void> library;
+        Function function = nullptr;
+        BatchFunction batchFunction = nullptr;
+    };
+}
+
+#endif // __NEAT_NATIVE_GENOME_HPP__
@@ -2,8 +2,10 @@
 #define __NEAT_NODE_HPP__
 
 #include <vector>
+#include <cstdint>
 
 #include "Activation.hpp"
+#include "GeneArena.hpp"
 #include "Genome.hpp"
 #include "Edge.hpp"
 
@@ -47,9 +49,20 @@ namespace NEAT {
          * @param id id of the node
          * @param nodeType type of the node
          * @param layer layer of the node
-         * @param activationFunction activation function of the node
+         * @param activationType tag of the activation function of the node
          */
-        Node(T2 id, NodeType nodeType, int layer, dType bias, ActivationFunction<dType>* activationFunction);
+        Node(T2 id, NodeType nodeType, int layer, dType bias, ActivationType activationType);
+
+        /**
+         * @brief Allocate from the active GeneArena of the thread, or the heap
+         *
+         */
+        static void* operator new(std::size_t size) {
+            return GeneArena::allocate(size);
+        }
+        static void operator delete(void* pointer) noexcept {
+            GeneArena::deallocate(pointer);
+        }
 
         /**
          * @brief Get the Id of the node
@@ -65,7 +78,8 @@ namespace NEAT {
         const NodeType& getType() const;
 
         /**
-         * @brief Get the Layer of the node
+         * @brief Get the Layer of the node, only a hint for ordering, hidden layers are not renumbered
+         * when nodes are inserted, the evaluation order is Genome::getTopologicalOrder
          *
          * @return const int&
          */
@@ -78,6 +92,20 @@ namespace NEAT {
          */
         void setLayer(int layer);
 
+        /**
+         * @brief Get the genome-local index of the node, the position of the node in Genome::getNodeByIndex
+         *
+         * @return const std::uint32_t& index, -1 if the node has not been added to a genome
+         */
+        const std::uint32_t& getIndex() const;
+
+        /**
+         * @brief Set the genome-local index of the node, set by the genome when the node is added
+         *
+         * @param index
+         */
+        void setIndex(std::uint32_t index);
+
         /**
          * @brief reset the value of the node
          *
@@ -113,11 +141,11 @@ namespace NEAT {
         void setBias(dType value);
 
         /**
-         * @brief Get the Activation Function object pointer
+         * @brief Get the tag of the activation function
          *
-         * @return ActivationFunction<dType>*
+         * @return ActivationType
          */
-        ActivationFunction<dType>* getActivationFunction() const;
+        ActivationType getActivationType() const;
 
         /**
          * @brief get if node has been visited in a feed forward
@@ -157,7 +185,7 @@ namespace NEAT {
         void addIncomingEdge(std::vector<Edge<dType, T2>*> edges);
         void addOutgoingEdge(Edge<dType, T2>* edge);
         void addOutgoingEdge(std::vector<Edge<dType, T2>*> edges);
-        void setActivationFunction(ActivationFunction<dType>* activationFunction);
+        void setActivationType(ActivationType activationType);
 
         const std::vector<Edge<dType, T2>*>& getIncomingEdges() const;
         const std::vector<Edge<dType, T2>*>& getOutgoingEdges() const;
@@ -205,6 +233,11 @@ namespace NEAT {
          *
          */
         int layer;
+        /**
+         * @brief index of the node in its genome
+         *
+         */
+        std::uint32_t index = static_cast<std::uint32_t>(-1);
         /**
          * @brief visited flag for feed forward
          *
@@ -212,10 +245,10 @@ namespace NEAT {
         bool visited = false;
         // NodeState state = NodeState::UNINITIALIZED;
         /**
-         * @brief activation function of the node
+         * @brief tag of the activation function of the node
          *
          */
-        ActivationFunction<dType>* activationFunction;
+        ActivationType activationType = ActivationType::IDENTITY;
         // prevent copy and assignment
         Node(const Node<dType, T2>& node) = delete;
         Node<dType, T2>& operator=(const Node<dType, T2>& node) = delete;
@@ -1,7 +1,11 @@
 #ifndef __NEAT_POPULATION_HPP__
 #define __NEAT_POPULATION_HPP__
 
+#include <functional>
+
 #include "./Genome.hpp"
+#include "./TopologyGroup.hpp"
+#include "./PopulationGraph.hpp"
 #include "./config.hpp"
 
 namespace NEAT {
@@ -14,6 +18,25 @@ namespace NEAT {
 
     template <typename dType>
     struct SpeciesConfig;
+    template <typename dType, typename T2>
+    class SpeciesHandler;
+    template <typename dType, typename T2>
+    class GeneHistory;
+    class ThreadPool;
+    class GeneArena;
+
+    /**
+     * @brief How Population::step and Population::evaluateSupervised evaluate the genomes
+     *
+     */
+    enum class EvaluationMode : std::uint8_t {
+        // every genome on its own
+        GENOME,
+        // genomes of equal structure together, see TopologyGroup
+        TOPOLOGY_GROUPS,
+        // all genomes as one graph with a shared level schedule, see PopulationGraph
+        POPULATION_GRAPH
+    };
 
     /**
      * @brief Class for Genome storage, handling, and interaction from environment
@@ -29,8 +52,74 @@ namespace NEAT {
 
         const std::vector<Genome<dType, T2>*>& startNextGeneration();
         const std::vector<Genome<dType, T2>*>& startNextGeneration(T2 populationSize);
-        const std::vector<Genome<dType, T2>*>& startNextGeneration(std::vector<dType> fitnesses);
-        const std::vector<Genome<dType, T2>*>& startNextGeneration(T2 populationSize, std::vector<dType> fitnesses);
+        const std::vector<Genome<dType, T2>*>& startNextGeneration(const std::vector<dType>& fitnesses);
+        const std::vector<Genome<dType, T2>*>& startNextGeneration(T2 populationSize, const std::vector<dType>& fitnesses);
+        /**
+         * @brief Set the fitness of the genomes from a buffer and start the next generation
+         *
+         * @param fitnesses pointer to count fitness values, read in place
+         * @param count number of fitness values, at least the population size
+         */
+        const std::vector<Genome<dType, T2>*>& startNextGeneration(const dType* fitnesses, std::size_t count);
+        const std::vector<Genome<dType, T2>*>& startNextGeneration(T2 populationSize, const dType* fitnesses, std::size_t count);
+        /**
+         * @brief Evaluate all genomes concurrently and set their fitness
+         *
+         * @param fitnessFunction returns the fitness of a genome, called concurrently for different genomes
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         */
+        void evaluate(const std::function<dType(Genome<dType, T2>&)>& fitnessFunction, unsigned int numThreads = 0);
+        /**
+         * @brief Evaluate all genomes concurrently on a supervised dataset, fitness is 1 / (1 + mean squared error)
+         *
+         * @param inputs row-major input block of rows x inputSize values
+         * @param targets row-major target block of rows x outputSize values
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         */
+        void evaluateSupervised(const std::vector<dType>& inputs, const std::vector<dType>& targets, unsigned int numThreads = 0);
+        /**
+         * @brief Evaluate all genomes concurrently on a supervised dataset in caller-owned buffers
+         *
+         * @param inputs pointer to a row-major input block of rows x inputSize values
+         * @param targets pointer to a row-major target block of rows x outputSize values
+         * @param rows number of rows
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         */
+        void evaluateSupervised(const dType* inputs, const dType* targets, std::size_t rows, unsigned int numThreads = 0);
+        /**
+         * @brief Evaluate every genome concurrently on its own observation, one control step of the whole population
+         *
+         * The genomes are evaluated as set by setEvaluationMode.
+         *
+         * @param observations row-major block of genomes x inputSize values, row i is the input of genome i
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         * @return std::vector<dType> row-major block of genomes x outputSize values, row i is the output of genome i
+         */
+        std::vector<dType> step(const std::vector<dType>& observations, unsigned int numThreads = 0);
+        /**
+         * @brief Evaluate every genome concurrently on its own observation into a caller-owned buffer
+         *
+         * @param observations pointer to a row-major block of genomes x inputSize values
+         * @param actions pointer to a row-major block of genomes x outputSize values to write
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         */
+        void step(const dType* observations, dType* actions, unsigned int numThreads = 0);
+        /**
+         * @brief Get the index of the largest output of every genome on its own observation, as Genome::predict
+         *
+         * @param observations row-major block of genomes x inputSize values, row i is the input of genome i
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         * @return std::vector<T2> index of the largest output of each genome
+         */
+        std::vector<T2> stepPredict(const std::vector<dType>& observations, unsigned int numThreads = 0);
+        /**
+         * @brief Get the index of the largest output of every genome on its own observation into a caller-owned buffer
+         *
+         * @param observations pointer to a row-major block of genomes x inputSize values
+         * @param actions pointer to one index per genome to write
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         */
+        void stepPredict(const dType* observations, T2* actions, unsigned int numThreads = 0);
         // 
         const std::vector<Genome<dType, T2>*>& getGenomes() const;
         const Genome<dType, T2>* getGenome(T2 index) const;
@@ -40,6 +129,18 @@ namespace NEAT {
         const T2& getGeneration() const;
         const MutationConfig<dType>& getMutationConfig() const;
         const SpeciesConfig<dType>& getSpeciesConfig() const;
+        /**
+         * @brief Get the number of species after the last call to startNextGeneration
+         *
+         * @return T2 number of species
+         */
+        T2 getNumberOfSpecies() const;
+        /**
+         * @brief Get the innovation registry of the population, use it to mutate genomes of the population
+         *
+         * @return GeneHistory<dType, T2>& innovation registry
+         */
+        GeneHistory<dType, T2>& getGeneHistory();
         // 
         const std::vector<dType>& getBestFitnessHistory() const;
         const std::vector<dType>& getAverageFitnessHistory() const;
@@ -48,10 +149,59 @@ namespace NEAT {
 
         void setMutationConfig(MutationConfig<dType> mutationConfig);
         void setSpeciesConfig(SpeciesConfig<dType> speciesConfig);
+        /**
+         * @brief Set how step and evaluateSupervised evaluate the genomes, TOPOLOGY_GROUPS by default
+         *
+         * @param evaluationMode evaluation mode
+         */
+        void setEvaluationMode(EvaluationMode evaluationMode);
+        EvaluationMode getEvaluationMode() const;
 
         void print(int tabSize) const;
 
     private:
+        /**
+         * @brief Get the worker pool, the pool is kept between calls and only rebuilt when the thread count changes
+         *
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         * @return ThreadPool& worker pool
+         */
+        ThreadPool& getThreadPool(unsigned int numThreads);
+        /**
+         * @brief Get the worker pool and size the step buffers for its threads
+         *
+         * @param numThreads number of threads, 0 uses the hardware concurrency
+         * @return ThreadPool& worker pool
+         */
+        ThreadPool& getStepThreadPool(unsigned int numThreads);
+        /**
+         * @brief Group the genomes by the structure of their execution plans, kept until an execution plan changes
+         *
+         * @param pool worker pool compiling the execution plans
+         */
+        void updateTopologyGroups(ThreadPool& pool);
+        /**
+         * @brief Hold the execution plan of every genome, groups and graph are dropped when a plan changed
+         *
+         * @param pool worker pool compiling the execution plans
+         */
+        void updateGenomePlans(ThreadPool& pool);
+        /**
+         * @brief Get the genomes packed into one graph, kept until an execution plan changes
+         *
+         * @param pool worker pool compiling the execution plans
+         * @return const PopulationGraph<dType, T2>& graph of all genomes
+         */
+        const PopulationGraph<dType, T2>& getPopulationGraph(ThreadPool& pool);
+
+        // genomes of equal structure are evaluated together in groups of MIN_GROUP_SIZE to MAX_GROUP_SIZE genomes
+        static constexpr std::size_t MIN_GROUP_SIZE = 4;
+        static constexpr std::size_t MAX_GROUP_SIZE = 64;
+        // supervised datasets of up to MAX_GROUPED_ROWS rows are evaluated by groups, larger ones per genome over the rows
+        static constexpr std::size_t MAX_GROUPED_ROWS = 16;
+        // rows of a supervised dataset evaluated at once by the population graph
+        static constexpr std::size_t GRAPH_BLOCK_ROWS = 16;
+
         std::vector<Genome<dType, T2>*> genomes;
         T2 inputSize;
         T2 outputSize;
@@ -63,6 +213,24 @@ namespace NEAT {
         std::vector<dType> averageFitnessHistory;
         std::vector<dType> worstFitnessHistory;
         std::vector<Genome<dType, T2>*> bestGenomeHistory;
+        ThreadPool* threadPool = nullptr;
+        // workspace of each thread and outputs of stepPredict, kept between steps
+        std::vector<ActivationWorkspace<dType>> stepWorkspaces;
+        std::vector<dType> stepActions;
+        EvaluationMode evaluationMode = EvaluationMode::TOPOLOGY_GROUPS;
+        // execution plan of each genome, the groups of equal structure and the graph of all genomes built from them
+        std::vector<std::shared_ptr<const ExecutionPlan<dType, T2>>> genomePlans;
+        bool topologyGroupsValid = false;
+        PopulationGraph<dType, T2>* populationGraph = nullptr;
+        std::vector<TopologyGroup<dType, T2>> topologyGroups;
+        std::vector<std::vector<std::size_t>> topologyGroupMembers;
+        std::vector<std::size_t> ungroupedGenomes;
+        // species are kept between generations
+        SpeciesHandler<dType, T2>* speciesHandler = nullptr;
+        // innovation numbers of all genomes of the population
+        GeneHistory<dType, T2>* geneHistory = nullptr;
+        // arena holding the genes of the current generation, the arena of the last generation is released after reproduction
+        GeneArena* geneArena = nullptr;
         // prevent copy and assignment
         Population(const Population<dType, T2>&) = delete;
         Population<dType, T2>& operator=(const Population<dType, T2>&) = delete;
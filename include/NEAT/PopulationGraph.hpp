@@ -0,0 +1,94 @@
+#ifndef __NEAT_POPULATION_GRAPH_HPP__
+#define __NEAT_POPULATION_GRAPH_HPP__
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "./ExecutionPlan.hpp"
+
+namespace NEAT {
+
+    // forward declaration
+    class ThreadPool;
+
+    /**
+     * @brief Execution plans of a whole population packed into one block-diagonal graph with a shared level schedule
+     *
+     * The level of a node is 0 without incoming edges, else one more than the highest level of its sources, so all
+     * nodes of a level only depend on lower levels. Nodes are numbered level by level, within a level by activation
+     * function, so every level is one sparse matrix-vector product over the nodes of all genomes followed by runs of
+     * the same activation function, applied by SimdKernels. A level is split into segments of at most SEGMENT_SIZE
+     * nodes, the segments of a level are evaluated concurrently when a thread pool is given.
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    class PopulationGraph final {
+    public:
+        /**
+         * @brief Pack execution plans into one graph
+         *
+         * @param plans plan of each genome, all with the same input and output size
+         */
+        PopulationGraph(const std::vector<std::shared_ptr<const ExecutionPlan<dType, T2>>>& plans);
+
+        /**
+         * @brief Evaluate every genome for its own input vector
+         *
+         * @param inputs row-major block of genomes x inputSize values, row i is the input of genome i
+         * @param outputs row-major block of genomes x outputSize values to write
+         * @param workspace buffers of the evaluation
+         * @param pool worker pool evaluating the segments of a level concurrently, nullptr evaluates on the calling thread
+         */
+        void evaluate(const dType* inputs, dType* outputs, ActivationWorkspace<dType>& workspace, ThreadPool* pool = nullptr) const;
+        /**
+         * @brief Evaluate every genome for the same batch of input rows
+         *
+         * @param inputs row-major input block of rows x inputSize values
+         * @param rows number of rows in the batch
+         * @param outputs genome-major block of genomes x rows x outputSize values to write
+         * @param workspace buffers of the evaluation
+         * @param pool worker pool evaluating the segments of a level concurrently, nullptr evaluates on the calling thread
+         */
+        void evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace, ThreadPool* pool = nullptr) const;
+
+        std::size_t getGenomeCount() const;
+        std::uint32_t getNodeCount() const;
+        std::uint32_t getEdgeCount() const;
+        std::uint32_t getLevelCount() const;
+
+        // largest number of nodes evaluated as one task
+        static constexpr std::uint32_t SEGMENT_SIZE = 1024;
+
+    private:
+        /**
+         * @brief Nodes [begin, end) of one level with the same activation function
+         *
+         */
+        struct Segment {
+            std::uint32_t begin;
+            std::uint32_t end;
+            ActivationType activation;
+        };
+
+        std::size_t genomeCount;
+        T2 inputSize;
+        T2 outputSize;
+        std::vector<dType> biases;
+        // incoming edges of each node in CSR form, sources are nodes of lower levels
+        std::vector<std::uint32_t> edgeOffsets;
+        std::vector<std::uint32_t> edgeSources;
+        std::vector<dType> edgeWeights;
+        std::vector<Segment> segments;
+        // segments of level l are [levelOffsets[l], levelOffsets[l + 1]) in segments
+        std::vector<std::uint32_t> levelOffsets;
+        // node of each input and output, genome-major
+        std::vector<std::uint32_t> inputNodes;
+        std::vector<std::uint32_t> outputNodes;
+    };
+}
+
+#endif // __NEAT_POPULATION_GRAPH_HPP__
@@ -0,0 +1,192 @@
+#ifndef __NEAT_QUANTIZED_GENOME_HPP__
+#define __NEAT_QUANTIZED_GENOME_HPP__
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+#include "./Activation.hpp"
+
+namespace NEAT {
+
+    // forward declaration
+    template <typename dType, typename T2>
+    class Genome;
+    template <typename dType, typename T2>
+    class ExecutionPlan;
+
+    /**
+     * @brief Integer types used by a quantized genome of a value type
+     *
+     * @tparam qType type of quantized weights and node values, std::int8_t or std::int16_t
+     */
+    template <typename qType>
+    struct QuantizationTraits;
+
+    template <>
+    struct QuantizationTraits<std::int8_t> {
+        typedef std::int32_t Accumulator;
+        // bits of the fixed-point multipliers, accumulator times multiplier fits into 64 bits
+        static constexpr int MULTIPLIER_BITS = 30;
+        // bits of the largest bias, the weighted sum of many edges on top of it still fits into the accumulator
+        static constexpr int BIAS_BITS = 30;
+    };
+
+    template <>
+    struct QuantizationTraits<std::int16_t> {
+        typedef std::int64_t Accumulator;
+        static constexpr int MULTIPLIER_BITS = 20;
+        static constexpr int BIAS_BITS = 40;
+    };
+
+    /**
+     * @brief Reusable buffers for evaluating quantized genomes
+     *
+     * @tparam qType type of quantized node values
+     */
+    template <typename qType = std::int8_t>
+    struct QuantizedWorkspace final {
+        /**
+         * @brief quantized node values of the last evaluation
+         *
+         */
+        std::vector<qType> values;
+    };
+
+    /**
+     * @brief Accuracy of a quantized genome against the feedForward of its genome
+     *
+     * @tparam dType type of data
+     */
+    template <typename dType = double>
+    struct QuantizationReport final {
+        std::size_t rows = 0;
+        dType maxAbsoluteError = 0;
+        dType meanAbsoluteError = 0;
+        /**
+         * @brief fraction of rows where both pick the same output, as predict does
+         *
+         */
+        dType argmaxAgreement = 0;
+    };
+
+    /**
+     * @brief Fixed-point form of a genome for deployment, evaluated with integer arithmetic only
+     *
+     * Every node value is a qType with a per-node scale, value = quantized * scale. The scales of the sources are
+     * folded into the weights of each node, so the weights of a node are quantized with one per-node scale and the
+     * weighted sum is an integer dot product with the bias in the accumulator. The accumulator is requantized by a
+     * fixed-point multiplier, sigmoid and tanh read an interpolated lookup table, ReLU, identity and step are integer
+     * operations and user-defined activation functions get a lookup table over the range seen in calibration.
+     * Scales of ReLU, identity and user-defined nodes and of the inputs come from a calibration set of inputs.
+     *
+     * @tparam dType type of data of the genome
+     * @tparam T2 type of innovation number
+     * @tparam qType type of quantized weights and node values, std::int8_t or std::int16_t
+     */
+    template <typename dType = double, typename T2 = int, typename qType = std::int8_t>
+    class QuantizedGenome final {
+    public:
+        typedef typename QuantizationTraits<qType>::Accumulator Accumulator;
+
+        /**
+         * @brief Quantize a genome
+         *
+         * @param genome genome to quantize
+         * @param calibrationInputs row-major block of inputs representative of deployment, at least one row
+         */
+        QuantizedGenome(const Genome<dType, T2>& genome, const std::vector<dType>& calibrationInputs);
+        /**
+         * @brief Quantize an execution plan
+         *
+         * @param plan plan to quantize
+         * @param calibrationInputs row-major block of inputs representative of deployment, at least one row
+         */
+        QuantizedGenome(const ExecutionPlan<dType, T2>& plan, const std::vector<dType>& calibrationInputs);
+
+        /**
+         * @brief Evaluate for a single input vector
+         *
+         * @param inputs pointer to inputSize input values
+         * @param outputs pointer to outputSize values to write
+         * @param workspace buffers of the evaluation
+         */
+        void evaluate(const dType* inputs, dType* outputs, QuantizedWorkspace<qType>& workspace) const;
+        /**
+         * @brief Evaluate for a single input vector, with a workspace of the calling thread
+         *
+         * @param inputs input values
+         * @return std::vector<dType> output values
+         */
+        std::vector<dType> feedForward(const std::vector<dType>& inputs) const;
+        /**
+         * @brief Get the index of the largest output, as Genome::predict
+         *
+         * @param inputs input values
+         * @return T2 index of the largest output
+         */
+        T2 predict(const std::vector<dType>& inputs) const;
+
+        /**
+         * @brief Compare the outputs with the feedForward of a genome
+         *
+         * @param genome genome to compare with, usually the quantized genome
+         * @param inputs row-major block of inputs
+         * @return QuantizationReport<dType> errors of the quantized outputs
+         */
+        QuantizationReport<dType> compare(const Genome<dType, T2>& genome, const std::vector<dType>& inputs) const;
+
+        const T2& getInputSize() const;
+        const T2& getOutputSize() const;
+        std::uint32_t getNodeCount() const;
+        std::uint32_t getEdgeCount() const;
+        /**
+         * @brief Get the number of bytes of the weights, tables and per-node data
+         *
+         * @return std::size_t bytes used
+         */
+        std::size_t getMemoryUsage() const;
+
+        static constexpr qType QMAX = std::numeric_limits<qType>::max();
+        // entries of a lookup table are LUT_SIZE + 1 points over [-range, range]
+        static constexpr std::uint32_t LUT_SIZE = 1024;
+        // fraction bits of a lookup table position, for interpolation
+        static constexpr int LUT_FRACTION_BITS = 16;
+
+    private:
+        void quantize(const ExecutionPlan<dType, T2>& plan, const std::vector<dType>& calibrationInputs);
+        /**
+         * @brief Append a lookup table over [-range, range] to the table pool
+         *
+         * @return std::uint32_t offset of the table
+         */
+        std::uint32_t addTable(ActivationType type, dType range, dType scale);
+
+        T2 inputSize;
+        T2 outputSize;
+        // incoming edges of each slot in CSR form, as in ExecutionPlan
+        std::vector<std::uint32_t> edgeOffsets;
+        std::vector<std::uint32_t> edgeSources;
+        std::vector<qType> edgeWeights;
+        // weight of the input value of input slots, zero for other slots
+        std::vector<qType> inputWeights;
+        // bias of each slot in accumulator units
+        std::vector<Accumulator> biases;
+        // fixed-point multiplier and shift of each slot, to a table position or to the quantized value
+        std::vector<std::int64_t> multipliers;
+        std::vector<std::uint8_t> shifts;
+        std::vector<ActivationType> activations;
+        // offset of the lookup table of each slot in tables, unused for ReLU, identity and step
+        std::vector<std::uint32_t> tableOffsets;
+        std::vector<qType> tables;
+        // value scale of each slot
+        std::vector<dType> scales;
+        // scale of each raw input
+        std::vector<dType> inputScales;
+        std::vector<std::uint32_t> inputSlots;
+        std::vector<std::uint32_t> outputSlots;
+    };
+}
+
+#endif // __NEAT_QUANTIZED_GENOME_HPP__
@@ -0,0 +1,110 @@
+#ifndef __NEAT_SIMD_KERNELS_HPP__
+#define __NEAT_SIMD_KERNELS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./Activation.hpp"
+
+namespace NEAT {
+
+    /**
+     * @brief Instruction sets of the vectorized kernels, ordered by width
+     *
+     */
+    enum class InstructionSet : std::uint8_t {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * @brief Vectorized activation and accumulation kernels over contiguous values, used by batched inference
+     *
+     * The instruction set is detected once at runtime, the widest one supported by the cpu is used.
+     * The scalar fallback evaluates the same formulas as applyActivation. The vectorized kernels compute exp with
+     * a polynomial, sigmoid and tanh differ from the scalar results by at most TOLERANCE (absolute), ReLU, step
+     * and identity are exact. Weighted sums add the edges in the same order, AVX2 and AVX-512 fuse the
+     * multiply-add, which only changes the rounding of each step.
+     */
+    class SimdKernels final {
+    public:
+        /**
+         * @brief Max absolute difference of vectorized sigmoid and tanh to the scalar fallback, two units in the last place of 1
+         *
+         */
+        static constexpr double TOLERANCE = 4.5e-16;
+        /**
+         * @brief Max absolute difference of vectorized sigmoid and tanh to the scalar fallback for float values, two units in the last place of 1
+         *
+         */
+        static constexpr float TOLERANCE_FLOAT = 2.4e-7f;
+
+        /**
+         * @brief Get the widest instruction set supported by the cpu
+         *
+         * @return InstructionSet supported instruction set
+         */
+        static InstructionSet getSupportedInstructionSet();
+        /**
+         * @brief Get the instruction set used by the kernels
+         *
+         * @return InstructionSet instruction set in use
+         */
+        static InstructionSet getInstructionSet();
+        /**
+         * @brief Select the instruction set used by the kernels, capped at the supported one
+         *
+         * @param instructionSet requested instruction set
+         * @return InstructionSet instruction set in use
+         */
+        static InstructionSet setInstructionSet(InstructionSet instructionSet);
+
+        /**
+         * @brief Apply the activation function of a tag to contiguous values in place
+         *
+         * User-defined activation functions are applied by applyActivation.
+         *
+         * @param type tag of the function
+         * @param values values to activate
+         * @param count number of values
+         */
+        static void activate(ActivationType type, double* values, std::size_t count);
+        static void activate(ActivationType type, float* values, std::size_t count);
+
+        /**
+         * @brief Add a bias and the weighted sum of sources to contiguous values, in one pass over the values
+         *
+         * target[i] += bias + sum over e of weights[e] * sources[e][i], edges are added in order
+         *
+         * @param target values to accumulate into
+         * @param count number of values
+         * @param bias bias added to every value
+         * @param sources edgeCount pointers to count source values
+         * @param weights edgeCount weights
+         * @param edgeCount number of edges
+         */
+        static void weightedSum(double* target, std::size_t count, double bias, const double* const* sources, const double* weights, std::size_t edgeCount);
+        static void weightedSum(float* target, std::size_t count, float bias, const float* const* sources, const float* weights, std::size_t edgeCount);
+        /**
+         * @brief Add a bias and a weighted sum of sources to contiguous values, with a bias and weights per value
+         *
+         * target[i] += biases[i] + sum over e of weights[e * count + i] * sources[e][i], edges are added in order
+         *
+         * @param target values to accumulate into
+         * @param count number of values
+         * @param biases count biases
+         * @param sources edgeCount pointers to count source values
+         * @param weights edgeCount x count weights, edge-major
+         * @param edgeCount number of edges
+         */
+        static void laneWeightedSum(double* target, std::size_t count, const double* biases, const double* const* sources, const double* weights, std::size_t edgeCount);
+        static void laneWeightedSum(float* target, std::size_t count, const float* biases, const float* const* sources, const float* weights, std::size_t edgeCount);
+
+    private:
+        SimdKernels() = delete;
+    };
+}
+
+#endif // __NEAT_SIMD_KERNELS_HPP__
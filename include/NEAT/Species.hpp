@@ -2,6 +2,7 @@
 #define __NEAT_SPECIES_HPP__
 
 #include <vector>
+#include <limits>
 
 #include "./Genome.hpp"
 
@@ -23,6 +24,24 @@ namespace NEAT {
         std::vector<const Edge<dType, T2>*> matching;
     };
 
+    /**
+     * @brief Struct for edge difference counts, without the edges themselves
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    struct EdgeDifferenceCount final {
+        T2 disjoint = 0;
+        T2 excess = 0;
+        T2 matching = 0;
+        /**
+         * @brief sum of absolute weight differences of the matching edges
+         *
+         */
+        dType weightDifference = 0;
+    };
+
     /**
      * @brief Species class for SpeciesHandler
      *
@@ -32,21 +51,61 @@ namespace NEAT {
     template <typename dType, typename T2>
     class Species final {
     public:
-        Species(Genome <dType, T2>* representative);
+        /**
+         * @brief Construct a new Species object
+         *
+         * @param genome first genome of the species, a clone of it becomes the representative
+         * @param id id of the species
+         */
+        Species(Genome <dType, T2>* genome, T2 id = 0);
+        ~Species();
 
         /**
-         * @brief Add genome to species
+         * @brief Add genome to species, the representative does not change until updateStatistics
          *
          * @param genome
          */
         void addGenome(Genome<dType, T2>* genome);
 
+        /**
+         * @brief Remove all genomes from the species, the representative is kept
+         *
+         */
+        void clearGenomes();
+
+        /**
+         * @brief Age the species by a generation, update the best fitness and stagnation,
+         * and make a clone of the fittest genome the representative
+         *
+         */
+        void updateStatistics();
+
         /**
          * @brief Get the Representative object
          *
          * @return const Genome<dType, T2>*
          */
         const Genome<dType, T2>* getRepresentative() const;
+        const std::vector<Genome<dType, T2>*>& getGenomes() const;
+        const T2& getId() const;
+        /**
+         * @brief Get the number of generations the species has existed
+         *
+         * @return const T2& age
+         */
+        const T2& getAge() const;
+        /**
+         * @brief Get the best fitness of the species in any generation, before fitness sharing
+         *
+         * @return const dType& best fitness
+         */
+        const dType& getBestFitness() const;
+        /**
+         * @brief Get the number of generations since the best fitness of the species improved
+         *
+         * @return const T2& stagnation
+         */
+        const T2& getStagnation() const;
 
         /**
          * @brief Get the distance between the genome and the representative of the species
@@ -62,12 +121,24 @@ namespace NEAT {
         /**
          * @brief Get the Edge Difference of 2 genomes
          *
+         * Edges of genome1 are classified in one merge walk over both innovation-ordered edge maps,
+         * edges of genome1 beyond the max innovation number of genome2 are excess.
+         *
          * @param genome1 reference genome
          * @param genome2 target genome
          * @return EdgeDifference
          */
         EdgeDifference<dType, T2> getEdgeDifference(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2) const;
 
+        /**
+         * @brief Get the Edge Difference counts of 2 genomes, same classification as getEdgeDifference
+         *
+         * @param genome1 reference genome
+         * @param genome2 target genome
+         * @return EdgeDifferenceCount
+         */
+        EdgeDifferenceCount<dType, T2> getEdgeDifferenceCount(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2) const;
+
         // /**
         //  * @brief Get the Excess Difference of the genome and the representative of the species
         //  *
@@ -135,6 +206,17 @@ namespace NEAT {
          */
         std::vector<Genome<dType, T2>*> generateNextGeneration(GeneHistory<dType, T2>& geneHistory, T2 n, const MutationConfig<dType>& mutationConfig);
 
+        /**
+         * @brief Generate a single unmutated offspring, genomes have to be sorted by sortGenomes
+         *
+         * Only reads the species, so offspring can be generated from several threads at once.
+         * Offspring of a species producing more than 2 genomes are to be mutated, smaller quotas are copies.
+         *
+         * @param n number of genomes the species reproduces in this generation
+         * @return Genome<dType, T2>* offspring
+         */
+        Genome<dType, T2>* generateOffspring(T2 n) const;
+
         /**
          * @brief Get the Average Fitness of the species, assume fitness sharing has been done and total fitness is calculated
          *
@@ -154,11 +236,15 @@ namespace NEAT {
          */
         std::vector<Genome<dType, T2>*> genomes;
         /**
-         * @brief Representative of the species
+         * @brief Representative of the species, owned by the species
          *
          */
         Genome<dType, T2>* representative;
         dType totalFitness = 0;
+        T2 id;
+        T2 age = 0;
+        dType bestFitness = std::numeric_limits<dType>::lowest();
+        T2 stagnation = 0;
         // prevent copying
         Species(const Species<dType, T2>& species) = delete;
         Species<dType, T2>& operator=(const Species<dType, T2>& species) = delete;
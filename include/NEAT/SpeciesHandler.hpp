@@ -2,6 +2,7 @@
 #define __NEAT_SpeciesHandler_HPP__
 
 #include <vector>
+#include <unordered_map>
 
 #include "./Genome.hpp"
 #include "./Edge.hpp"
@@ -19,6 +20,7 @@ namespace NEAT {
     struct MutationConfig;
     template <typename dType>
     struct SpeciesConfig;
+    class ThreadPool;
 
     /**
      * @brief Class for Species storage, reproduction and handling, all genomes has to be calculated fitness before adding
@@ -32,8 +34,38 @@ namespace NEAT {
         SpeciesHandler(Genome<dType, T2>* genome, dType c1, dType c2, dType c3, dType threshold);
         SpeciesHandler(std::vector<Genome<dType, T2>*>& genome, dType c1, dType c2, dType c3, dType threshold);
         SpeciesHandler(Genome<dType, T2>* genome, SpeciesConfig<dType> speciesConfig);
-        SpeciesHandler(std::vector<Genome<dType, T2>*>& genome, SpeciesConfig<dType> speciesConfig);
+        /**
+         * @brief Construct a new Species Handler object
+         *
+         * @param genome genomes to add
+         * @param speciesConfig species config
+         * @param threadPool worker pool for parallel speciation, nullptr adds the genomes serially
+         */
+        SpeciesHandler(std::vector<Genome<dType, T2>*>& genome, SpeciesConfig<dType> speciesConfig, ThreadPool* threadPool = nullptr);
+        /**
+         * @brief Construct a new Species Handler object without species, genomes are added with speciate
+         *
+         * @param speciesConfig species config
+         */
+        SpeciesHandler(SpeciesConfig<dType> speciesConfig);
         ~SpeciesHandler();
+        /**
+         * @brief Sort a generation of genomes into the species
+         *
+         * Species are kept between generations, each keeps its representative from the last generation. Genomes are
+         * compared against the species of their parent first. Species left without genomes are removed, the others
+         * update their age, best fitness and stagnation, and species stagnant for stagnationLimit generations are
+         * removed, except the species with the best fitness.
+         *
+         * @param genomes genomes of the generation, fitness has to be set
+         * @param threadPool worker pool for parallel speciation, nullptr adds the genomes serially
+         */
+        void speciate(std::vector<Genome<dType, T2>*>& genomes, ThreadPool* threadPool = nullptr);
+        /**
+         * @brief Remove all genomes from the species, the species and their representatives are kept
+         *
+         */
+        void clearGenomes();
         /**
          * @brief Add genome(s) to species
          *
@@ -41,17 +73,33 @@ namespace NEAT {
          */
         void addGenome(Genome<dType, T2>* genome);
         void addGenome(std::vector<Genome<dType, T2>*>& genomes);
+        /**
+         * @brief Add genomes to species, computing the distances to the representatives on a worker pool
+         *
+         * Distances of a block of genomes to the representatives are computed in parallel, then the genomes are placed
+         * in order. Distances to species created since the block started are computed on the calling thread, so the
+         * species are the same as adding the genomes one by one.
+         *
+         * @param genomes genomes to add
+         * @param threadPool worker pool
+         */
+        void addGenome(std::vector<Genome<dType, T2>*>& genomes, ThreadPool& threadPool);
 
         /**
          * @brief Get next generation of genomes
          *
-         * @param c1 excess coefficient of distance formula
-         * @param c2 disjoint coefficient of distance formula
-         * @param c3 weight coefficient of distance formula
+         * Crossover and parameter mutation run in parallel, structural mutation runs in offspring order.
+         * Every offspring draws from random streams keyed by (seed, generation, offspring index),
+         * so the next generation is the same for any number of threads.
+         *
          * @param n number of genomes to reproduce
+         * @param mutationConfig mutation config
+         * @param geneHistory innovation registry of the population
+         * @param generation generation number, part of the random stream key
+         * @param threadPool worker pool, nullptr reproduces serially
          * @return std::vector<Genome<dType, T2>*> next generation of genomes
          */
-        std::vector<Genome<dType, T2>*> reproduce(T2 n, const MutationConfig<dType>& mutationConfig) const;
+        std::vector<Genome<dType, T2>*> reproduce(T2 n, const MutationConfig<dType>& mutationConfig, GeneHistory<dType, T2>& geneHistory, T2 generation = 0, ThreadPool* threadPool = nullptr) const;
         // std::vector<Genome<dType, T2>*> reproduce(T2 n) const;
 
         /**
@@ -60,9 +108,28 @@ namespace NEAT {
          * @return dType average fitness
          */
         dType getAverageFitnessSum() const;
+        const std::vector<Species<dType, T2>*>& getSpecies() const;
+        void setSpeciesConfig(SpeciesConfig<dType> speciesConfig);
         void print(int tabSize) const;
 
     private:
+        /**
+         * @brief Place a genome into the closest species, or a new species if the closest is beyond the threshold
+         *
+         * @param genome genome to place
+         * @param closest closest species, nullptr if there is none
+         * @param distance distance to the closest species
+         * @return Species<dType, T2>* species of the genome
+         */
+        Species<dType, T2>* placeGenome(Genome<dType, T2>* genome, Species<dType, T2>* closest, dType distance);
+        /**
+         * @brief Find a species by id
+         *
+         * @param id species id
+         * @return Species<dType, T2>* species, nullptr if there is no species with the id
+         */
+        Species<dType, T2>* findSpecies(T2 id) const;
+
         // 
         // ------------- SpeciesHandler ------------------
         // 
@@ -71,6 +138,16 @@ namespace NEAT {
          *
          */
         std::vector<Species<dType, T2>*> species;
+        /**
+         * @brief Species by id
+         *
+         */
+        std::unordered_map<T2, Species<dType, T2>*> speciesById;
+        /**
+         * @brief Id of the next new species
+         *
+         */
+        T2 nextSpeciesId = 0;
         /**
          * @brief excess coefficients of distance formula
          *
@@ -91,6 +168,11 @@ namespace NEAT {
          *
          */
         dType threshold;
+        /**
+         * @brief generations without improvement before a species is removed, 0 never removes species
+         *
+         */
+        unsigned int stagnationLimit = 15;
         // prevent copying
         SpeciesHandler(const SpeciesHandler<dType, T2>& speciesHandler) = delete;
         SpeciesHandler<dType, T2>& operator=(const SpeciesHandler<dType, T2>& speciesHandler) = delete;
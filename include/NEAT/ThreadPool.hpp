@@ -0,0 +1,82 @@
+#ifndef __NEAT_THREAD_POOL_HPP__
+#define __NEAT_THREAD_POOL_HPP__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstdint>
+
+namespace NEAT {
+
+    /**
+     * @brief Persistent pool of worker threads for data parallel loops
+     *
+     */
+    class ThreadPool final {
+    public:
+        /**
+         * @brief Construct a new Thread Pool object
+         *
+         * @param numThreads number of threads taking part in a loop including the calling thread, 0 uses the hardware concurrency
+         */
+        ThreadPool(unsigned int numThreads = 0);
+        ~ThreadPool();
+
+        /**
+         * @brief Get the number of threads taking part in a loop, including the calling thread
+         *
+         * @return unsigned int number of threads
+         */
+        unsigned int getNumThreads() const;
+
+        /**
+         * @brief Run task(index, thread) for every index in [0, n) and block until all are done
+         *
+         * The calling thread takes part as thread 0, workers are numbered 1 to getNumThreads() - 1.
+         * Nested calls from inside a task run serially on the calling thread.
+         * The first exception thrown by a task stops the loop and is rethrown to the caller.
+         *
+         * @param n number of iterations
+         * @param task function called with the iteration index and the thread number
+         */
+        void parallelFor(std::size_t n, const std::function<void(std::size_t, unsigned int)>& task);
+
+        /**
+         * @brief Resolve a requested thread count, 0 is the hardware concurrency
+         *
+         * @param numThreads requested number of threads
+         * @return unsigned int number of threads, at least 1
+         */
+        static unsigned int resolveNumThreads(unsigned int numThreads);
+
+    private:
+        void workerLoop(unsigned int thread);
+        void runTasks(unsigned int thread);
+
+        unsigned int numThreads;
+        std::vector<std::thread> workers;
+        // serialise loops started from different threads
+        std::mutex runMutex;
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+        // current loop, guarded by mutex
+        const std::function<void(std::size_t, unsigned int)>* task = nullptr;
+        std::size_t taskCount = 0;
+        std::size_t chunkSize = 1;
+        std::uint64_t jobId = 0;
+        unsigned int pendingWorkers = 0;
+        bool stopping = false;
+        std::exception_ptr exception;
+        std::atomic<std::size_t> nextIndex { 0 };
+        // prevent copy and assignment
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+    };
+}
+
+#endif // __NEAT_THREAD_POOL_HPP__
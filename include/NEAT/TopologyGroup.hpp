@@ -0,0 +1,75 @@
+#ifndef __NEAT_TOPOLOGY_GROUP_HPP__
+#define __NEAT_TOPOLOGY_GROUP_HPP__
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "./ExecutionPlan.hpp"
+
+namespace NEAT {
+
+    /**
+     * @brief Execution plans of equal structure evaluated together, one lane per plan
+     *
+     * The plans share slots, activation functions and incoming edges and only differ in weights and biases. Their
+     * weights and biases are stacked lane-major, so every edge of the shared structure is one multiply-add over all
+     * lanes and every activation is applied to all lanes at once, vectorized by SimdKernels.
+     *
+     * @tparam dType type of data
+     * @tparam T2 type of innovation number
+     */
+    template <typename dType = double, typename T2 = int>
+    class TopologyGroup final {
+    public:
+        /**
+         * @brief Stack the weights and biases of plans of equal structure
+         *
+         * @param plans plans to group, at least one, all with the structure of the first
+         */
+        TopologyGroup(const std::vector<std::shared_ptr<const ExecutionPlan<dType, T2>>>& plans);
+
+        /**
+         * @brief Evaluate every lane for its own input vector
+         *
+         * @param inputs row-major input block, lane i reads row rows[i]
+         * @param outputs row-major output block, lane i writes row rows[i]
+         * @param rows row of each lane
+         * @param workspace buffers of the evaluation
+         */
+        void evaluate(const dType* inputs, dType* outputs, const std::size_t* rows, ActivationWorkspace<dType>& workspace) const;
+        /**
+         * @brief Evaluate every lane for the same batch of input rows
+         *
+         * @param inputs row-major input block of rows x inputSize values
+         * @param rows number of rows in the batch
+         * @param outputs lane-major block of lanes x rows x outputSize values to write
+         * @param workspace buffers of the evaluation
+         */
+        void evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace) const;
+
+        std::size_t getLaneCount() const;
+        /**
+         * @brief Get the plan of the first lane, its structure is shared by all lanes
+         *
+         * @return const ExecutionPlan<dType, T2>& plan of the first lane
+         */
+        const ExecutionPlan<dType, T2>& getStructure() const;
+
+    private:
+        std::shared_ptr<const ExecutionPlan<dType, T2>> structure;
+        std::size_t lanes;
+        /**
+         * @brief bias of each slot and lane, slot-major
+         *
+         */
+        std::vector<dType> biases;
+        /**
+         * @brief weight of each edge and lane, edge-major in the edge order of the structure
+         *
+         */
+        std::vector<dType> weights;
+    };
+}
+
+#endif // __NEAT_TOPOLOGY_GROUP_HPP__
@@ -9,6 +9,16 @@ namespace NEAT {
         dType c2 = 1;
         dType c3 = 0.4;
         dType threshold = 3;
+        /**
+         * @brief number of threads used for speciation and reproduction, 0 uses the hardware concurrency, 1 is serial
+         *
+         */
+        unsigned int numThreads = 1;
+        /**
+         * @brief generations without improvement of the best fitness before a species is removed, 0 never removes species
+         *
+         */
+        unsigned int stagnationLimit = 15;
     };
 
     template <typename dType>
@@ -19,6 +29,11 @@ namespace NEAT {
         dType mutateWeightProbability = 0.8;
         dType mutateActivationFunctionProbability = 0.1;
         dType mutateBiasProbability = 0.1;
+        /**
+         * @brief generations an unused innovation is remembered, so the same structure gets the same innovation number
+         *
+         */
+        unsigned int innovationMaxAge = 1;
     };
 
 }
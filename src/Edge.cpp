@@ -42,6 +42,11 @@ namespace NEAT {
         this->disabled = !this->disabled;
     }
 
+    template <typename dType, typename T2>
+    bool Edge<dType, T2>::isDisabled() const {
+        return this->disabled;
+    }
+
     template <typename dType, typename T2>
     const dType& Edge<dType, T2>::getWeight() const {
         return this->weight;
@@ -76,8 +81,28 @@ namespace NEAT {
         return this->INNOVATION_NUMBER;
     }
 
+    template <typename dType, typename T2>
+    void Edge<dType, T2>::bind(const Genome<dType, T2>* owner, std::uint32_t fromIndex, std::uint32_t toIndex) {
+        this->owner = owner;
+        this->fromIndex = fromIndex;
+        this->toIndex = toIndex;
+    }
+
+    template <typename dType, typename T2>
+    const std::uint32_t& Edge<dType, T2>::getFromIndex() const {
+        return this->fromIndex;
+    }
+
+    template <typename dType, typename T2>
+    const std::uint32_t& Edge<dType, T2>::getToIndex() const {
+        return this->toIndex;
+    }
+
     template <typename dType, typename T2>
     Node<dType, T2>* Edge<dType, T2>::getFrom(const Genome<dType, T2>* genome) const {
+        if (genome != nullptr && genome == this->owner && this->fromIndex != NO_INDEX) {
+            return genome->getNodeByIndex(this->fromIndex);
+        }
         if (this->state == EdgeState::ID_ENABLED || genome != nullptr) {
             if (genome == nullptr) {
                 std::cout << "Genome is nullptr" << std::endl;
@@ -90,6 +115,9 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     Node<dType, T2>* Edge<dType, T2>::getTo(const Genome<dType, T2>* genome) const {
+        if (genome != nullptr && genome == this->owner && this->toIndex != NO_INDEX) {
+            return genome->getNodeByIndex(this->toIndex);
+        }
         if (this->state == EdgeState::ID_ENABLED || genome != nullptr) {
             if (genome == nullptr) {
                 std::cout << "Genome is nullptr" << std::endl;
@@ -100,6 +128,16 @@ namespace NEAT {
         return this->to;
     }
 
+    template <typename dType, typename T2>
+    const T2& Edge<dType, T2>::getFromId() const {
+        return this->from_id;
+    }
+
+    template <typename dType, typename T2>
+    const T2& Edge<dType, T2>::getToId() const {
+        return this->to_id;
+    }
+
     template <typename dType, typename T2>
     Edge<dType, T2>* Edge<dType, T2>::clone() const {
         return new Edge<dType, T2>(this->from_id, this->to_id, this->weight, INNOVATION_NUMBER, this->disabled);
@@ -114,4 +152,6 @@ namespace NEAT {
     // Explicitly instantiate
     template class Edge<double, int>;
     template class Edge<double, long>;
+    template class Edge<float, int>;
+    template class Edge<float, long>;
 }
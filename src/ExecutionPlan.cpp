@@ -0,0 +1,275 @@
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "../include/NEAT/ExecutionPlan.hpp"
+#include "../include/NEAT/SimdKernels.hpp"
+#include "../include/NEAT/Genome.hpp"
+#include "../include/NEAT/FlatGenome.hpp"
+#include "../include/NEAT/Node.hpp"
+#include "../include/NEAT/Edge.hpp"
+
+namespace NEAT {
+
+    template <typename dType, typename T2>
+    ExecutionPlan<dType, T2>::ExecutionPlan(const Genome<dType, T2>& genome) : ExecutionPlan(genome.getFlatGenome()) {}
+
+    template <typename dType, typename T2>
+    ExecutionPlan<dType, T2>::ExecutionPlan(const FlatGenome<dType, T2>& genome) :
+        inputSize(genome.getInputSize()), outputSize(genome.getOutputSize()) {
+        const std::uint32_t nodeCount = genome.getNodeCount();
+        const std::uint32_t edgeCount = genome.getEdgeCount();
+        const std::uint32_t UNSET = static_cast<std::uint32_t>(-1);
+        const std::vector<int>& layers = genome.getNodeLayers();
+        const std::vector<std::uint32_t>& nodeOrder = genome.getNodeOrder();
+        // 1. rank nodes by the topological order of the genome if known, else by layer, flat order breaks ties by id
+        std::vector<std::uint32_t> ranked(nodeCount);
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            ranked[i] = i;
+        }
+        if (nodeOrder.size() == nodeCount) {
+            for (std::uint32_t i = 0; i < nodeCount; i++) {
+                ranked[nodeOrder[i]] = i;
+            }
+        } else {
+            std::stable_sort(ranked.begin(), ranked.end(), [&layers](std::uint32_t a, std::uint32_t b) {
+                return layers[a] < layers[b];
+                });
+        }
+        std::vector<std::uint32_t> rankOf(nodeCount, UNSET);
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            rankOf[ranked[i]] = i;
+        }
+        // 2. collect enabled edges in innovation order, as (from rank, to rank)
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> enabledEdges;
+        std::vector<dType> enabledWeights;
+        std::vector<std::vector<std::uint32_t>> successors(nodeCount);
+        std::vector<std::uint32_t> inDegree(nodeCount, 0);
+        const std::vector<std::uint32_t>& edgeFrom = genome.getEdgeFrom();
+        const std::vector<std::uint32_t>& edgeTo = genome.getEdgeTo();
+        for (std::uint32_t i = 0; i < edgeCount; i++) {
+            if (!genome.isEnabled(i)) continue;
+            if (edgeFrom[i] >= nodeCount || edgeTo[i] >= nodeCount) continue;
+            const std::uint32_t from = rankOf[edgeFrom[i]];
+            const std::uint32_t to = rankOf[edgeTo[i]];
+            if (from == to) continue;
+            enabledEdges.push_back({ from, to });
+            enabledWeights.push_back(genome.getEdgeWeights()[i]);
+            successors[from].push_back(to);
+            inDegree[to]++;
+        }
+        // 3. topological order, lowest rank first among the ready nodes
+        std::vector<std::uint32_t> slotOfRank(nodeCount, UNSET);
+        std::vector<std::uint32_t> order;
+        order.reserve(nodeCount);
+        std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, std::greater<std::uint32_t>> ready;
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            if (inDegree[i] == 0) ready.push(i);
+        }
+        while (!ready.empty()) {
+            const std::uint32_t rank = ready.top();
+            ready.pop();
+            slotOfRank[rank] = static_cast<std::uint32_t>(order.size());
+            order.push_back(rank);
+            for (std::uint32_t next : successors[rank]) {
+                if (--inDegree[next] == 0) ready.push(next);
+            }
+        }
+        // nodes on a cycle are appended in rank order, the edges closing the cycle are dropped in step 5
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            if (slotOfRank[i] != UNSET) continue;
+            slotOfRank[i] = static_cast<std::uint32_t>(order.size());
+            order.push_back(i);
+        }
+        // 4. fill slots
+        nodeIds.reserve(nodeCount);
+        biases.reserve(nodeCount);
+        activations.reserve(nodeCount);
+        for (std::uint32_t rank : order) {
+            const std::uint32_t node = ranked[rank];
+            nodeIds.push_back(genome.getNodeIds()[node]);
+            biases.push_back(genome.getNodeBiases()[node]);
+            activations.push_back(genome.getNodeActivations()[node]);
+        }
+        // 5. incoming edges of each slot in CSR form, innovation order is kept within a slot
+        edgeOffsets.assign(nodeCount + 1, 0);
+        for (const std::pair<std::uint32_t, std::uint32_t>& edge : enabledEdges) {
+            const std::uint32_t from = slotOfRank[edge.first];
+            const std::uint32_t to = slotOfRank[edge.second];
+            if (from < to) edgeOffsets[to + 1]++;
+        }
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            edgeOffsets[i + 1] += edgeOffsets[i];
+        }
+        edgeSources.resize(edgeOffsets[nodeCount]);
+        edgeWeights.resize(edgeOffsets[nodeCount]);
+        std::vector<std::uint32_t> cursor(edgeOffsets.begin(), edgeOffsets.end() - 1);
+        for (std::size_t i = 0; i < enabledEdges.size(); i++) {
+            const std::uint32_t from = slotOfRank[enabledEdges[i].first];
+            const std::uint32_t to = slotOfRank[enabledEdges[i].second];
+            if (from >= to) continue;
+            edgeSources[cursor[to]] = from;
+            edgeWeights[cursor[to]] = enabledWeights[i];
+            cursor[to]++;
+        }
+        // 6. input and output slots
+        inputSlots.reserve(inputSize);
+        for (T2 i = 0; i < inputSize; i++) {
+            const std::uint32_t node = genome.findNode(i);
+            if (node == FlatGenome<dType, T2>::NOT_FOUND) {
+                throw std::invalid_argument("ExecutionPlan<dType, T2>::ExecutionPlan(const FlatGenome<dType, T2>&) - input node missing");
+            }
+            inputSlots.push_back(slotOfRank[rankOf[node]]);
+        }
+        outputSlots.reserve(outputSize);
+        for (T2 i = inputSize; i < inputSize + outputSize; i++) {
+            const std::uint32_t node = genome.findNode(i);
+            if (node == FlatGenome<dType, T2>::NOT_FOUND) {
+                throw std::invalid_argument("ExecutionPlan<dType, T2>::ExecutionPlan(const FlatGenome<dType, T2>&) - output node missing");
+            }
+            outputSlots.push_back(slotOfRank[rankOf[node]]);
+        }
+        // 7. structure hash, for grouping plans that only differ in weights and biases
+        const auto combine = [this](std::size_t value) {
+            structureHash ^= value + 0x9E3779B97F4A7C15ULL + (structureHash << 6) + (structureHash >> 2);
+            };
+        combine(static_cast<std::size_t>(inputSize));
+        combine(static_cast<std::size_t>(outputSize));
+        combine(nodeCount);
+        for (ActivationType activation : activations) combine(static_cast<std::size_t>(activation));
+        for (std::uint32_t offset : edgeOffsets) combine(offset);
+        for (std::uint32_t source : edgeSources) combine(source);
+        for (std::uint32_t slot : inputSlots) combine(slot);
+        for (std::uint32_t slot : outputSlots) combine(slot);
+    }
+
+    template <typename dType, typename T2>
+    void ExecutionPlan<dType, T2>::evaluate(const dType* inputs, dType* outputs, ActivationWorkspace<dType>& workspace) const {
+        std::vector<dType>& values = workspace.values;
+        const std::uint32_t nodeCount = getNodeCount();
+        values.assign(nodeCount, 0);
+        for (T2 i = 0; i < inputSize; i++) {
+            values[inputSlots[i]] = inputs[i];
+        }
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            dType sum = values[slot] + biases[slot];
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                sum += edgeWeights[e] * values[edgeSources[e]];
+            }
+            values[slot] = applyActivation(activations[slot], sum);
+        }
+        for (T2 i = 0; i < outputSize; i++) {
+            outputs[i] = values[outputSlots[i]];
+        }
+    }
+
+    template <typename dType, typename T2>
+    void ExecutionPlan<dType, T2>::evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace) const {
+        std::vector<dType>& values = workspace.values;
+        const std::uint32_t nodeCount = getNodeCount();
+        values.assign(static_cast<std::size_t>(nodeCount) * rows, 0);
+        // transpose the input rows into node-major order
+        for (T2 i = 0; i < inputSize; i++) {
+            dType* target = values.data() + static_cast<std::size_t>(inputSlots[i]) * rows;
+            for (std::size_t r = 0; r < rows; r++) {
+                target[r] = inputs[r * inputSize + i];
+            }
+        }
+        std::vector<const dType*>& sources = workspace.sources;
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            dType* target = values.data() + static_cast<std::size_t>(slot) * rows;
+            sources.clear();
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                sources.push_back(values.data() + static_cast<std::size_t>(edgeSources[e]) * rows);
+            }
+            SimdKernels::weightedSum(target, rows, biases[slot], sources.data(), edgeWeights.data() + edgeOffsets[slot], sources.size());
+            SimdKernels::activate(activations[slot], target, rows);
+        }
+        for (T2 i = 0; i < outputSize; i++) {
+            const dType* source = values.data() + static_cast<std::size_t>(outputSlots[i]) * rows;
+            for (std::size_t r = 0; r < rows; r++) {
+                outputs[r * outputSize + i] = source[r];
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    const T2& ExecutionPlan<dType, T2>::getInputSize() const {
+        return inputSize;
+    }
+
+    template <typename dType, typename T2>
+    const T2& ExecutionPlan<dType, T2>::getOutputSize() const {
+        return outputSize;
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t ExecutionPlan<dType, T2>::getNodeCount() const {
+        return static_cast<std::uint32_t>(nodeIds.size());
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t ExecutionPlan<dType, T2>::getEdgeCount() const {
+        return static_cast<std::uint32_t>(edgeSources.size());
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<T2>& ExecutionPlan<dType, T2>::getNodeIds() const {
+        return nodeIds;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<dType>& ExecutionPlan<dType, T2>::getBiases() const {
+        return biases;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<ActivationType>& ExecutionPlan<dType, T2>::getActivations() const {
+        return activations;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& ExecutionPlan<dType, T2>::getEdgeOffsets() const {
+        return edgeOffsets;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& ExecutionPlan<dType, T2>::getEdgeSources() const {
+        return edgeSources;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<dType>& ExecutionPlan<dType, T2>::getEdgeWeights() const {
+        return edgeWeights;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& ExecutionPlan<dType, T2>::getInputSlots() const {
+        return inputSlots;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& ExecutionPlan<dType, T2>::getOutputSlots() const {
+        return outputSlots;
+    }
+
+    template <typename dType, typename T2>
+    std::size_t ExecutionPlan<dType, T2>::getStructureHash() const {
+        return structureHash;
+    }
+
+    template <typename dType, typename T2>
+    bool ExecutionPlan<dType, T2>::hasSameStructure(const ExecutionPlan<dType, T2>& other) const {
+        return structureHash == other.structureHash && inputSize == other.inputSize && outputSize == other.outputSize
+            && activations == other.activations && edgeOffsets == other.edgeOffsets && edgeSources == other.edgeSources
+            && inputSlots == other.inputSlots && outputSlots == other.outputSlots;
+    }
+
+    // Explicit instantiation
+    template class ExecutionPlan<double, int>;
+    template class ExecutionPlan<double, long>;
+    template class ExecutionPlan<float, int>;
+    template class ExecutionPlan<float, long>;
+}
@@ -0,0 +1,402 @@
+#include <map>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "../include/NEAT/FlatGenome.hpp"
+#include "../include/NEAT/Genome.hpp"
+#include "../include/NEAT/Node.hpp"
+#include "../include/NEAT/Edge.hpp"
+
+namespace NEAT {
+
+    template <typename dType, typename T2>
+    FlatGenome<dType, T2>::FlatGenome(T2 inputSize, T2 outputSize) : inputSize(inputSize), outputSize(outputSize) {}
+
+    template <typename dType, typename T2>
+    FlatGenome<dType, T2>::FlatGenome(const Genome<dType, T2>& genome) :
+        inputSize(genome.getInputSize()), outputSize(genome.getOutputSize()) {
+        const std::map<T2, Node<dType, T2>*>& nodes = genome.getNodes();
+        const std::map<T2, Edge<dType, T2>*>& edges = genome.getEdges();
+        nodeIds.reserve(nodes.size());
+        nodeTypes.reserve(nodes.size());
+        nodeLayers.reserve(nodes.size());
+        nodeBiases.reserve(nodes.size());
+        nodeActivations.reserve(nodes.size());
+        // flat index of every node by its genome-local index
+        std::vector<std::uint32_t> flatIndexOf(nodes.size(), NOT_FOUND);
+        for (const std::pair<const T2, Node<dType, T2>*>& pair : nodes) {
+            const Node<dType, T2>* node = pair.second;
+            const std::uint32_t flatIndex = addNode(node->getId(), node->getType(), node->getLayer(), node->getBias(), node->getActivationType());
+            if (node->getIndex() < flatIndexOf.size()) flatIndexOf[node->getIndex()] = flatIndex;
+        }
+        innovations.reserve(edges.size());
+        edgeFrom.reserve(edges.size());
+        edgeTo.reserve(edges.size());
+        edgeWeights.reserve(edges.size());
+        for (const std::pair<const T2, Edge<dType, T2>*>& pair : edges) {
+            const Edge<dType, T2>* edge = pair.second;
+            const std::uint32_t from = (edge->getFromIndex() < flatIndexOf.size()) ? flatIndexOf[edge->getFromIndex()] : findNode(edge->getFromId());
+            const std::uint32_t to = (edge->getToIndex() < flatIndexOf.size()) ? flatIndexOf[edge->getToIndex()] : findNode(edge->getToId());
+            addEdge(edge->getInnovationNumber(), from, to, edge->getWeight(), !edge->isDisabled());
+        }
+        // keep the topological order of the genome, so genomes built from this one do not rebuild it
+        if (genome.topologicalOrderValid) {
+            nodeOrder.assign(nodeIds.size(), 0);
+            for (std::uint32_t i = 0; i < flatIndexOf.size(); i++) {
+                if (flatIndexOf[i] != NOT_FOUND) nodeOrder[flatIndexOf[i]] = genome.topologicalPosition[i];
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t FlatGenome<dType, T2>::addNode(T2 id, NodeType type, int layer, dType bias, ActivationType activation) {
+        nodeIds.push_back(id);
+        nodeTypes.push_back(type);
+        nodeLayers.push_back(layer);
+        nodeBiases.push_back(bias);
+        nodeActivations.push_back(activation);
+        return static_cast<std::uint32_t>(nodeIds.size() - 1);
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::addEdge(T2 innovation, std::uint32_t from, std::uint32_t to, dType weight, bool enabled) {
+        const std::size_t index = innovations.size();
+        innovations.push_back(innovation);
+        edgeFrom.push_back(from);
+        edgeTo.push_back(to);
+        edgeWeights.push_back(weight);
+        if (index % 64 == 0) enabledBits.push_back(0);
+        if (enabled) enabledBits[index / 64] |= std::uint64_t(1) << (index % 64);
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t FlatGenome<dType, T2>::insertNode(T2 id, NodeType type, int layer, dType bias, ActivationType activation, std::uint32_t before) {
+        const std::uint32_t index = static_cast<std::uint32_t>(std::lower_bound(nodeIds.begin(), nodeIds.end(), id) - nodeIds.begin());
+        if (index < nodeIds.size() && nodeIds[index] == id) return NOT_FOUND;
+        if (nodeOrder.empty()) buildNodeOrder();
+        nodeIds.insert(nodeIds.begin() + index, id);
+        nodeTypes.insert(nodeTypes.begin() + index, type);
+        nodeLayers.insert(nodeLayers.begin() + index, layer);
+        nodeBiases.insert(nodeBiases.begin() + index, bias);
+        nodeActivations.insert(nodeActivations.begin() + index, activation);
+        for (std::uint32_t& from : edgeFrom) {
+            if (from >= index) from++;
+        }
+        for (std::uint32_t& to : edgeTo) {
+            if (to >= index) to++;
+        }
+        // the new node takes the position of the node before which it goes, later nodes move back by one
+        const std::uint32_t position = nodeOrder[before];
+        for (std::uint32_t& other : nodeOrder) {
+            if (other >= position) other++;
+        }
+        nodeOrder.insert(nodeOrder.begin() + index, position);
+        return index;
+    }
+
+    template <typename dType, typename T2>
+    bool FlatGenome<dType, T2>::insertEdge(T2 innovation, std::uint32_t from, std::uint32_t to, dType weight, bool enabled) {
+        const std::size_t index = std::lower_bound(innovations.begin(), innovations.end(), innovation) - innovations.begin();
+        if (index < innovations.size() && innovations[index] == innovation) return false;
+        innovations.insert(innovations.begin() + index, innovation);
+        edgeFrom.insert(edgeFrom.begin() + index, from);
+        edgeTo.insert(edgeTo.begin() + index, to);
+        edgeWeights.insert(edgeWeights.begin() + index, weight);
+        // move the enabled flags from the index on back by one
+        if (innovations.size() > enabledBits.size() * 64) enabledBits.push_back(0);
+        const std::size_t word = index / 64;
+        const std::uint64_t lowMask = (std::uint64_t(1) << (index % 64)) - 1;
+        for (std::size_t w = enabledBits.size() - 1; w > word; w--) {
+            enabledBits[w] = (enabledBits[w] << 1) | (enabledBits[w - 1] >> 63);
+        }
+        enabledBits[word] = (enabledBits[word] & lowMask) | ((enabledBits[word] & ~lowMask) << 1);
+        setEnabled(static_cast<std::uint32_t>(index), enabled);
+        return true;
+    }
+
+    template <typename dType, typename T2>
+    bool FlatGenome<dType, T2>::hasPath(std::uint32_t from, std::uint32_t to) const {
+        if (from == to) return true;
+        // with a topological order, only nodes before the last node can be on the path
+        const bool ordered = !nodeOrder.empty();
+        if (ordered && nodeOrder[from] > nodeOrder[to]) return false;
+        std::vector<std::uint32_t> offsets, neighbours;
+        buildAdjacency(true, offsets, neighbours);
+        std::vector<std::uint8_t> visited(nodeIds.size(), 0);
+        std::vector<std::uint32_t> stack(1, from);
+        visited[from] = 1;
+        while (!stack.empty()) {
+            const std::uint32_t node = stack.back();
+            stack.pop_back();
+            for (std::uint32_t i = offsets[node]; i < offsets[node + 1]; i++) {
+                const std::uint32_t next = neighbours[i];
+                if (next == to) return true;
+                if (visited[next] == 0 && (!ordered || nodeOrder[next] < nodeOrder[to])) {
+                    visited[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+        return false;
+    }
+
+    template <typename dType, typename T2>
+    bool FlatGenome<dType, T2>::orderEdge(std::uint32_t from, std::uint32_t to) {
+        if (from == to) return false;
+        if (nodeOrder.empty()) buildNodeOrder();
+        const std::uint32_t lower = nodeOrder[to];
+        const std::uint32_t upper = nodeOrder[from];
+        if (upper < lower) return true;
+        std::vector<std::uint32_t> offsets, neighbours;
+        std::vector<std::uint8_t> mark(nodeIds.size(), 0);
+        std::vector<std::uint32_t> forward, backward, stack;
+        // 1. nodes reachable from the target that are not after the source
+        buildAdjacency(true, offsets, neighbours);
+        mark[to] = 1;
+        stack.push_back(to);
+        while (!stack.empty()) {
+            const std::uint32_t node = stack.back();
+            stack.pop_back();
+            forward.push_back(node);
+            for (std::uint32_t i = offsets[node]; i < offsets[node + 1]; i++) {
+                const std::uint32_t next = neighbours[i];
+                if (next == from) return false;
+                if (mark[next] == 0 && nodeOrder[next] < upper) {
+                    mark[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+        // 2. nodes reaching the source that are not before the target
+        buildAdjacency(false, offsets, neighbours);
+        mark[from] = 1;
+        stack.push_back(from);
+        while (!stack.empty()) {
+            const std::uint32_t node = stack.back();
+            stack.pop_back();
+            backward.push_back(node);
+            for (std::uint32_t i = offsets[node]; i < offsets[node + 1]; i++) {
+                const std::uint32_t previous = neighbours[i];
+                if (mark[previous] == 0 && nodeOrder[previous] > lower) {
+                    mark[previous] = 1;
+                    stack.push_back(previous);
+                }
+            }
+        }
+        // 3. the affected nodes take over their own positions, the source side first, relative order kept
+        const auto byPosition = [this](std::uint32_t a, std::uint32_t b) {
+            return nodeOrder[a] < nodeOrder[b];
+        };
+        std::sort(forward.begin(), forward.end(), byPosition);
+        std::sort(backward.begin(), backward.end(), byPosition);
+        std::vector<std::uint32_t> positions;
+        positions.reserve(forward.size() + backward.size());
+        for (std::uint32_t node : backward) positions.push_back(nodeOrder[node]);
+        for (std::uint32_t node : forward) positions.push_back(nodeOrder[node]);
+        std::sort(positions.begin(), positions.end());
+        std::size_t i = 0;
+        for (std::uint32_t node : backward) nodeOrder[node] = positions[i++];
+        for (std::uint32_t node : forward) nodeOrder[node] = positions[i++];
+        return true;
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::setEnabled(std::uint32_t edge, bool enabled) {
+        const std::uint64_t bit = std::uint64_t(1) << (edge % 64);
+        if (enabled) enabledBits[edge / 64] |= bit;
+        else enabledBits[edge / 64] &= ~bit;
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::setEdgeWeight(std::uint32_t edge, dType weight) {
+        edgeWeights[edge] = weight;
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::setNodeBias(std::uint32_t node, dType bias) {
+        nodeBiases[node] = bias;
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::setNodeActivation(std::uint32_t node, ActivationType activation) {
+        nodeActivations[node] = activation;
+    }
+
+    template <typename dType, typename T2>
+    Genome<dType, T2>* FlatGenome<dType, T2>::toGenome() const {
+        return new Genome<dType, T2>(std::make_shared<FlatGenome<dType, T2>>(*this));
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::fillGenome(Genome<dType, T2>& genome) const {
+        std::vector<Node<dType, T2>*> nodes;
+        nodes.reserve(nodeIds.size());
+        for (std::size_t i = 0; i < nodeIds.size(); i++) {
+            Node<dType, T2>* node = new Node<dType, T2>(nodeIds[i], nodeTypes[i], nodeLayers[i], nodeBiases[i], nodeActivations[i]);
+            genome.addNode(node);
+            nodes.push_back(node);
+        }
+        for (std::size_t i = 0; i < innovations.size(); i++) {
+            Node<dType, T2>* from = nodes[edgeFrom[i]];
+            Node<dType, T2>* to = nodes[edgeTo[i]];
+            Edge<dType, T2>* edge = new Edge<dType, T2>(from, to, edgeWeights[i], innovations[i], !isEnabled(static_cast<std::uint32_t>(i)));
+            genome.addEdge(edge);
+            from->addOutgoingEdge(edge);
+            to->addIncomingEdge(edge);
+        }
+        // node indices of the genome are the flat indices
+        if (!nodeOrder.empty()) {
+            genome.topologicalPosition = nodeOrder;
+            genome.topologicalOrder.assign(nodeOrder.size(), 0);
+            for (std::uint32_t i = 0; i < nodeOrder.size(); i++) {
+                genome.topologicalOrder[nodeOrder[i]] = i;
+            }
+            genome.topologicalMark.assign(nodeOrder.size(), 0);
+            genome.topologicalOrderValid = true;
+        }
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::buildNodeOrder() {
+        const std::uint32_t nodeCount = getNodeCount();
+        std::vector<std::uint32_t> offsets, neighbours;
+        buildAdjacency(true, offsets, neighbours);
+        std::vector<std::uint32_t> inDegree(nodeCount, 0);
+        for (std::uint32_t to : edgeTo) inDegree[to]++;
+        std::vector<std::uint32_t> order;
+        order.reserve(nodeCount);
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            if (inDegree[i] == 0) order.push_back(i);
+        }
+        for (std::size_t head = 0; head < order.size(); head++) {
+            for (std::uint32_t i = offsets[order[head]]; i < offsets[order[head] + 1]; i++) {
+                if (--inDegree[neighbours[i]] == 0) order.push_back(neighbours[i]);
+            }
+        }
+        // nodes on a cycle, only possible with edges added outside the structural mutations, keep their index order
+        for (std::uint32_t i = 0; i < nodeCount && order.size() < nodeCount; i++) {
+            if (inDegree[i] != 0) order.push_back(i);
+        }
+        nodeOrder.assign(nodeCount, 0);
+        for (std::uint32_t position = 0; position < nodeCount; position++) {
+            nodeOrder[order[position]] = position;
+        }
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::buildAdjacency(bool outgoing, std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& neighbours) const {
+        const std::vector<std::uint32_t>& keys = outgoing ? edgeFrom : edgeTo;
+        const std::vector<std::uint32_t>& values = outgoing ? edgeTo : edgeFrom;
+        offsets.assign(nodeIds.size() + 1, 0);
+        for (std::uint32_t key : keys) offsets[key + 1]++;
+        for (std::size_t i = 1; i < offsets.size(); i++) offsets[i] += offsets[i - 1];
+        neighbours.resize(keys.size());
+        std::vector<std::uint32_t> next(offsets.begin(), offsets.end() - 1);
+        for (std::size_t e = 0; e < keys.size(); e++) {
+            neighbours[next[keys[e]]++] = values[e];
+        }
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t FlatGenome<dType, T2>::findNode(T2 id) const {
+        typename std::vector<T2>::const_iterator it = std::lower_bound(nodeIds.begin(), nodeIds.end(), id);
+        if (it == nodeIds.end() || *it != id) return NOT_FOUND;
+        return static_cast<std::uint32_t>(it - nodeIds.begin());
+    }
+
+    template <typename dType, typename T2>
+    const T2& FlatGenome<dType, T2>::getInputSize() const {
+        return inputSize;
+    }
+
+    template <typename dType, typename T2>
+    const T2& FlatGenome<dType, T2>::getOutputSize() const {
+        return outputSize;
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t FlatGenome<dType, T2>::getNodeCount() const {
+        return static_cast<std::uint32_t>(nodeIds.size());
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t FlatGenome<dType, T2>::getEdgeCount() const {
+        return static_cast<std::uint32_t>(innovations.size());
+    }
+
+    template <typename dType, typename T2>
+    bool FlatGenome<dType, T2>::isEnabled(std::uint32_t edge) const {
+        return (enabledBits[edge / 64] >> (edge % 64)) & 1;
+    }
+
+    template <typename dType, typename T2>
+    dType FlatGenome<dType, T2>::getWeightSum() const {
+        dType sum = 0;
+        for (const dType& weight : edgeWeights) {
+            sum += weight;
+        }
+        return sum;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<T2>& FlatGenome<dType, T2>::getNodeIds() const {
+        return nodeIds;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<NodeType>& FlatGenome<dType, T2>::getNodeTypes() const {
+        return nodeTypes;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<int>& FlatGenome<dType, T2>::getNodeLayers() const {
+        return nodeLayers;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<dType>& FlatGenome<dType, T2>::getNodeBiases() const {
+        return nodeBiases;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<ActivationType>& FlatGenome<dType, T2>::getNodeActivations() const {
+        return nodeActivations;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<T2>& FlatGenome<dType, T2>::getInnovations() const {
+        return innovations;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& FlatGenome<dType, T2>::getEdgeFrom() const {
+        return edgeFrom;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& FlatGenome<dType, T2>::getEdgeTo() const {
+        return edgeTo;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<dType>& FlatGenome<dType, T2>::getEdgeWeights() const {
+        return edgeWeights;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& FlatGenome<dType, T2>::getNodeOrder() const {
+        return nodeOrder;
+    }
+
+    template <typename dType, typename T2>
+    void FlatGenome<dType, T2>::setNodeOrder(std::vector<std::uint32_t> nodeOrder) {
+        this->nodeOrder = std::move(nodeOrder);
+    }
+
+    // Explicit instantiation
+    template class FlatGenome<double, int>;
+    template class FlatGenome<double, long>;
+    template class FlatGenome<float, int>;
+    template class FlatGenome<float, long>;
+}
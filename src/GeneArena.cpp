@@ -0,0 +1,119 @@
+#include <new>
+#include <cstdlib>
+
+#include "../include/NEAT/GeneArena.hpp"
+
+namespace NEAT {
+
+    namespace {
+        // every block starts with a header holding its arena, nullptr for heap blocks
+        struct alignas(std::max_align_t) BlockHeader {
+            GeneArena* arena;
+        };
+
+        std::size_t alignSize(std::size_t size) {
+            const std::size_t alignment = alignof(std::max_align_t);
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        // unused part of the chunk the calling thread allocates from, valid while arenaId is the id of a live arena
+        struct ThreadChunk {
+            std::uint64_t arenaId = 0;
+            char* next = nullptr;
+            char* end = nullptr;
+        };
+
+        thread_local ThreadChunk threadChunk;
+        std::atomic<std::uint64_t> nextArenaId { 1 };
+    }
+
+    thread_local GeneArena* GeneArena::active = nullptr;
+
+    GeneArena::GeneArena(std::size_t chunkSize) : chunkSize(alignSize(chunkSize)), id(nextArenaId.fetch_add(1, std::memory_order_relaxed)) {}
+
+    GeneArena::~GeneArena() {
+        for (char* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    void GeneArena::release() {
+        dropReference();
+    }
+
+    void* GeneArena::allocate(std::size_t size) {
+        const std::size_t blockSize = sizeof(BlockHeader) + alignSize(size);
+        GeneArena* arena = active;
+        BlockHeader* header;
+        if (arena == nullptr) {
+            header = static_cast<BlockHeader*>(::operator new(blockSize));
+        } else {
+            header = static_cast<BlockHeader*>(arena->allocateBlock(blockSize));
+            arena->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        header->arena = arena;
+        return header + 1;
+    }
+
+    void GeneArena::deallocate(void* pointer) noexcept {
+        if (pointer == nullptr) return;
+        BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+        if (header->arena == nullptr) {
+            ::operator delete(header);
+        } else {
+            header->arena->dropReference();
+        }
+    }
+
+    GeneArena* GeneArena::getActive() {
+        return active;
+    }
+
+    std::size_t GeneArena::getReservedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reservedBytes;
+    }
+
+    std::size_t GeneArena::getLiveCount() const {
+        // minus the reference of the owner, which may already be released
+        return references.load(std::memory_order_relaxed) - 1;
+    }
+
+    void* GeneArena::allocateBlock(std::size_t size) {
+        ThreadChunk& current = threadChunk;
+        if (current.arenaId == id && static_cast<std::size_t>(current.end - current.next) >= size) {
+            char* block = current.next;
+            current.next += size;
+            return block;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        // oversized blocks get a chunk of their own, the chunk of the thread stays in use
+        if (size > chunkSize) {
+            char* chunk = static_cast<char*>(::operator new(size));
+            chunks.push_back(chunk);
+            reservedBytes += size;
+            return chunk;
+        }
+        char* chunk = static_cast<char*>(::operator new(chunkSize));
+        chunks.push_back(chunk);
+        reservedBytes += chunkSize;
+        current.arenaId = id;
+        current.next = chunk + size;
+        current.end = chunk + chunkSize;
+        return chunk;
+    }
+
+    void GeneArena::dropReference() noexcept {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    GeneArenaScope::GeneArenaScope(GeneArena* arena) : previous(GeneArena::active) {
+        GeneArena::active = arena;
+    }
+
+    GeneArenaScope::~GeneArenaScope() {
+        GeneArena::active = previous;
+    }
+}
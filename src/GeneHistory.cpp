@@ -0,0 +1,124 @@
+#include <mutex>
+
+#include "../include/NEAT/GeneHistory.hpp"
+
+namespace NEAT {
+
+    template <typename dType, typename T2>
+    GeneHistory<dType, T2>::GeneHistory() { }
+
+    template <typename dType, typename T2>
+    void GeneHistory<dType, T2>::init(T2 inputSize, T2 outputSize) {
+        // node ids of the input and output nodes are 0 to inputSize + outputSize - 1, they do not split an edge
+        // add edges
+        for (T2 i = 0; i < inputSize; i++) {
+            for (T2 j = 0; j < outputSize; j++) {
+                const std::pair<T2, T2> key = { i, j + inputSize };
+                EdgeShard& shard = edges[EdgeKeyHash()(key) % SHARD_COUNT];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.entries[key] = { i * outputSize + j, generation, true };
+            }
+        }
+        // set innovation number
+        edgeInnovationNumber.store(inputSize * outputSize);
+        nodeInnovationNumber.store(inputSize + outputSize);
+    }
+
+    template <typename dType, typename T2>
+    T2 GeneHistory<dType, T2>::addNode(const T2 fromId, const T2 toId, const T2 edgeInnovationNumber) {
+        NodeShard& shard = nodes[std::hash<T2>()(edgeInnovationNumber) % SHARD_COUNT];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // find if the node already exists
+        typename std::unordered_map<T2, Entry, std::hash<T2>>::iterator it = shard.entries.find(edgeInnovationNumber);
+        if (it != shard.entries.end()) {
+            // if the node already exists, return the node id
+            it->second.generation = generation;
+            return it->second.id;
+        }
+        // if the node does not exist, create a new node
+        const T2 nodeId = getNextNodeInnovationNumber();
+        shard.entries[edgeInnovationNumber] = { nodeId, generation, false };
+        return nodeId;
+    }
+
+    template <typename dType, typename T2>
+    T2 GeneHistory<dType, T2>::addEdge(const T2 fromId, const T2 toId) {
+        const std::pair<T2, T2> key = { fromId, toId };
+        EdgeShard& shard = edges[EdgeKeyHash()(key) % SHARD_COUNT];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // find if the edge already exists
+        typename std::unordered_map<std::pair<T2, T2>, Entry, EdgeKeyHash>::iterator it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            // if the edge already exists, return the edge id
+            it->second.generation = generation;
+            return it->second.id;
+        }
+        // if the edge does not exist, create a new edge
+        const T2 edgeId = getNextEdgeInnovationNumber();
+        shard.entries[key] = { edgeId, generation, false };
+        return edgeId;
+    }
+
+    template <typename dType, typename T2>
+    void GeneHistory<dType, T2>::setGeneration(T2 generation) {
+        this->generation = generation;
+    }
+
+    template <typename dType, typename T2>
+    const T2& GeneHistory<dType, T2>::getGeneration() const {
+        return generation;
+    }
+
+    template <typename dType, typename T2>
+    std::size_t GeneHistory<dType, T2>::expire(T2 maxAge) {
+        std::size_t removed = 0;
+        const auto expireShard = [this, maxAge, &removed](auto& shard) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                if (!it->second.permanent && generation - it->second.generation > maxAge) {
+                    it = shard.entries.erase(it);
+                    removed++;
+                } else {
+                    ++it;
+                }
+            }
+            };
+        for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+            expireShard(nodes[i]);
+            expireShard(edges[i]);
+        }
+        return removed;
+    }
+
+    template <typename dType, typename T2>
+    std::size_t GeneHistory<dType, T2>::size() const {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+            {
+                std::lock_guard<std::mutex> lock(nodes[i].mutex);
+                count += nodes[i].entries.size();
+            }
+            {
+                std::lock_guard<std::mutex> lock(edges[i].mutex);
+                count += edges[i].entries.size();
+            }
+        }
+        return count;
+    }
+
+    template <typename dType, typename T2>
+    T2 GeneHistory<dType, T2>::getNextEdgeInnovationNumber() {
+        return edgeInnovationNumber.fetch_add(1);
+    }
+
+    template <typename dType, typename T2>
+    T2 GeneHistory<dType, T2>::getNextNodeInnovationNumber() {
+        return nodeInnovationNumber.fetch_add(1);
+    }
+
+    // Explicit instantiation
+    template class GeneHistory<double, int>;
+    template class GeneHistory<double, long>;
+    template class GeneHistory<float, int>;
+    template class GeneHistory<float, long>;
+}
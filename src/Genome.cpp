@@ -1,6 +1,9 @@
 #include <iostream>
 #include <algorithm>
+#include <stdexcept>
 #include "../include/NEAT/Genome.hpp"
+#include "../include/NEAT/ExecutionPlan.hpp"
+#include "../include/NEAT/FlatGenome.hpp"
 #include "../include/NEAT/Activation.hpp"
 #include "../include/NEAT/Helper.hpp"
 namespace NEAT {
@@ -13,28 +16,39 @@ namespace NEAT {
     template <typename dType, typename T2>
     Genome<dType, T2>::Genome(T2 inputSize, T2 outputSize, bool init) :inputSize(inputSize), outputSize(outputSize) {
         if (!init) return;
+        // the genes are stored flat, node index i is node id i
+        std::shared_ptr<FlatGenome<dType, T2>> genes = std::make_shared<FlatGenome<dType, T2>>(inputSize, outputSize);
         // TODO: allow default activation function as parameter for both input and output nodes
         // 1. create input nodes
         for (T2 i = 0; i < inputSize; i++) {
-            Node<dType, T2>* node = new Node<dType, T2>(i, NodeType::INPUT, 0, 0, getActivationFunction_Factory<dType>()->sigmoid);
-            addNode(node);
+            genes->addNode(i, NodeType::INPUT, 0, 0, ActivationType::SIGMOID);
         }
         // 2. create output nodes
         for (T2 i = 0; i < outputSize; i++) {
-            Node<dType, T2>* node = new Node<dType, T2>(i + inputSize, NodeType::OUTPUT, 1, gaussianDistribution<dType>(0, 1), getActivationFunction_Factory<dType>()->identity);
-            addNode(node);
+            genes->addNode(i + inputSize, NodeType::OUTPUT, 1, gaussianDistribution<dType>(0, 1), ActivationType::IDENTITY);
         }
-        // 3. create edges
+        // 3. create edges, innovation numbers increase in this order
         for (T2 i = 0; i < inputSize; i++) {
             for (T2 j = 0; j < outputSize; j++) {
-                Node<dType, T2>* fromNode = nodes[i];
-                Node<dType, T2>* toNode = nodes[j + inputSize];
-                Edge<dType, T2>* edge = new Edge<dType, T2>(fromNode, toNode, uniformDistribution<dType>(-1, 1), i * outputSize + j);
-                addEdge(edge);
-                fromNode->addOutgoingEdge(edge);
-                toNode->addIncomingEdge(edge);
+                genes->addEdge(i * outputSize + j, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j + inputSize), uniformDistribution<dType>(-1, 1), true);
             }
         }
+        // inputs before outputs is a topological order
+        std::vector<std::uint32_t> nodeOrder(genes->getNodeCount());
+        for (std::uint32_t i = 0; i < nodeOrder.size(); i++) {
+            nodeOrder[i] = i;
+        }
+        genes->setNodeOrder(std::move(nodeOrder));
+        sharedFlatGenome = std::move(genes);
+        flatGenome.store(sharedFlatGenome.get(), std::memory_order_release);
+        materialized.store(false, std::memory_order_release);
+    }
+
+    template <typename dType, typename T2>
+    Genome<dType, T2>::Genome(std::shared_ptr<FlatGenome<dType, T2>> genes) :
+        inputSize(genes->getInputSize()), outputSize(genes->getOutputSize()), sharedFlatGenome(std::move(genes)) {
+        flatGenome.store(sharedFlatGenome.get(), std::memory_order_release);
+        materialized.store(false, std::memory_order_release);
     }
 
     template <typename dType, typename T2>
@@ -59,16 +73,19 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     const std::map< T2, Node<dType, T2>* >& Genome<dType, T2>::getNodes() const {
+        materialize();
         return nodes;
     }
 
     template <typename dType, typename T2>
     const std::map< T2, Edge<dType, T2>* >& Genome<dType, T2>::getEdges() const {
+        materialize();
         return edges;
     }
 
     template <typename dType, typename T2>
     Edge<dType, T2>* Genome<dType, T2>::getEdge(T2 innovationNumber) const {
+        materialize();
         if (edges.count(innovationNumber) == 0) {
             return nullptr;
         }
@@ -77,6 +94,7 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     Node<dType, T2>* Genome<dType, T2>::getNode(T2 id) const {
+        materialize();
         if (nodes.count(id) == 0) {
             return nullptr;
         }
@@ -88,6 +106,7 @@ namespace NEAT {
         if (edge == nullptr) {
             return false;
         }
+        materialize();
         Edge<dType, T2>* cloneEdge = edge->clone();
         // std::cout << "addCloneEdge: " << cloneEdge->getInnovationNumber() << std::endl;
         // std::cout << "Address: " << cloneEdge << std::endl;
@@ -104,6 +123,7 @@ namespace NEAT {
         if (node == nullptr) {
             return false;
         }
+        materialize();
         Node<dType, T2>* cloneNode = node->clone();
         bool success = addNode(cloneNode);
         if (!success) {
@@ -117,15 +137,27 @@ namespace NEAT {
         if (node == nullptr) {
             return false;
         }
+        materialize();
         bool success = addNode(node);
         return success;
     }
 
+    template <typename dType, typename T2>
+    bool Genome<dType, T2>::addEdge_noClone(Edge<dType, T2>* edge) {
+        if (edge == nullptr) {
+            return false;
+        }
+        materialize();
+        bool success = addEdge(edge);
+        return success;
+    }
+
     template <typename dType, typename T2>
     void Genome<dType, T2>::disableEdge(T2 innovationNumber) {
         Edge<dType, T2>* edge = getEdge(innovationNumber);
         if (edge != nullptr) {
             edge->disable();
+            invalidateCache();
         }
     }
 
@@ -134,6 +166,7 @@ namespace NEAT {
         Edge<dType, T2>* edge = getEdge(innovationNumber);
         if (edge != nullptr) {
             edge->enable();
+            invalidateCache();
         }
     }
 
@@ -142,22 +175,27 @@ namespace NEAT {
         Edge<dType, T2>* edge = getEdge(innovationNumber);
         if (edge != nullptr) {
             edge->toggle();
+            invalidateCache();
         }
     }
 
     template <typename dType, typename T2>
     T2 Genome<dType, T2>::getMaxInnovationNumber() const {
-        T2 maxInnovationNumber = 0;
-        for (std::pair<const T2, Edge<dType, T2>*> pair : edges) {
-            if (pair.first > maxInnovationNumber) {
-                maxInnovationNumber = pair.first;
-            }
+        // edges are ordered by innovation number
+        if (!materialized.load(std::memory_order_acquire)) {
+            const std::vector<T2>& innovations = sharedFlatGenome->getInnovations();
+            if (innovations.empty() || innovations.back() < 0) return 0;
+            return innovations.back();
         }
-        return maxInnovationNumber;
+        if (edges.empty() || edges.rbegin()->first < 0) return 0;
+        return edges.rbegin()->first;
     }
 
     template <typename dType, typename T2>
     T2 Genome<dType, T2>::getNumberOfGenes() const {
+        if (!materialized.load(std::memory_order_acquire)) {
+            return sharedFlatGenome->getEdgeCount() + sharedFlatGenome->getNodeCount();
+        }
         return edges.size() + nodes.size();
     }
 
@@ -171,41 +209,34 @@ namespace NEAT {
         return fitness;
     }
 
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::setSpeciesId(T2 speciesId) {
+        this->speciesId = speciesId;
+    }
+
+    template <typename dType, typename T2>
+    const T2& Genome<dType, T2>::getSpeciesId() const {
+        return speciesId;
+    }
+
     template <typename dType, typename T2>
     void Genome<dType, T2>::feedForward(const std::vector<dType>& inputs, std::vector<dType>& outputs) {
-        std::vector<Node<dType, T2>*> allNodes;
+        feedForward(inputs, outputs, workspace);
+    }
 
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::feedForward(const std::vector<dType>& inputs, std::vector<dType>& outputs, ActivationWorkspace<dType>& workspace) const {
         if (static_cast<T2>(inputs.size()) != inputSize) {
             throw "Input size does not match genome input size";
             // std::cerr << "Input size does not match genome input size" << std::endl;
             // outputs.assign(outputSize, 0);
             // throw std::exception();
         }
-        // 1. reset all nodes
-        for (std::pair<const T2, Node<dType, T2>*> pair : nodes) {
-            pair.second->reset();
-        }
-        // 2. set input nodes
-        for (T2 i = 0; i < inputSize; i++) {
-            Node<dType, T2>* node = nodes.at(i);
-            node->setValue(inputs.at(i));
-        }
-        // 3. sort nodes according to layer
-        for (std::pair<const T2, Node<dType, T2>*> pair : nodes) {
-            allNodes.push_back(pair.second);
-        }
-        std::sort(allNodes.begin(), allNodes.end(), [](Node<dType, T2>* a, Node<dType, T2>* b) {
-            return a->getLayer() < b->getLayer();
-            });
-        // 4. forward propagate
-        for (Node<dType, T2>* node : allNodes) {
-            node->forwardPropagate(this);
-        }
-        // 5. get output nodes
-        for (T2 i = inputSize; i < inputSize + outputSize; i++) {
-            Node<dType, T2>* node = nodes.at(i);
-            outputs.push_back(node->getValue());
-        }
+        const ExecutionPlan<dType, T2>& plan = getExecutionPlan();
+        // outputs are appended
+        const std::size_t offset = outputs.size();
+        outputs.resize(offset + outputSize);
+        plan.evaluate(inputs.data(), outputs.data() + offset, workspace);
     }
 
     template <typename dType, typename T2>
@@ -215,10 +246,34 @@ namespace NEAT {
         return outputs;
     }
 
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::feedForwardBatch(const std::vector<dType>& inputs, std::size_t rows, std::vector<dType>& outputs) {
+        if (inputs.size() != rows * static_cast<std::size_t>(inputSize)) {
+            throw std::invalid_argument("Genome<dType, T2>::feedForwardBatch - inputs.size() != rows * inputSize");
+        }
+        outputs.resize(rows * static_cast<std::size_t>(outputSize));
+        feedForwardBatch(inputs.data(), rows, outputs.data());
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::feedForwardBatch(const dType* inputs, std::size_t rows, dType* outputs) {
+        feedForwardBatch(inputs, rows, outputs, workspace);
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::feedForwardBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace) const {
+        getExecutionPlan().evaluateBatch(inputs, rows, outputs, workspace);
+    }
+
     template <typename dType, typename T2>
     T2 Genome<dType, T2>::predict(const std::vector<dType>& inputs) {
+        return predict(inputs, workspace);
+    }
+
+    template <typename dType, typename T2>
+    T2 Genome<dType, T2>::predict(const std::vector<dType>& inputs, ActivationWorkspace<dType>& workspace) const {
         std::vector<dType> outputs {};
-        feedForward(inputs, outputs);
+        feedForward(inputs, outputs, workspace);
         T2 maxIndex = 0;
         for (T2 i = 0; i < outputSize; i++) {
             if (outputs[i] > outputs[maxIndex]) {
@@ -228,57 +283,115 @@ namespace NEAT {
         return maxIndex;
     }
 
+    template <typename dType, typename T2>
+    const ExecutionPlan<dType, T2>& Genome<dType, T2>::getExecutionPlan() const {
+        const ExecutionPlan<dType, T2>* plan = executionPlan.load(std::memory_order_acquire);
+        if (plan != nullptr) {
+            return *plan;
+        }
+        std::lock_guard<std::mutex> lock(executionPlanMutex);
+        plan = executionPlan.load(std::memory_order_relaxed);
+        if (plan == nullptr) {
+            sharedExecutionPlan = std::make_shared<const ExecutionPlan<dType, T2>>(getFlatGenome());
+            plan = sharedExecutionPlan.get();
+            executionPlan.store(plan, std::memory_order_release);
+        }
+        return *plan;
+    }
+
+    template <typename dType, typename T2>
+    std::shared_ptr<const ExecutionPlan<dType, T2>> Genome<dType, T2>::getSharedExecutionPlan() const {
+        getExecutionPlan();
+        std::lock_guard<std::mutex> lock(executionPlanMutex);
+        return sharedExecutionPlan;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<std::uint32_t>& Genome<dType, T2>::getTopologicalOrder() {
+        materialize();
+        if (!topologicalOrderValid) buildTopologicalOrder();
+        return topologicalOrder;
+    }
+
+    template <typename dType, typename T2>
+    const FlatGenome<dType, T2>& Genome<dType, T2>::getFlatGenome() const {
+        const FlatGenome<dType, T2>* flat = flatGenome.load(std::memory_order_acquire);
+        if (flat != nullptr) {
+            return *flat;
+        }
+        std::lock_guard<std::mutex> lock(flatGenomeMutex);
+        flat = flatGenome.load(std::memory_order_relaxed);
+        if (flat == nullptr) {
+            sharedFlatGenome = std::make_shared<FlatGenome<dType, T2>>(*this);
+            flat = sharedFlatGenome.get();
+            flatGenome.store(flat, std::memory_order_release);
+        }
+        return *flat;
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::invalidateCache() {
+        // flat genes are only changed through editFlatGenome, which keeps them
+        if (!materialized.load(std::memory_order_acquire)) return;
+        executionPlan.store(nullptr);
+        sharedExecutionPlan.reset();
+        flatGenome.store(nullptr);
+        sharedFlatGenome.reset();
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::materialize() const {
+        if (materialized.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(structureMutex);
+        if (materialized.load(std::memory_order_relaxed)) return;
+        // nodes and edges are owned by this genome and not part of its observable value, the caches stay valid
+        sharedFlatGenome->fillGenome(*const_cast<Genome<dType, T2>*>(this));
+        materialized.store(true, std::memory_order_release);
+    }
+
+    template <typename dType, typename T2>
+    FlatGenome<dType, T2>& Genome<dType, T2>::editFlatGenome() {
+        {
+            std::lock_guard<std::mutex> lock(flatGenomeMutex);
+            if (sharedFlatGenome.use_count() > 1) {
+                sharedFlatGenome = std::make_shared<FlatGenome<dType, T2>>(*sharedFlatGenome);
+                flatGenome.store(sharedFlatGenome.get(), std::memory_order_release);
+            }
+            else {
+                // the last other owner may have released it just now, its reads happen before the edits
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+        }
+        std::lock_guard<std::mutex> lock(executionPlanMutex);
+        executionPlan.store(nullptr);
+        sharedExecutionPlan.reset();
+        return *sharedFlatGenome;
+    }
+
     template <typename dType, typename T2>
     Genome<dType, T2>* Genome<dType, T2>::clone() const {
-        // TODO: Check all clone mem leak or ref leak
+        // the clone shares the genes and the execution plan, it copies the genes when mutated
+        getFlatGenome();
         Genome<dType, T2>* newGenome = new Genome<dType, T2>(inputSize, outputSize, false);
         newGenome->setFitness(fitness);
-        for (std::pair<T2, Edge<dType, T2>*> edgePair : edges) {
-            Edge<dType, T2>* edge = edgePair.second;
-            newGenome->addCloneEdge(edge);
-        }
-        // build node from edges
-        for (std::pair<const T2, Edge<dType, T2>*> edgePair : edges) {
-            const Edge<dType, T2>* originalEdge = edgePair.second;
-            Edge<dType, T2>* newEdge = newGenome->getEdge(originalEdge->getInnovationNumber());
-            if (newEdge == nullptr) {
-                std::cerr << "newEdge is null" << std::endl;
-                continue;
-            }
-            const Node<dType, T2>* originalFromNode = originalEdge->getFrom(this);
-            Node<dType, T2>* fromNode = originalEdge->getFrom(newGenome);
-            if (fromNode == nullptr) {
-                const T2& id = originalFromNode->getId();
-                const NodeType nodeType = originalFromNode->getType();
-                const dType bias = originalFromNode->getBias();
-                const int layer = originalFromNode->getLayer();
-                ActivationFunction<dType>* activationFunction = originalFromNode->getActivationFunction();
-                fromNode = new Node<dType, T2>(id, nodeType, layer, bias, activationFunction);
-                newGenome->addNode(fromNode);
-                fromNode->addOutgoingEdge(newEdge);
-            } else {
-                fromNode->addOutgoingEdge(newEdge);
-            }
-            const Node<dType, T2>* originalToNode = originalEdge->getTo(this);
-            Node<dType, T2>* toNode = originalEdge->getTo(newGenome);
-            if (toNode == nullptr) {
-                const T2& id = originalToNode->getId();
-                const NodeType nodeType = originalToNode->getType();
-                const dType bias = originalToNode->getBias();
-                const int layer = originalToNode->getLayer();
-                ActivationFunction<dType>* activationFunction = originalToNode->getActivationFunction();
-                toNode = new Node<dType, T2>(id, nodeType, layer, bias, activationFunction);
-                newGenome->addNode(toNode);
-                toNode->addIncomingEdge(newEdge);
-            } else {
-                toNode->addIncomingEdge(newEdge);
-            }
+        newGenome->setSpeciesId(speciesId);
+        {
+            std::lock_guard<std::mutex> lock(flatGenomeMutex);
+            newGenome->sharedFlatGenome = sharedFlatGenome;
+            newGenome->flatGenome.store(sharedFlatGenome.get(), std::memory_order_release);
+        }
+        {
+            std::lock_guard<std::mutex> lock(executionPlanMutex);
+            newGenome->sharedExecutionPlan = sharedExecutionPlan;
+            newGenome->executionPlan.store(sharedExecutionPlan.get(), std::memory_order_release);
         }
+        newGenome->materialized.store(false, std::memory_order_release);
         return newGenome;
     }
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::print(int tabSize) const {
+        materialize();
         coutTab(tabSize);
         std::cout << "Genome: " << std::endl;
         coutTab(tabSize);
@@ -306,22 +419,177 @@ namespace NEAT {
     template <typename dType, typename T2>
     bool Genome<dType, T2>::addNode(Node<dType, T2>* node) {
         // check if node already exists
-        if (getNode(node->getId()) != nullptr) {
+        if (nodes.count(node->getId()) != 0) {
             // std::cout << "node already exists: " << node->getId() << std::endl;
             return false;
         }
         nodes.insert(std::pair<T2, Node<dType, T2>*>(node->getId(), node));
+        node->setIndex(static_cast<std::uint32_t>(nodeList.size()));
+        nodeList.push_back(node);
+        // a node without edges can go anywhere in the order
+        if (topologicalOrderValid) {
+            topologicalPosition.push_back(static_cast<std::uint32_t>(topologicalOrder.size()));
+            topologicalOrder.push_back(node->getIndex());
+            topologicalMark.push_back(0);
+        }
+        switch (node->getType()) {
+        case NodeType::INPUT:
+            inputNodes.push_back(node);
+            break;
+        case NodeType::OUTPUT:
+            outputNodes.push_back(node);
+            break;
+        case NodeType::HIDDEN:
+            hiddenNodes.push_back(node);
+            break;
+        default:
+            break;
+        }
+        invalidateCache();
         return true;
     }
 
     template <typename dType, typename T2>
     bool Genome<dType, T2>::addEdge(Edge<dType, T2>* edge) {
         // check if edge already exists
-        if (getEdge(edge->getInnovationNumber()) != nullptr) {
+        if (edges.count(edge->getInnovationNumber()) != 0) {
             // std::cout << "edge already exists: " << edge->getInnovationNumber() << std::endl;
             return false;
         }
         edges.insert(std::pair<T2, Edge<dType, T2>*>(edge->getInnovationNumber(), edge));
+        edgeList.push_back(edge);
+        // resolve the endpoints once, later lookups are array indices
+        const bool hasPointers = edge->getState() == EdgeState::POINTER_ENABLED || edge->getState() == EdgeState::BOTH_ENABLED;
+        const Node<dType, T2>* from = hasPointers ? edge->getFrom(nullptr) : nullptr;
+        const Node<dType, T2>* to = hasPointers ? edge->getTo(nullptr) : nullptr;
+        edge->bind(this, resolveNodeIndex(from, edge->getFromId()), resolveNodeIndex(to, edge->getToId()));
+        // edges against the order are only expected outside the structural mutations, the order is rebuilt on next use
+        if (topologicalOrderValid) {
+            const std::uint32_t fromIndex = edge->getFromIndex();
+            const std::uint32_t toIndex = edge->getToIndex();
+            if (fromIndex == Edge<dType, T2>::NO_INDEX || toIndex == Edge<dType, T2>::NO_INDEX || topologicalPosition[fromIndex] >= topologicalPosition[toIndex]) {
+                topologicalOrderValid = false;
+            }
+        }
+        invalidateCache();
+        return true;
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t Genome<dType, T2>::resolveNodeIndex(const Node<dType, T2>* node, T2 id) const {
+        // a node pointer given to the edge is only trusted if it is a node of this genome
+        if (node != nullptr && node->getIndex() < nodeList.size() && nodeList[node->getIndex()] == node) {
+            return node->getIndex();
+        }
+        typename std::map<T2, Node<dType, T2>*>::const_iterator it = nodes.find(id);
+        return (it != nodes.end()) ? it->second->getIndex() : Edge<dType, T2>::NO_INDEX;
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::buildTopologicalOrder() {
+        const std::uint32_t nodeCount = static_cast<std::uint32_t>(nodeList.size());
+        std::vector<std::uint32_t> inDegree(nodeCount, 0);
+        for (const Edge<dType, T2>* edge : edgeList) {
+            if (edge->getFromIndex() >= nodeCount || edge->getToIndex() >= nodeCount) continue;
+            inDegree[edge->getToIndex()]++;
+        }
+        topologicalOrder.clear();
+        topologicalOrder.reserve(nodeCount);
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            if (inDegree[i] == 0) topologicalOrder.push_back(i);
+        }
+        for (std::size_t head = 0; head < topologicalOrder.size(); head++) {
+            for (const Edge<dType, T2>* edge : nodeList[topologicalOrder[head]]->getOutgoingEdges()) {
+                const std::uint32_t next = edge->getToIndex();
+                if (next < nodeCount && --inDegree[next] == 0) topologicalOrder.push_back(next);
+            }
+        }
+        // nodes on a cycle, only possible with edges added outside the structural mutations, keep their index order
+        if (topologicalOrder.size() < nodeCount) {
+            for (std::uint32_t i = 0; i < nodeCount; i++) {
+                if (inDegree[i] != 0) topologicalOrder.push_back(i);
+            }
+        }
+        topologicalPosition.assign(nodeCount, 0);
+        for (std::uint32_t position = 0; position < nodeCount; position++) {
+            topologicalPosition[topologicalOrder[position]] = position;
+        }
+        topologicalMark.assign(nodeCount, 0);
+        topologicalOrderValid = true;
+    }
+
+    template <typename dType, typename T2>
+    bool Genome<dType, T2>::insertTopologicalEdge(std::uint32_t from, std::uint32_t to) {
+        if (from == to) return false;
+        const std::uint32_t lower = topologicalPosition[to];
+        const std::uint32_t upper = topologicalPosition[from];
+        if (upper < lower) return true;
+        const std::uint32_t nodeCount = static_cast<std::uint32_t>(nodeList.size());
+        std::vector<std::uint32_t> forward, backward, stack;
+        // 1. nodes reachable from the target that are not after the source
+        bool cycle = false;
+        topologicalMark[to] = 1;
+        stack.push_back(to);
+        while (!stack.empty() && !cycle) {
+            const std::uint32_t node = stack.back();
+            stack.pop_back();
+            forward.push_back(node);
+            for (const Edge<dType, T2>* edge : nodeList[node]->getOutgoingEdges()) {
+                const std::uint32_t next = edge->getToIndex();
+                if (next >= nodeCount) continue;
+                if (next == from) {
+                    cycle = true;
+                    break;
+                }
+                if (topologicalMark[next] == 0 && topologicalPosition[next] < upper) {
+                    topologicalMark[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+        if (cycle) {
+            for (std::uint32_t node : forward) topologicalMark[node] = 0;
+            for (std::uint32_t node : stack) topologicalMark[node] = 0;
+            return false;
+        }
+        // 2. nodes reaching the source that are not before the target
+        topologicalMark[from] = 1;
+        stack.push_back(from);
+        while (!stack.empty()) {
+            const std::uint32_t node = stack.back();
+            stack.pop_back();
+            backward.push_back(node);
+            for (const Edge<dType, T2>* edge : nodeList[node]->getIncomingEdges()) {
+                const std::uint32_t previous = edge->getFromIndex();
+                if (previous >= nodeCount) continue;
+                if (topologicalMark[previous] == 0 && topologicalPosition[previous] > lower) {
+                    topologicalMark[previous] = 1;
+                    stack.push_back(previous);
+                }
+            }
+        }
+        // 3. the affected nodes take over their own positions, the source side first, relative order kept
+        const auto byPosition = [this](std::uint32_t a, std::uint32_t b) {
+            return topologicalPosition[a] < topologicalPosition[b];
+        };
+        std::sort(forward.begin(), forward.end(), byPosition);
+        std::sort(backward.begin(), backward.end(), byPosition);
+        std::vector<std::uint32_t> positions;
+        positions.reserve(forward.size() + backward.size());
+        for (std::uint32_t node : backward) positions.push_back(topologicalPosition[node]);
+        for (std::uint32_t node : forward) positions.push_back(topologicalPosition[node]);
+        std::sort(positions.begin(), positions.end());
+        std::size_t i = 0;
+        for (std::uint32_t node : backward) {
+            topologicalPosition[node] = positions[i];
+            topologicalOrder[positions[i++]] = node;
+            topologicalMark[node] = 0;
+        }
+        for (std::uint32_t node : forward) {
+            topologicalPosition[node] = positions[i];
+            topologicalOrder[positions[i++]] = node;
+            topologicalMark[node] = 0;
+        }
         return true;
     }
 
@@ -337,4 +605,6 @@ namespace NEAT {
     // Explicit Instantiation
     template class Genome<double, int>;
     template class Genome<double, long>;
+    template class Genome<float, int>;
+    template class Genome<float, long>;
 }
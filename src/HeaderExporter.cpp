@@ -0,0 +1,148 @@
+#include <cmath>
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "../include/NEAT/HeaderExporter.hpp"
+#include "../include/NEAT/Genome.hpp"
+
+namespace NEAT {
+
+    namespace {
+        // values per line of a generated array
+        const std::size_t ARRAY_COLUMNS = 8;
+
+        /**
+         * @brief Exact C++11 float literal of a value
+         *
+         */
+        std::string floatLiteral(float value) {
+            if (std::isnan(value)) return "NAN";
+            if (std::isinf(value)) return value > 0 ? "INFINITY" : "-INFINITY";
+            std::ostringstream stream;
+            stream << std::scientific << std::setprecision(std::numeric_limits<float>::max_digits10 - 1) << value << 'f';
+            return stream.str();
+        }
+
+        /**
+         * @brief Write a constexpr array, an empty array gets one unused element
+         *
+         */
+        template <typename Value, typename Format>
+        void writeArray(std::ostringstream& out, const char* type, const char* name, const std::vector<Value>& values, Format format) {
+            out << "    constexpr " << type << " " << name << "[] = {";
+            if (values.empty()) {
+                out << " 0 };\n";
+                return;
+            }
+            for (std::size_t i = 0; i < values.size(); i++) {
+                out << (i % ARRAY_COLUMNS == 0 ? "\n        " : " ") << format(values[i]) << (i + 1 < values.size() ? "," : "");
+            }
+            out << "\n    };\n";
+        }
+
+        bool isIdentifier(const std::string& name) {
+            if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) return false;
+            for (char c : name) {
+                if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+            }
+            return true;
+        }
+    }
+
+    template <typename dType, typename T2>
+    std::string HeaderExporter<dType, T2>::generate(const ExecutionPlan<dType, T2>& plan, const std::string& name) {
+        if (!isIdentifier(name)) {
+            throw std::invalid_argument("HeaderExporter<dType, T2>::generate - name must be a C++ identifier");
+        }
+        std::vector<unsigned> activations;
+        activations.reserve(plan.getNodeCount());
+        for (ActivationType type : plan.getActivations()) {
+            if (type >= ActivationType::USER_DEFINED) {
+                throw std::invalid_argument("HeaderExporter<dType, T2>::generate - user-defined activation functions cannot be exported");
+            }
+            activations.push_back(static_cast<unsigned>(type));
+        }
+        std::string guard = "NEAT_EXPORT_" + name + "_HPP";
+        for (char& c : guard) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        const auto toFloat = [](dType value) { return floatLiteral(static_cast<float>(value)); };
+        const auto toIndex = [](std::uint32_t value) { return std::to_string(value) + "u"; };
+        std::ostringstream out;
+        out << "// generated by NEAT::HeaderExporter, " << plan.getInputSize() << " inputs, " << plan.getOutputSize() << " outputs, "
+            << plan.getNodeCount() << " slots, " << plan.getEdgeCount() << " edges\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n\n"
+            << "#include <cmath>\n"
+            << "#include <cstddef>\n\n"
+            << "namespace " << name << " {\n\n"
+            << "    constexpr std::size_t INPUT_SIZE = " << plan.getInputSize() << ";\n"
+            << "    constexpr std::size_t OUTPUT_SIZE = " << plan.getOutputSize() << ";\n"
+            << "    constexpr std::size_t NODE_COUNT = " << plan.getNodeCount() << ";\n"
+            << "    constexpr std::size_t EDGE_COUNT = " << plan.getEdgeCount() << ";\n\n"
+            << "    // activation function of each slot: 0 sigmoid, 1 tanh, 2 relu, 3 step, 4 identity\n";
+        writeArray(out, "unsigned char", "ACTIVATIONS", activations, [](unsigned value) { return std::to_string(value); });
+        writeArray(out, "float", "BIASES", plan.getBiases(), toFloat);
+        out << "    // incoming edges of slot s are [EDGE_OFFSETS[s], EDGE_OFFSETS[s + 1]), their sources come before s\n";
+        writeArray(out, "unsigned", "EDGE_OFFSETS", plan.getEdgeOffsets(), toIndex);
+        writeArray(out, "unsigned", "EDGE_SOURCES", plan.getEdgeSources(), toIndex);
+        writeArray(out, "float", "EDGE_WEIGHTS", plan.getEdgeWeights(), toFloat);
+        writeArray(out, "unsigned", "INPUT_SLOTS", plan.getInputSlots(), toIndex);
+        writeArray(out, "unsigned", "OUTPUT_SLOTS", plan.getOutputSlots(), toIndex);
+        out << "\n"
+            << "    inline float activate(unsigned char type, float x) {\n"
+            << "        switch (type) {\n"
+            << "        case 0: return 1 / (1 + std::exp(-x));\n"
+            << "        case 1: return std::tanh(x);\n"
+            << "        case 2: return x > 0 ? x : 0;\n"
+            << "        case 3: return x > 0 ? 1 : 0;\n"
+            << "        default: return x;\n"
+            << "        }\n"
+            << "    }\n\n"
+            << "    /**\n"
+            << "     * @brief Evaluate the network, without allocation\n"
+            << "     *\n"
+            << "     * @param inputs pointer to INPUT_SIZE input values\n"
+            << "     * @param outputs pointer to OUTPUT_SIZE values to write\n"
+            << "     */\n"
+            << "    inline void evaluate(const float* inputs, float* outputs) {\n"
+            << "        float values[NODE_COUNT] = {};\n"
+            << "        for (std::size_t i = 0; i < INPUT_SIZE; i++) {\n"
+            << "            values[INPUT_SLOTS[i]] = inputs[i];\n"
+            << "        }\n"
+            << "        for (std::size_t slot = 0; slot < NODE_COUNT; slot++) {\n"
+            << "            float sum = values[slot] + BIASES[slot];\n"
+            << "            for (unsigned e = EDGE_OFFSETS[slot]; e < EDGE_OFFSETS[slot + 1]; e++) {\n"
+            << "                sum += EDGE_WEIGHTS[e] * values[EDGE_SOURCES[e]];\n"
+            << "            }\n"
+            << "            values[slot] = activate(ACTIVATIONS[slot], sum);\n"
+            << "        }\n"
+            << "        for (std::size_t i = 0; i < OUTPUT_SIZE; i++) {\n"
+            << "            outputs[i] = values[OUTPUT_SLOTS[i]];\n"
+            << "        }\n"
+            << "    }\n"
+            << "}\n\n"
+            << "#endif // " << guard << "\n";
+        return out.str();
+    }
+
+    template <typename dType, typename T2>
+    void HeaderExporter<dType, T2>::write(const Genome<dType, T2>& genome, const std::string& path, const std::string& name) {
+        const std::string header = generate(genome.getExecutionPlan(), name);
+        std::ofstream file(path, std::ios::binary);
+        file << header;
+        if (!file) {
+            throw std::invalid_argument("HeaderExporter<dType, T2>::write - cannot write " + path);
+        }
+    }
+
+    // Explicit instantiation
+    template class HeaderExporter<double, int>;
+    template class HeaderExporter<double, long>;
+    template class HeaderExporter<float, int>;
+    template class HeaderExporter<float, long>;
+}
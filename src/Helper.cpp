@@ -28,5 +28,27 @@ namespace NEAT {
   unsigned int getSeed() {
     return Seed::getSeed();
   }
+  // 
+  // 
+  RandomStream::RandomStream(std::uint64_t seed, std::uint64_t generation, std::uint64_t index, std::uint64_t phase) {
+    key = mix(seed + 0x9E3779B97F4A7C15ULL);
+    key = mix(key ^ (generation + 0xD1B54A32D192ED03ULL));
+    key = mix(key ^ (index + 0x8CB92BA72F3D8DD7ULL));
+    key = mix(key ^ (phase + 0xABC98388FB8FAC03ULL));
+  }
+
+  RandomStream* RandomStream::getActive() {
+    return active;
+  }
+
+  thread_local RandomStream* RandomStream::active = nullptr;
+
+  RandomStreamScope::RandomStreamScope(RandomStream& stream) : previous(RandomStream::active) {
+    RandomStream::active = &stream;
+  }
+
+  RandomStreamScope::~RandomStreamScope() {
+    RandomStream::active = previous;
+  }
 
 }
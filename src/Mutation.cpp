@@ -9,13 +9,14 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::mutate(GeneHistory<dType, T2>& GeneHistory, const MutationConfig<dType>& mutationConfig) {
-        // TODO: Extract probabilities to a config file
+        mutateStructure(GeneHistory, mutationConfig);
+        mutateParameters(mutationConfig);
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::mutateStructure(GeneHistory<dType, T2>& GeneHistory, const MutationConfig<dType>& mutationConfig) {
         const dType mutateAddNodeProbability = mutationConfig.mutateAddNodeProbability;
         const dType mutateAddEdgeProbability = mutationConfig.mutateAddEdgeProbability;
-        const dType mutateToggleEdgeProbability = mutationConfig.mutateToggleEdgeProbability;
-        const dType mutateWeightProbability = mutationConfig.mutateWeightProbability;
-        const dType mutateActivationFunctionProbability = mutationConfig.mutateActivationFunctionProbability;
-        const dType mutateBiasProbability = mutationConfig.mutateBiasProbability;
 
         if (uniformDistribution<dType>(0, 1) < mutateAddNodeProbability) {
             mutateAddNode(GeneHistory);
@@ -23,6 +24,15 @@ namespace NEAT {
         if (uniformDistribution<dType>(0, 1) < mutateAddEdgeProbability) {
             mutateAddEdge(GeneHistory);
         }
+    }
+
+    template <typename dType, typename T2>
+    void Genome<dType, T2>::mutateParameters(const MutationConfig<dType>& mutationConfig) {
+        const dType mutateToggleEdgeProbability = mutationConfig.mutateToggleEdgeProbability;
+        const dType mutateWeightProbability = mutationConfig.mutateWeightProbability;
+        const dType mutateActivationFunctionProbability = mutationConfig.mutateActivationFunctionProbability;
+        const dType mutateBiasProbability = mutationConfig.mutateBiasProbability;
+
         if (uniformDistribution<dType>(0, 1) < mutateToggleEdgeProbability) {
             mutateToggleEdge();
         }
@@ -39,20 +49,49 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::mutateAddNode(GeneHistory<dType, T2>& GeneHistory) {
+        if (!materialized.load(std::memory_order_acquire)) {
+            // same steps on the flat genes, they are only copied once a node is added
+            const FlatGenome<dType, T2>& genes = *sharedFlatGenome;
+            if (genes.getEdgeCount() == 0) return;
+            const std::uint32_t edge = static_cast<std::uint32_t>(uniformIntDistribution<T2>(0, static_cast<T2>(genes.getEdgeCount() - 1)));
+            if (!genes.isEnabled(edge)) return;
+            const std::uint32_t from = genes.getEdgeFrom()[edge];
+            const std::uint32_t to = genes.getEdgeTo()[edge];
+            const T2 fromId = genes.getNodeIds()[from];
+            const T2 toId = genes.getNodeIds()[to];
+            const T2 newNodeId = GeneHistory.addNode(fromId, toId, genes.getInnovations()[edge]);
+            if (genes.findNode(newNodeId) != FlatGenome<dType, T2>::NOT_FOUND) return;
+            const int newLayer = std::min(genes.getNodeLayers()[from], genes.getNodeLayers()[to]) + 1;
+            const dType bias = gaussianDistribution<dType>(0, 1);
+            const T2 innovationNumber1 = GeneHistory.addEdge(fromId, newNodeId);
+            const T2 innovationNumber2 = GeneHistory.addEdge(newNodeId, toId);
+            const dType weight = genes.getEdgeWeights()[edge];
+            FlatGenome<dType, T2>& edited = editFlatGenome();
+            edited.setEnabled(edge, false);
+            const std::uint32_t newNode = edited.insertNode(newNodeId, NodeType::HIDDEN, newLayer, bias, ActivationType::SIGMOID, to);
+            edited.insertEdge(innovationNumber1, from + (from >= newNode), newNode, 1, true);
+            edited.insertEdge(innovationNumber2, newNode, to + (to >= newNode), weight, true);
+            return;
+        }
+        if (!topologicalOrderValid) buildTopologicalOrder();
         // 1. select a random edge
         Edge<dType, T2>* edge = getRandomEdge();
-        if (edge == nullptr)
+        if (edge == nullptr || edge->isDisabled())
             return;
-        // 2. disable the edge
-        edge->disable();
-        // 3. create a new node, layer of the new node is 1 + min layer of the two nodes
         Node<dType, T2>* fromNode = edge->getFrom(this);
         Node<dType, T2>* toNode = edge->getTo(this);
         const T2 newNodeId = GeneHistory.addNode(fromNode->getId(), toNode->getId(), edge->getInnovationNumber());
+        // the edge has been split in this genome before
+        if (getNode(newNodeId) != nullptr)
+            return;
+        // 2. disable the edge
+        edge->disable();
+        // 3. create a new node, layer of the new node is 1 + min layer of the two nodes,
+        //    layers are not renumbered, the topological order decides the evaluation order
         const int newLayer = std::min(fromNode->getLayer(), toNode->getLayer()) + 1;
         const dType bias = gaussianDistribution<dType>(0, 1);
         // TODO: Check if the default activation function is random or deterministic
-        Node<dType, T2>* newNode = new Node<dType, T2>(newNodeId, NodeType::HIDDEN, newLayer, bias, getActivationFunction_Factory()->sigmoid);
+        Node<dType, T2>* newNode = new Node<dType, T2>(newNodeId, NodeType::HIDDEN, newLayer, bias, ActivationType::SIGMOID);
         // 4. create two new edges, 
         //   one from the first node to the new node with weight 1
         //   one from the new node to the second node with the same weight as the disabled edge
@@ -62,18 +101,13 @@ namespace NEAT {
         // std::cout << "innovationNumber2: " << innovationNumber2 << std::endl;
         Edge<dType, T2>* newEdge1 = new Edge<dType, T2>(fromNode, newNode, 1, innovationNumber1);
         Edge<dType, T2>* newEdge2 = new Edge<dType, T2>(newNode, toNode, edge->getWeight(), innovationNumber2);
-        // 5. update the layer of the nodes, all nodes with layer > new node layer
-        for (std::pair<const T2, Node<dType, T2>*>& nodePair : nodes) {
-            Node<dType, T2>* node = nodePair.second;
-            if (node->getLayer() >= newLayer) {
-                node->setLayer(node->getLayer() + 1);
-            }
-        }
-        // 6. add the new node and edges to the genome
+        // 5. add the new node and edges to the genome, the new node is appended to the topological order
+        //    and moved in front of the second node, only the descendants of the second node are reordered
         // nodes.insert(std::make_pair(newNodeId, newNode));
         // edges.insert(std::make_pair(innovationNumber1, newEdge1));
         // edges.insert(std::make_pair(innovationNumber2, newEdge2));
         this->addNode(newNode);
+        insertTopologicalEdge(newNode->getIndex(), toNode->getIndex());
         this->addEdge(newEdge1);
         this->addEdge(newEdge2);
         fromNode->addOutgoingEdge(newEdge1);
@@ -84,30 +118,40 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::mutateAddEdge(GeneHistory<dType, T2>& GeneHistory) {
-        // 1. select two random distinct nodes 
-        Node<dType, T2>* node1, * node2;
-        node1 = getRandomNode(true, true);
-        if (node1 == nullptr)
-            return;
-        while (true) {
-            node2 = getRandomNode(true, true);
-            if (node2 == nullptr)
+        if (!materialized.load(std::memory_order_acquire)) {
+            const FlatGenome<dType, T2>& genes = *sharedFlatGenome;
+            const std::uint32_t node1 = getRandomFlatNode(true, false);
+            const std::uint32_t node2 = getRandomFlatNode(false, true);
+            if (node1 == FlatGenome<dType, T2>::NOT_FOUND || node2 == FlatGenome<dType, T2>::NOT_FOUND || node1 == node2)
                 return;
-            if (node1 != node2 && node1->getLayer() != node2->getLayer()) break;
-        }
-        // make sure node1 is the node with the smaller layer
-        if (node1->getLayer() > node2->getLayer()) {
-            Node<dType, T2>* temp = node1;
-            node1 = node2;
-            node2 = temp;
+            for (std::uint32_t i = 0; i < genes.getEdgeCount(); i++) {
+                if (genes.getEdgeFrom()[i] == node1 && genes.getEdgeTo()[i] == node2) return;
+            }
+            if (genes.hasPath(node2, node1))
+                return;
+            const T2 innovationNumber = GeneHistory.addEdge(genes.getNodeIds()[node1], genes.getNodeIds()[node2]);
+            const dType weight = gaussianDistribution<dType>(0, 1);
+            FlatGenome<dType, T2>& edited = editFlatGenome();
+            edited.orderEdge(node1, node2);
+            edited.insertEdge(innovationNumber, node1, node2, weight, true);
+            return;
         }
+        if (!topologicalOrderValid) buildTopologicalOrder();
+        // 1. select a source that is not an output and a distinct target that is not an input
+        Node<dType, T2>* node1 = getRandomNode(true, false);
+        Node<dType, T2>* node2 = getRandomNode(false, true);
+        if (node1 == nullptr || node2 == nullptr || node1 == node2)
+            return;
         // 2. check if the edge already exists, if exists return
         for (const Edge<dType, T2>* edge : node1->getOutgoingEdges()) {
             if (edge->getTo(this) == node2) {
                 return;
             }
         }
-        // 3. add the edge to the genome
+        // 3. any edge that keeps the genome acyclic is allowed, the topological order is repaired locally
+        if (!insertTopologicalEdge(node1->getIndex(), node2->getIndex()))
+            return;
+        // 4. add the edge to the genome
         const T2 innovationNumber = GeneHistory.addEdge(node1->getId(), node2->getId());
         const dType weight = gaussianDistribution<dType>(0, 1);
         Edge<dType, T2>* newEdge = new Edge<dType, T2>(node1, node2, weight, innovationNumber);
@@ -118,11 +162,20 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::mutateToggleEdge() {
+        if (!materialized.load(std::memory_order_acquire)) {
+            const std::uint32_t edgeCount = sharedFlatGenome->getEdgeCount();
+            if (edgeCount == 0) return;
+            const std::uint32_t edge = static_cast<std::uint32_t>(uniformIntDistribution<T2>(0, static_cast<T2>(edgeCount - 1)));
+            FlatGenome<dType, T2>& edited = editFlatGenome();
+            edited.setEnabled(edge, !edited.isEnabled(edge));
+            return;
+        }
         Edge<dType, T2>* edge = getRandomEdge();
         if (edge == nullptr) {
             return;
         }
         edge->toggle();
+        invalidateCache();
     }
 
     template <typename dType, typename T2>
@@ -130,68 +183,121 @@ namespace NEAT {
         // TODO: extract sd to a configurable constant
         // TODO: allow small probability of assigning a random weight
         const dType sd = 0.001;
+        if (!materialized.load(std::memory_order_acquire)) {
+            const std::uint32_t edgeCount = sharedFlatGenome->getEdgeCount();
+            if (edgeCount == 0) return;
+            const std::uint32_t edge = static_cast<std::uint32_t>(uniformIntDistribution<T2>(0, static_cast<T2>(edgeCount - 1)));
+            const dType weight = sharedFlatGenome->getEdgeWeights()[edge] + gaussianDistribution<dType>(0, sd);
+            editFlatGenome().setEdgeWeight(edge, weight);
+            return;
+        }
         Edge<dType, T2>* edge = getRandomEdge();
         if (edge == nullptr) {
             return;
         }
         edge->setWeight(edge->getWeight() + gaussianDistribution<dType>(0, sd));
+        invalidateCache();
     }
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::mutateActivationFunction() {
+        if (!materialized.load(std::memory_order_acquire)) {
+            const std::uint32_t node = getRandomFlatNode(false, false);
+            if (node == FlatGenome<dType, T2>::NOT_FOUND) return;
+            const ActivationType activation = getActivationFunction_Factory<dType>()->getRandomActivationType_single();
+            editFlatGenome().setNodeActivation(node, activation);
+            return;
+        }
         Node<dType, T2>* node = getRandomNode(false, false);
         if (node == nullptr) {
             return;
         }
-        node->setActivationFunction(getActivationFunction_Factory<dType>()->getRandomActivationFunction_single());
+        node->setActivationType(getActivationFunction_Factory<dType>()->getRandomActivationType_single());
+        invalidateCache();
     }
 
     template <typename dType, typename T2>
     void Genome<dType, T2>::mutateBias() {
+        if (!materialized.load(std::memory_order_acquire)) {
+            const std::uint32_t node = getRandomFlatNode(false, true);
+            if (node == FlatGenome<dType, T2>::NOT_FOUND) return;
+            const dType bias = sharedFlatGenome->getNodeBiases()[node] + gaussianDistribution<dType>(0, 0.001);
+            editFlatGenome().setNodeBias(node, bias);
+            return;
+        }
         Node<dType, T2>* node = getRandomNode(false, true);
         if (node == nullptr) {
             return;
         }
         node->setBias(node->getBias() + gaussianDistribution<dType>(0, 0.001));
+        invalidateCache();
     }
 
     template <typename dType, typename T2>
     Edge<dType, T2>* Genome<dType, T2>::getRandomEdge() {
-        T2 i = uniformIntDistribution<T2>(0, static_cast<T2>(edges.size() - 1));
-        Edge<dType, T2>* edge = nullptr;
-        for (auto const& [key, val] : edges) {
-            if (i-- == 0)
-                edge = val;
+        if (edgeList.empty()) {
+            return nullptr;
         }
-        return edge;
+        const T2 i = uniformIntDistribution<T2>(0, static_cast<T2>(edgeList.size() - 1));
+        return edgeList[i];
     }
 
     template <typename dType, typename T2>
     Node<dType, T2>* Genome<dType, T2>::getRandomNode(bool allowInput, bool allowOutput) {
-        if (!allowInput && !allowOutput && static_cast<T2>(nodes.size()) == inputSize + outputSize) {
+        // index space is [hidden | input | output], disallowed lists take no space
+        const std::size_t hiddenCount = hiddenNodes.size();
+        const std::size_t inputCount = allowInput ? inputNodes.size() : 0;
+        const std::size_t outputCount = allowOutput ? outputNodes.size() : 0;
+        const std::size_t total = hiddenCount + inputCount + outputCount;
+        if (total == 0) {
             return nullptr;
         }
+        std::size_t i = static_cast<std::size_t>(uniformIntDistribution<T2>(0, static_cast<T2>(total - 1)));
+        if (i < hiddenCount) {
+            return hiddenNodes[i];
+        }
+        i -= hiddenCount;
+        if (i < inputCount) {
+            return inputNodes[i];
+        }
+        return outputNodes[i - inputCount];
+    }
 
-        while (true) {
-            T2 i = uniformIntDistribution<T2>(0, static_cast<T2>(nodes.size() - 1));
-            Node<dType, T2>* node = nullptr;
-            for (auto const& [key, val] : nodes) {
-                if (i-- == 0)
-                    node = val;
-            }
-            if (allowInput && node->getType() == NodeType::INPUT) {
-                return node;
-            }
-            if (allowOutput && node->getType() == NodeType::OUTPUT) {
-                return node;
-            }
-            if (node->getType() == NodeType::HIDDEN) {
-                return node;
+    template <typename dType, typename T2>
+    std::uint32_t Genome<dType, T2>::getRandomFlatNode(bool allowInput, bool allowOutput) const {
+        const std::vector<NodeType>& types = sharedFlatGenome->getNodeTypes();
+        std::size_t hiddenCount = 0, inputCount = 0, outputCount = 0;
+        for (const NodeType type : types) {
+            if (type == NodeType::HIDDEN) hiddenCount++;
+            else if (type == NodeType::INPUT) inputCount++;
+            else if (type == NodeType::OUTPUT) outputCount++;
+        }
+        if (!allowInput) inputCount = 0;
+        if (!allowOutput) outputCount = 0;
+        const std::size_t total = hiddenCount + inputCount + outputCount;
+        if (total == 0) {
+            return FlatGenome<dType, T2>::NOT_FOUND;
+        }
+        // index space is [hidden | input | output], the i-th node of the selected type is searched
+        std::size_t i = static_cast<std::size_t>(uniformIntDistribution<T2>(0, static_cast<T2>(total - 1)));
+        NodeType selected = NodeType::HIDDEN;
+        if (i >= hiddenCount) {
+            i -= hiddenCount;
+            selected = NodeType::INPUT;
+            if (i >= inputCount) {
+                i -= inputCount;
+                selected = NodeType::OUTPUT;
             }
         }
+        for (std::uint32_t node = 0; node < types.size(); node++) {
+            if (types[node] == selected && i-- == 0) return node;
+        }
+        return FlatGenome<dType, T2>::NOT_FOUND;
     }
 
     // Explicit instantiation
     template class Genome<double, int>;
     template class Genome<double, long>;
+    template class Genome<float, int>;
+    template class Genome<float, long>;
 }
@@ -0,0 +1,432 @@
+#include <cmath>
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <limits>
+#include <sstream>
+#include <fstream>
+#include <cstdlib>
+#include <stdexcept>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <unistd.h>
+#define NEAT_NATIVE_CODE
+#endif
+
+#include "../include/NEAT/NativeGenome.hpp"
+#include "../include/NEAT/Genome.hpp"
+
+namespace NEAT {
+
+    namespace {
+        // symbol of the forward pass in every generated shared object
+        const char* const FUNCTION_NAME = "neat_forward";
+
+        // guards the settings and maps below, never held while the compiler runs
+        std::mutex cacheMutex;
+        std::string compiler;
+        std::string directory;
+        // result of probing each compiler command
+        std::map<std::string, bool> compilerAvailable;
+        // objects loaded by this process, by name
+        std::map<std::string, std::weak_ptr<void>> loaded;
+        // names being compiled or loaded by a thread of this process, other threads wait for them
+        std::set<std::string> pending;
+        std::condition_variable pendingDone;
+
+        template <typename dType>
+        const char* typeName();
+
+        template <>
+        const char* typeName<double>() {
+            return "double";
+        }
+
+        template <>
+        const char* typeName<float>() {
+            return "float";
+        }
+
+        /**
+         * @brief Exact C++ literal of a value
+         *
+         */
+        template <typename dType>
+        std::string literal(dType value) {
+            const std::string type = typeName<dType>();
+            if (std::isnan(value)) return "(" + type + ")NAN";
+            if (std::isinf(value)) return value > 0 ? "(" + type + ")INFINITY" : "(" + type + ")-INFINITY";
+            std::ostringstream stream;
+            stream << std::hexfloat << value;
+            if (std::is_same<dType, float>::value) stream << 'f';
+            return stream.str();
+        }
+
+        std::string hex(std::size_t value) {
+            std::ostringstream stream;
+            stream << std::hex << value;
+            return stream.str();
+        }
+
+        std::string resolveCompiler() {
+            if (!compiler.empty()) return compiler;
+            const char* environment = std::getenv("CXX");
+            return (environment != nullptr && *environment != '\0') ? environment : "c++";
+        }
+
+        std::filesystem::path resolveDirectory() {
+            if (!directory.empty()) return directory;
+            std::error_code error;
+            const std::filesystem::path temporary = std::filesystem::temp_directory_path(error);
+            return (error ? std::filesystem::path(".") : temporary) / "neatcpy-native";
+        }
+
+        /**
+         * @brief Check if a compiler command runs, called without holding cacheMutex
+         *
+         */
+        bool probeCompiler(const std::string& command) {
+#ifdef NEAT_NATIVE_CODE
+            {
+                std::lock_guard<std::mutex> lock(cacheMutex);
+                const auto it = compilerAvailable.find(command);
+                if (it != compilerAvailable.end()) return it->second;
+            }
+            const bool available = std::system((command + " --version > /dev/null 2>&1").c_str()) == 0;
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            compilerAvailable[command] = available;
+            return available;
+#else
+            (void)command;
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Quote a word for the shell, embedded single quotes included
+         *
+         */
+        std::string shellQuote(const std::string& word) {
+            std::string quoted = "'";
+            for (char c : word) {
+                if (c == '\'') quoted += "'\\''";
+                else quoted += c;
+            }
+            return quoted + "'";
+        }
+
+        std::string readFile(const std::filesystem::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            std::ostringstream content;
+            content << file.rdbuf();
+            return file ? content.str() : std::string();
+        }
+
+        /**
+         * @brief Compile a source unless its shared object is on disk, and open it, called without holding cacheMutex
+         *
+         */
+        std::shared_ptr<void> compileAndLoad(const std::string& source, const std::string& name, const std::string& command, const std::filesystem::path& root) {
+#ifdef NEAT_NATIVE_CODE
+            // 1. compiled before, the source is written after its shared object is complete
+            std::error_code error;
+            const std::filesystem::path sourcePath = root / (name + ".cpp");
+            const std::filesystem::path libraryPath = root / (name + ".so");
+            if (!std::filesystem::exists(libraryPath, error) || readFile(sourcePath) != source) {
+                // 2. compile under names unique to this process and move into place
+                if (!probeCompiler(command)) return nullptr;
+                std::filesystem::create_directories(root, error);
+                static std::atomic<unsigned long> counter(0);
+                const std::string suffix = "." + std::to_string(getpid()) + "." + std::to_string(counter++);
+                const std::filesystem::path temporarySource = root / (name + suffix + ".cpp");
+                const std::filesystem::path temporaryLibrary = root / (name + suffix + ".so");
+                {
+                    std::ofstream file(temporarySource, std::ios::binary);
+                    file << source;
+                    if (!file) return nullptr;
+                }
+                const std::string commandLine = command + " -O2 -shared -fPIC -ffp-contract=off -o " + shellQuote(temporaryLibrary.string()) +
+                    " " + shellQuote(temporarySource.string()) + " > /dev/null 2>&1";
+                const bool compiled = std::system(commandLine.c_str()) == 0;
+                if (compiled) {
+                    std::filesystem::rename(temporaryLibrary, libraryPath, error);
+                    if (!error) std::filesystem::rename(temporarySource, sourcePath, error);
+                }
+                std::filesystem::remove(temporarySource, error);
+                std::filesystem::remove(temporaryLibrary, error);
+                if (!compiled || !std::filesystem::exists(libraryPath, error)) return nullptr;
+            }
+            void* handle = dlopen(libraryPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (handle == nullptr) return nullptr;
+            return std::shared_ptr<void>(handle, [](void* h) { dlclose(h); });
+#else
+            (void)source;
+            (void)name;
+            (void)command;
+            (void)root;
+            return nullptr;
+#endif
+        }
+    }
+
+    void NativeCodeCache::setCompiler(const std::string& command) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        compiler = command;
+    }
+
+    std::string NativeCodeCache::getCompiler() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return resolveCompiler();
+    }
+
+    void NativeCodeCache::setDirectory(const std::string& path) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        directory = path;
+    }
+
+    std::string NativeCodeCache::getDirectory() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return resolveDirectory().string();
+    }
+
+    bool NativeCodeCache::isAvailable() {
+        return probeCompiler(getCompiler());
+    }
+
+    std::shared_ptr<void> NativeCodeCache::load(const std::string& source, const std::string& name) {
+#ifdef NEAT_NATIVE_CODE
+        std::unique_lock<std::mutex> lock(cacheMutex);
+        // 1. loaded by this process, or being loaded by another thread
+        for (;;) {
+            const auto it = loaded.find(name);
+            if (it != loaded.end()) {
+                std::shared_ptr<void> library = it->second.lock();
+                if (library != nullptr) return library;
+            }
+            if (pending.count(name) == 0) break;
+            pendingDone.wait(lock);
+        }
+        // claim the name, the compiler runs without the lock
+        pending.insert(name);
+        const std::string command = resolveCompiler();
+        const std::filesystem::path root = resolveDirectory();
+        lock.unlock();
+        std::shared_ptr<void> library;
+        try {
+            library = compileAndLoad(source, name, command, root);
+        } catch (...) {
+            lock.lock();
+            pending.erase(name);
+            pendingDone.notify_all();
+            throw;
+        }
+        lock.lock();
+        pending.erase(name);
+        if (library != nullptr) loaded[name] = library;
+        pendingDone.notify_all();
+        return library;
+#else
+        (void)source;
+        (void)name;
+        return nullptr;
+#endif
+    }
+
+    void* NativeCodeCache::getSymbol(const std::shared_ptr<void>& library, const char* symbol) {
+#ifdef NEAT_NATIVE_CODE
+        return library != nullptr ? dlsym(library.get(), symbol) : nullptr;
+#else
+        (void)library;
+        (void)symbol;
+        return nullptr;
+#endif
+    }
+
+    template <typename dType, typename T2>
+    NativeGenome<dType, T2>::NativeGenome(const Genome<dType, T2>& genome) : NativeGenome(genome.getSharedExecutionPlan()) {}
+
+    template <typename dType, typename T2>
+    NativeGenome<dType, T2>::NativeGenome(const std::shared_ptr<const ExecutionPlan<dType, T2>>& plan) : plan(plan) {
+        if (plan == nullptr) {
+            throw std::invalid_argument("NativeGenome<dType, T2>::NativeGenome - plan is null");
+        }
+        for (ActivationType type : plan->getActivations()) {
+            if (type >= ActivationType::USER_DEFINED) return;
+        }
+        const std::string source = generateSource(*plan, FUNCTION_NAME);
+        // the structure hash groups the objects of one topology, the source hash tells weights and biases apart
+        const std::string name = "neat_" + hex(plan->getStructureHash()) + "_" + hex(std::hash<std::string>()(source)) + "_" + typeName<dType>();
+        library = NativeCodeCache::load(source, name);
+        function = reinterpret_cast<Function>(NativeCodeCache::getSymbol(library, FUNCTION_NAME));
+        batchFunction = reinterpret_cast<BatchFunction>(NativeCodeCache::getSymbol(library, (std::string(FUNCTION_NAME) + "_batch").c_str()));
+        if (function == nullptr || batchFunction == nullptr) {
+            function = nullptr;
+            batchFunction = nullptr;
+            library = nullptr;
+        }
+    }
+
+    template <typename dType, typename T2>
+    void NativeGenome<dType, T2>::evaluate(const dType* inputs, dType* outputs) const {
+        if (function != nullptr) {
+            function(inputs, outputs);
+            return;
+        }
+        thread_local ActivationWorkspace<dType> workspace;
+        plan->evaluate(inputs, outputs, workspace);
+    }
+
+    template <typename dType, typename T2>
+    void NativeGenome<dType, T2>::evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs) const {
+        if (batchFunction != nullptr) {
+            batchFunction(inputs, rows, outputs);
+            return;
+        }
+        thread_local ActivationWorkspace<dType> workspace;
+        plan->evaluateBatch(inputs, rows, outputs, workspace);
+    }
+
+    template <typename dType, typename T2>
+    std::vector<dType> NativeGenome<dType, T2>::feedForward(const std::vector<dType>& inputs) const {
+        if (static_cast<T2>(inputs.size()) != plan->getInputSize()) {
+            throw std::invalid_argument("NativeGenome<dType, T2>::feedForward - input size does not match");
+        }
+        std::vector<dType> outputs(plan->getOutputSize());
+        evaluate(inputs.data(), outputs.data());
+        return outputs;
+    }
+
+    template <typename dType, typename T2>
+    T2 NativeGenome<dType, T2>::predict(const std::vector<dType>& inputs) const {
+        const std::vector<dType> outputs = feedForward(inputs);
+        T2 maxIndex = 0;
+        for (T2 i = 0; i < plan->getOutputSize(); i++) {
+            if (outputs[i] > outputs[maxIndex]) {
+                maxIndex = i;
+            }
+        }
+        return maxIndex;
+    }
+
+    template <typename dType, typename T2>
+    bool NativeGenome<dType, T2>::isNative() const {
+        return function != nullptr;
+    }
+
+    template <typename dType, typename T2>
+    const T2& NativeGenome<dType, T2>::getInputSize() const {
+        return plan->getInputSize();
+    }
+
+    template <typename dType, typename T2>
+    const T2& NativeGenome<dType, T2>::getOutputSize() const {
+        return plan->getOutputSize();
+    }
+
+    template <typename dType, typename T2>
+    std::string NativeGenome<dType, T2>::generateSource(const ExecutionPlan<dType, T2>& plan, const std::string& functionName) {
+        const std::uint32_t nodeCount = plan.getNodeCount();
+        const std::vector<dType>& biases = plan.getBiases();
+        const std::vector<ActivationType>& activations = plan.getActivations();
+        const std::vector<std::uint32_t>& edgeOffsets = plan.getEdgeOffsets();
+        const std::vector<std::uint32_t>& edgeSources = plan.getEdgeSources();
+        const std::vector<dType>& edgeWeights = plan.getEdgeWeights();
+        const std::vector<std::uint32_t>& inputSlots = plan.getInputSlots();
+        const std::vector<std::uint32_t>& outputSlots = plan.getOutputSlots();
+        const std::string type = typeName<dType>();
+        // 1. slots an output depends on, edges of weight 0 count as 0 * inf and 0 * NaN are NaN
+        std::vector<bool> live(nodeCount, false);
+        for (std::uint32_t slot : outputSlots) {
+            live[slot] = true;
+        }
+        for (std::uint32_t slot = nodeCount; slot-- > 0;) {
+            if (!live[slot]) continue;
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                live[edgeSources[e]] = true;
+            }
+        }
+        std::vector<std::int64_t> inputOf(nodeCount, -1);
+        for (std::size_t i = 0; i < inputSlots.size(); i++) {
+            inputOf[inputSlots[i]] = static_cast<std::int64_t>(i);
+        }
+        // 2. straight-line code of the live slots, slots with constant sources are evaluated here
+        std::vector<bool> constant(nodeCount, false);
+        std::vector<dType> values(nodeCount, 0);
+        std::ostringstream body;
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            if (!live[slot]) continue;
+            const std::string name = "v" + std::to_string(slot);
+            bool folded = inputOf[slot] < 0;
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1] && folded; e++) {
+                folded = constant[edgeSources[e]];
+            }
+            if (folded) {
+                // same operations in the same order as ExecutionPlan::evaluate
+                dType sum = 0 + biases[slot];
+                for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                    sum += edgeWeights[e] * values[edgeSources[e]];
+                }
+                values[slot] = applyActivation(activations[slot], sum);
+                constant[slot] = true;
+                continue;
+            }
+            if (inputOf[slot] >= 0) {
+                body << "    " << type << " " << name << " = inputs[" << inputOf[slot] << "] + " << literal(biases[slot]) << ";\n";
+            } else {
+                body << "    " << type << " " << name << " = " << literal(static_cast<dType>(0 + biases[slot])) << ";\n";
+            }
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                const dType weight = edgeWeights[e];
+                const std::uint32_t source = edgeSources[e];
+                if (constant[source]) {
+                    body << "    " << name << " += " << literal(static_cast<dType>(weight * values[source])) << ";\n";
+                } else if (weight == 1) {
+                    body << "    " << name << " += v" << source << ";\n";
+                } else if (weight == -1) {
+                    body << "    " << name << " -= v" << source << ";\n";
+                } else {
+                    body << "    " << name << " += " << literal(weight) << " * v" << source << ";\n";
+                }
+            }
+            switch (activations[slot]) {
+            case ActivationType::SIGMOID: body << "    " << name << " = 1 / (1 + exp(-" << name << "));\n"; break;
+            case ActivationType::TANH: body << "    " << name << " = tanh(" << name << ");\n"; break;
+            case ActivationType::RELU: body << "    " << name << " = " << name << " > 0 ? " << name << " : 0;\n"; break;
+            case ActivationType::STEP: body << "    " << name << " = " << name << " > 0 ? 1 : 0;\n"; break;
+            case ActivationType::IDENTITY: break;
+            default:
+                throw std::invalid_argument("NativeGenome<dType, T2>::generateSource - user-defined activation functions cannot be generated");
+            }
+        }
+        for (std::size_t i = 0; i < outputSlots.size(); i++) {
+            const std::uint32_t slot = outputSlots[i];
+            body << "    outputs[" << i << "] = " << (constant[slot] ? literal(values[slot]) : "v" + std::to_string(slot)) << ";\n";
+        }
+        // 3. translation unit
+        std::ostringstream source;
+        source << "// generated by NEAT::NativeGenome, " << nodeCount << " slots, " << plan.getEdgeCount() << " edges\n"
+            << "#include <math.h>\n"
+            << "#include <stddef.h>\n\n"
+            << "extern \"C\" void " << functionName << "(const " << type << "* inputs, " << type << "* outputs) {\n"
+            << body.str()
+            << "}\n\n"
+            << "extern \"C\" void " << functionName << "_batch(const " << type << "* inputs, size_t rows, " << type << "* outputs) {\n"
+            << "    for (size_t r = 0; r < rows; r++) {\n"
+            << "        " << functionName << "(inputs + r * " << inputSlots.size() << ", outputs + r * " << outputSlots.size() << ");\n"
+            << "    }\n"
+            << "}\n";
+        return source.str();
+    }
+
+    // Explicit instantiation
+    template class NativeGenome<double, int>;
+    template class NativeGenome<double, long>;
+    template class NativeGenome<float, int>;
+    template class NativeGenome<float, long>;
+}
@@ -9,14 +9,13 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     Node<dType, T2>::Node() : value(0), bias(0), nodeType(NodeType::UNKNOWN), layer(-1), visited(false) {
-        this->activationFunction = nullptr;
         this->incoming_edges = std::vector<Edge<dType, T2>*>();
         this->outgoing_edges = std::vector<Edge<dType, T2>*>();
     }
 
     template <typename dType, typename T2>
-    Node<dType, T2>::Node(T2 id, NodeType type, int layer, dType bias, ActivationFunction<dType>* activationFunction) :
-        value(0), bias(bias), id(id), nodeType(type), layer(layer), activationFunction(activationFunction)
+    Node<dType, T2>::Node(T2 id, NodeType type, int layer, dType bias, ActivationType activationType) :
+        value(0), bias(bias), id(id), nodeType(type), layer(layer), activationType(activationType)
         // , state(NodeState::FULLY_INITIALIZED) 
     {
         this->incoming_edges = std::vector<Edge<dType, T2>*>();
@@ -43,6 +42,16 @@ namespace NEAT {
         this->layer = layer;
     }
 
+    template <typename dType, typename T2>
+    const std::uint32_t& Node<dType, T2>::getIndex() const {
+        return index;
+    }
+
+    template <typename dType, typename T2>
+    void Node<dType, T2>::setIndex(std::uint32_t index) {
+        this->index = index;
+    }
+
     template <typename dType, typename T2>
     void Node<dType, T2>::reset() {
         this->value = 0;
@@ -80,17 +89,13 @@ namespace NEAT {
     }
 
     template <typename dType, typename T2>
-    ActivationFunction<dType>* Node<dType, T2>::getActivationFunction() const {
-        return activationFunction;
+    ActivationType Node<dType, T2>::getActivationType() const {
+        return activationType;
     }
 
     template <typename dType, typename T2>
     void Node<dType, T2>::forwardPropagate(const Genome<dType, T2>* genome) {
-        if (dynamic_cast<ActivationFunction_Single<dType>*>(this->activationFunction) != nullptr) {
-            this->value = (*(
-                dynamic_cast<ActivationFunction_Single<dType>*>(this->activationFunction)
-                ))(this->value + this->bias);
-        }
+        this->value = applyActivation(this->activationType, this->value + this->bias);
         if (this->nodeType == NodeType::OUTPUT) {
             return;
         }
@@ -101,7 +106,7 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     Node<dType, T2>* Node<dType, T2>::clone() const {
-        Node<dType, T2>* newNode = new Node<dType, T2>(id, nodeType, layer, bias, activationFunction);
+        Node<dType, T2>* newNode = new Node<dType, T2>(id, nodeType, layer, bias, activationType);
         newNode->value = value;
         // TODO: clone edges without duplicating them, possible get from a genome as a parameter input
         // for (const Edge<dType, T2>* edge : incoming_edges) {
@@ -145,8 +150,8 @@ namespace NEAT {
     }
 
     template <typename dType, typename T2>
-    void Node<dType, T2>::setActivationFunction(ActivationFunction<dType>* activationFunction) {
-        this->activationFunction = activationFunction;
+    void Node<dType, T2>::setActivationType(ActivationType activationType) {
+        this->activationType = activationType;
     }
 
     template <typename dType, typename T2>
@@ -200,4 +205,6 @@ namespace NEAT {
     // Explicitly instantiate
     template class Node<double, int>;
     template class Node<double, long>;
+    template class Node<float, int>;
+    template class Node<float, long>;
 }
@@ -1,22 +1,31 @@
 #include <iostream>
+#include <stdexcept>
+#include <unordered_map>
 
 #include "../include/NEAT/Population.hpp"
 #include "../include/NEAT/SpeciesHandler.hpp"
 #include "../include/NEAT/Species.hpp"
 #include "../include/NEAT/GeneHistory.hpp"
+#include "../include/NEAT/ThreadPool.hpp"
+#include "../include/NEAT/GeneArena.hpp"
 #include "../include/NEAT/Helper.hpp"
 
 namespace NEAT {
     template <typename dType, typename T2>
     Population<dType, T2>::Population(T2 inputSize, T2 outputSize, T2 populationSize, MutationConfig<dType> mutationConfig, SpeciesConfig<dType> speciesConfig) :
         inputSize(inputSize), outputSize(outputSize), populationSize(populationSize), mutationConfig(mutationConfig), speciesConfig(speciesConfig) {
+        geneArena = new GeneArena();
         genomes.reserve(populationSize);
-        for (T2 i = 0; i < populationSize; i++) {
-            genomes.push_back(new Genome<dType, T2>(inputSize, outputSize, true));
+        {
+            GeneArenaScope arenaScope(geneArena);
+            for (T2 i = 0; i < populationSize; i++) {
+                genomes.push_back(new Genome<dType, T2>(inputSize, outputSize, true));
+            }
         }
         generation = 0;
-        GeneHistory<dType, T2> geneHistory = GeneHistory<dType, T2>();
-        geneHistory.init(inputSize, outputSize);
+        speciesHandler = new SpeciesHandler<dType, T2>(speciesConfig);
+        geneHistory = new GeneHistory<dType, T2>();
+        geneHistory->init(inputSize, outputSize);
     }
 
     template <typename dType, typename T2>
@@ -27,6 +36,11 @@ namespace NEAT {
         for (Genome<dType, T2>* genome : bestGenomeHistory) {
             delete genome;
         }
+        delete speciesHandler;
+        delete geneHistory;
+        delete threadPool;
+        delete populationGraph;
+        geneArena->release();
     }
 
     template <typename dType, typename T2>
@@ -48,11 +62,10 @@ namespace NEAT {
     const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(T2 populationSize) {
         if (populationSize < 1)
             throw std::invalid_argument("Population<dType, T2>::startNextGeneration(T2 populationSize) - populationSize < 1");
-        // start next generation
-        SpeciesHandler<dType, T2>* speciesHandler = new SpeciesHandler<dType, T2>(genomes, speciesConfig);
-        // get next generation
-        std::vector<Genome<dType, T2>*> nextGeneration = speciesHandler->reproduce(populationSize, mutationConfig);
-        // get best fitness, worst fitness and average fitness
+        // sort genomes into the species kept from the last generation
+        ThreadPool* speciesPool = (speciesConfig.numThreads == 1) ? nullptr : &getThreadPool(speciesConfig.numThreads);
+        speciesHandler->speciate(genomes, speciesPool);
+        // get best fitness, worst fitness and average fitness, before fitness sharing changes the fitness
         const Genome<dType, T2>* bestGenome = genomes[0];
         dType bestFitness = genomes[0]->getFitness();
         dType worstFitness = genomes[0]->getFitness();
@@ -76,15 +89,26 @@ namespace NEAT {
         worstFitnessHistory.push_back(worstFitness);
         averageFitnessHistory.push_back(averageFitness);
         bestGenomeHistory.push_back(bestGenomeClone);
+        // get next generation
+        geneHistory->setGeneration(generation);
+        GeneArena* nextArena = new GeneArena();
+        std::vector<Genome<dType, T2>*> nextGeneration;
+        {
+            GeneArenaScope arenaScope(nextArena);
+            nextGeneration = speciesHandler->reproduce(populationSize, mutationConfig, *geneHistory, generation, speciesPool);
+        }
+        geneHistory->expire(static_cast<T2>(mutationConfig.innovationMaxAge));
+        speciesHandler->clearGenomes();
         // delete old genomes
         for (Genome<dType, T2>* genome : genomes) {
             delete genome;
         }
         genomes.clear();
+        // the arena of the old generation is freed in one step, unless genes of it are still referenced elsewhere
+        geneArena->release();
+        geneArena = nextArena;
         // set new genomes
         genomes = nextGeneration;
-        // delete species handler
-        delete speciesHandler;
         // update generation
         generation++;
         // return genomes
@@ -92,17 +116,27 @@ namespace NEAT {
     }
 
     template <typename dType, typename T2>
-    const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(std::vector<dType> fitnesses) {
-        return startNextGeneration(populationSize, fitnesses);
+    const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(const std::vector<dType>& fitnesses) {
+        return startNextGeneration(populationSize, fitnesses.data(), fitnesses.size());
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(T2 populationSize, const std::vector<dType>& fitnesses) {
+        return startNextGeneration(populationSize, fitnesses.data(), fitnesses.size());
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(const dType* fitnesses, std::size_t count) {
+        return startNextGeneration(populationSize, fitnesses, count);
     }
 
     template <typename dType, typename T2>
-    const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(T2 populationSize, std::vector<dType> fitnesses) {
-        if (static_cast<T2>(fitnesses.size()) < populationSize) {
-            throw std::invalid_argument("Population<dType, T2>::startNextGeneration(std::vector<dType> fitnesses) - fitnesses.size() < populationSize");
+    const std::vector<Genome<dType, T2>*>& Population<dType, T2>::startNextGeneration(T2 populationSize, const dType* fitnesses, std::size_t count) {
+        if (static_cast<T2>(count) < populationSize) {
+            throw std::invalid_argument("Population<dType, T2>::startNextGeneration(fitnesses) - fitnesses.size() < populationSize");
         }
-        if (static_cast<T2>(fitnesses.size()) > populationSize) {
-            std::cout << "WARN: Population<dType, T2>::startNextGeneration(std::vector<dType> fitnesses) - fitnesses.size() > populationSize" << std::endl;
+        if (static_cast<T2>(count) > populationSize) {
+            std::cout << "WARN: Population<dType, T2>::startNextGeneration(fitnesses) - fitnesses.size() > populationSize" << std::endl;
         }
         for (T2 i = 0; i < populationSize; i++) {
             genomes[i]->setFitness(fitnesses[i]);
@@ -110,6 +144,258 @@ namespace NEAT {
         return startNextGeneration(populationSize);
     }
 
+    template <typename dType, typename T2>
+    void Population<dType, T2>::evaluate(const std::function<dType(Genome<dType, T2>&)>& fitnessFunction, unsigned int numThreads) {
+        getThreadPool(numThreads).parallelFor(genomes.size(), [this, &fitnessFunction](std::size_t i, unsigned int) {
+            Genome<dType, T2>* genome = genomes[i];
+            genome->setFitness(fitnessFunction(*genome));
+            });
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::evaluateSupervised(const std::vector<dType>& inputs, const std::vector<dType>& targets, unsigned int numThreads) {
+        if (inputs.size() % inputSize != 0) {
+            throw std::invalid_argument("Population<dType, T2>::evaluateSupervised - inputs.size() is not a multiple of inputSize");
+        }
+        const std::size_t rows = inputs.size() / inputSize;
+        if (targets.size() != rows * outputSize) {
+            throw std::invalid_argument("Population<dType, T2>::evaluateSupervised - targets.size() != rows * outputSize");
+        }
+        evaluateSupervised(inputs.data(), targets.data(), rows, numThreads);
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::evaluateSupervised(const dType* inputs, const dType* targets, std::size_t rows, unsigned int numThreads) {
+        const std::size_t targetCount = rows * static_cast<std::size_t>(outputSize);
+        ThreadPool& pool = getThreadPool(numThreads);
+        const auto fitnessOf = [targets, targetCount](const dType* outputs) {
+            dType squaredError = 0;
+            for (std::size_t j = 0; j < targetCount; j++) {
+                squaredError += (outputs[j] - targets[j]) * (outputs[j] - targets[j]);
+            }
+            const dType meanSquaredError = (targetCount == 0) ? 0 : squaredError / targetCount;
+            return 1 / (1 + meanSquaredError);
+            };
+        // one workspace per thread instead of a batch sized buffer per genome
+        std::vector<ActivationWorkspace<dType>> workspaces(pool.getNumThreads());
+        if (evaluationMode == EvaluationMode::POPULATION_GRAPH) {
+            // the rows are evaluated in blocks, the buffers of one block hold every genome
+            const PopulationGraph<dType, T2>& graph = getPopulationGraph(pool);
+            const std::size_t outputCount = static_cast<std::size_t>(outputSize);
+            const std::size_t blockRows = std::min(rows, GRAPH_BLOCK_ROWS);
+            std::vector<dType> outputs(genomes.size() * blockRows * outputCount);
+            std::vector<dType> squaredErrors(genomes.size(), 0);
+            for (std::size_t first = 0; first < rows; first += blockRows) {
+                const std::size_t count = std::min(blockRows, rows - first);
+                graph.evaluateBatch(inputs + first * static_cast<std::size_t>(inputSize), count, outputs.data(), workspaces[0], &pool);
+                const dType* blockTargets = targets + first * outputCount;
+                pool.parallelFor(genomes.size(), [&](std::size_t i, unsigned int) {
+                    const dType* genomeOutputs = outputs.data() + i * count * outputCount;
+                    for (std::size_t j = 0; j < count * outputCount; j++) {
+                        squaredErrors[i] += (genomeOutputs[j] - blockTargets[j]) * (genomeOutputs[j] - blockTargets[j]);
+                    }
+                    });
+            }
+            for (std::size_t i = 0; i < genomes.size(); i++) {
+                const dType meanSquaredError = (targetCount == 0) ? 0 : squaredErrors[i] / targetCount;
+                genomes[i]->setFitness(1 / (1 + meanSquaredError));
+            }
+            return;
+        }
+        if (evaluationMode == EvaluationMode::GENOME || rows > MAX_GROUPED_ROWS) {
+            std::vector<std::vector<dType>> outputBuffers(pool.getNumThreads(), std::vector<dType>(targetCount));
+            pool.parallelFor(genomes.size(), [&](std::size_t i, unsigned int thread) {
+                std::vector<dType>& outputs = outputBuffers[thread];
+                genomes[i]->feedForwardBatch(inputs, rows, outputs.data(), workspaces[thread]);
+                genomes[i]->setFitness(fitnessOf(outputs.data()));
+                });
+            return;
+        }
+        // few rows, genomes of equal structure are evaluated together
+        updateTopologyGroups(pool);
+        const std::size_t groupCount = topologyGroups.size();
+        std::vector<std::vector<dType>> outputBuffers(pool.getNumThreads(), std::vector<dType>(targetCount * MAX_GROUP_SIZE));
+        pool.parallelFor(groupCount + ungroupedGenomes.size(), [&](std::size_t i, unsigned int thread) {
+            std::vector<dType>& outputs = outputBuffers[thread];
+            if (i < groupCount) {
+                topologyGroups[i].evaluateBatch(inputs, rows, outputs.data(), workspaces[thread]);
+                const std::vector<std::size_t>& members = topologyGroupMembers[i];
+                for (std::size_t lane = 0; lane < members.size(); lane++) {
+                    genomes[members[lane]]->setFitness(fitnessOf(outputs.data() + lane * targetCount));
+                }
+                return;
+            }
+            const std::size_t genome = ungroupedGenomes[i - groupCount];
+            genomePlans[genome]->evaluateBatch(inputs, rows, outputs.data(), workspaces[thread]);
+            genomes[genome]->setFitness(fitnessOf(outputs.data()));
+            });
+    }
+
+    template <typename dType, typename T2>
+    std::vector<dType> Population<dType, T2>::step(const std::vector<dType>& observations, unsigned int numThreads) {
+        if (observations.size() != genomes.size() * static_cast<std::size_t>(inputSize)) {
+            throw std::invalid_argument("Population<dType, T2>::step - observations.size() != genomes * inputSize");
+        }
+        std::vector<dType> actions(genomes.size() * static_cast<std::size_t>(outputSize));
+        step(observations.data(), actions.data(), numThreads);
+        return actions;
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::step(const dType* observations, dType* actions, unsigned int numThreads) {
+        ThreadPool& pool = getStepThreadPool(numThreads);
+        const std::size_t inputCount = static_cast<std::size_t>(inputSize);
+        const std::size_t outputCount = static_cast<std::size_t>(outputSize);
+        if (evaluationMode == EvaluationMode::GENOME) {
+            pool.parallelFor(genomes.size(), [&](std::size_t i, unsigned int thread) {
+                genomes[i]->getExecutionPlan().evaluate(observations + i * inputCount, actions + i * outputCount, stepWorkspaces[thread]);
+                });
+            return;
+        }
+        if (evaluationMode == EvaluationMode::POPULATION_GRAPH) {
+            getPopulationGraph(pool).evaluate(observations, actions, stepWorkspaces[0], &pool);
+            return;
+        }
+        updateTopologyGroups(pool);
+        const std::size_t groupCount = topologyGroups.size();
+        pool.parallelFor(groupCount + ungroupedGenomes.size(), [&](std::size_t i, unsigned int thread) {
+            if (i < groupCount) {
+                topologyGroups[i].evaluate(observations, actions, topologyGroupMembers[i].data(), stepWorkspaces[thread]);
+                return;
+            }
+            const std::size_t genome = ungroupedGenomes[i - groupCount];
+            genomePlans[genome]->evaluate(observations + genome * inputCount, actions + genome * outputCount, stepWorkspaces[thread]);
+            });
+    }
+
+    template <typename dType, typename T2>
+    std::vector<T2> Population<dType, T2>::stepPredict(const std::vector<dType>& observations, unsigned int numThreads) {
+        if (observations.size() != genomes.size() * static_cast<std::size_t>(inputSize)) {
+            throw std::invalid_argument("Population<dType, T2>::stepPredict - observations.size() != genomes * inputSize");
+        }
+        std::vector<T2> actions(genomes.size());
+        stepPredict(observations.data(), actions.data(), numThreads);
+        return actions;
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::stepPredict(const dType* observations, T2* actions, unsigned int numThreads) {
+        stepActions.resize(genomes.size() * static_cast<std::size_t>(outputSize));
+        step(observations, stepActions.data(), numThreads);
+        for (std::size_t i = 0; i < genomes.size(); i++) {
+            const dType* outputs = stepActions.data() + i * static_cast<std::size_t>(outputSize);
+            T2 maxIndex = 0;
+            for (T2 j = 0; j < outputSize; j++) {
+                if (outputs[j] > outputs[maxIndex]) {
+                    maxIndex = j;
+                }
+            }
+            actions[i] = maxIndex;
+        }
+    }
+
+    template <typename dType, typename T2>
+    ThreadPool& Population<dType, T2>::getStepThreadPool(unsigned int numThreads) {
+        ThreadPool& pool = getThreadPool(numThreads);
+        if (stepWorkspaces.size() < pool.getNumThreads()) {
+            stepWorkspaces.resize(pool.getNumThreads());
+        }
+        return pool;
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::updateGenomePlans(ThreadPool& pool) {
+        bool current = genomePlans.size() == genomes.size();
+        for (std::size_t i = 0; current && i < genomes.size(); i++) {
+            current = genomePlans[i].get() == &genomes[i]->getExecutionPlan();
+        }
+        if (current) return;
+        // held plans stay alive, a changed genome can not get a new plan at the address of its held one
+        genomePlans.resize(genomes.size());
+        pool.parallelFor(genomes.size(), [this](std::size_t i, unsigned int) {
+            genomePlans[i] = genomes[i]->getSharedExecutionPlan();
+            });
+        topologyGroupsValid = false;
+        delete populationGraph;
+        populationGraph = nullptr;
+    }
+
+    template <typename dType, typename T2>
+    const PopulationGraph<dType, T2>& Population<dType, T2>::getPopulationGraph(ThreadPool& pool) {
+        updateGenomePlans(pool);
+        if (populationGraph == nullptr) {
+            populationGraph = new PopulationGraph<dType, T2>(genomePlans);
+        }
+        return *populationGraph;
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::setEvaluationMode(EvaluationMode evaluationMode) {
+        this->evaluationMode = evaluationMode;
+    }
+
+    template <typename dType, typename T2>
+    EvaluationMode Population<dType, T2>::getEvaluationMode() const {
+        return evaluationMode;
+    }
+
+    template <typename dType, typename T2>
+    void Population<dType, T2>::updateTopologyGroups(ThreadPool& pool) {
+        updateGenomePlans(pool);
+        if (topologyGroupsValid) return;
+        // classes of equal structure in order of their first genome, found by structure hash
+        std::vector<std::vector<std::size_t>> classes;
+        std::unordered_map<std::size_t, std::vector<std::size_t>> classesOfHash;
+        for (std::size_t i = 0; i < genomes.size(); i++) {
+            std::vector<std::size_t>& candidates = classesOfHash[genomePlans[i]->getStructureHash()];
+            std::size_t found = classes.size();
+            for (std::size_t candidate : candidates) {
+                if (genomePlans[classes[candidate][0]]->hasSameStructure(*genomePlans[i])) {
+                    found = candidate;
+                    break;
+                }
+            }
+            if (found == classes.size()) {
+                candidates.push_back(found);
+                classes.emplace_back();
+            }
+            classes[found].push_back(i);
+        }
+        // large classes are split into groups of about equal size, small ones are evaluated per genome
+        topologyGroups.clear();
+        topologyGroupMembers.clear();
+        ungroupedGenomes.clear();
+        std::vector<std::shared_ptr<const ExecutionPlan<dType, T2>>> plans;
+        for (const std::vector<std::size_t>& members : classes) {
+            if (members.size() < MIN_GROUP_SIZE) {
+                ungroupedGenomes.insert(ungroupedGenomes.end(), members.begin(), members.end());
+                continue;
+            }
+            const std::size_t groupCount = (members.size() + MAX_GROUP_SIZE - 1) / MAX_GROUP_SIZE;
+            for (std::size_t group = 0; group < groupCount; group++) {
+                const std::size_t begin = members.size() * group / groupCount;
+                const std::size_t end = members.size() * (group + 1) / groupCount;
+                topologyGroupMembers.emplace_back(members.begin() + begin, members.begin() + end);
+                plans.clear();
+                for (std::size_t i = begin; i < end; i++) {
+                    plans.push_back(genomePlans[members[i]]);
+                }
+                topologyGroups.emplace_back(plans);
+            }
+        }
+        topologyGroupsValid = true;
+    }
+
+    template <typename dType, typename T2>
+    ThreadPool& Population<dType, T2>::getThreadPool(unsigned int numThreads) {
+        numThreads = ThreadPool::resolveNumThreads(numThreads);
+        if (threadPool == nullptr || threadPool->getNumThreads() != numThreads) {
+            delete threadPool;
+            threadPool = new ThreadPool(numThreads);
+        }
+        return *threadPool;
+    }
+
     template <typename dType, typename T2>
     void Population<dType, T2>::setMutationConfig(MutationConfig<dType> mutationConfig) {
         this->mutationConfig = mutationConfig;
@@ -118,6 +404,7 @@ namespace NEAT {
     template <typename dType, typename T2>
     void Population<dType, T2>::setSpeciesConfig(SpeciesConfig<dType> speciesConfig) {
         this->speciesConfig = speciesConfig;
+        speciesHandler->setSpeciesConfig(speciesConfig);
     }
 
     template <typename dType, typename T2>
@@ -150,6 +437,16 @@ namespace NEAT {
         return speciesConfig;
     }
 
+    template <typename dType, typename T2>
+    GeneHistory<dType, T2>& Population<dType, T2>::getGeneHistory() {
+        return *geneHistory;
+    }
+
+    template <typename dType, typename T2>
+    T2 Population<dType, T2>::getNumberOfSpecies() const {
+        return static_cast<T2>(speciesHandler->getSpecies().size());
+    }
+
     template <typename dType, typename T2>
     const std::vector<dType>& Population<dType, T2>::getBestFitnessHistory() const {
         return bestFitnessHistory;
@@ -197,5 +494,7 @@ namespace NEAT {
     // Explicit instantiation
     template class Population<double, int>;
     template class Population<double, long>;
+    template class Population<float, int>;
+    template class Population<float, long>;
 
 }
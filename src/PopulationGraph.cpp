@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "../include/NEAT/PopulationGraph.hpp"
+#include "../include/NEAT/SimdKernels.hpp"
+#include "../include/NEAT/ThreadPool.hpp"
+
+namespace NEAT {
+
+    template <typename dType, typename T2>
+    PopulationGraph<dType, T2>::PopulationGraph(const std::vector<std::shared_ptr<const ExecutionPlan<dType, T2>>>& plans) :
+        genomeCount(plans.size()), inputSize(plans.empty() ? 0 : plans[0]->getInputSize()), outputSize(plans.empty() ? 0 : plans[0]->getOutputSize()) {
+        struct Entry {
+            std::uint32_t level;
+            ActivationType activation;
+            std::uint32_t node;
+        };
+        // 1. level of every slot of every plan, slots of a plan are numbered from its first node
+        std::vector<std::uint32_t> firstNode(genomeCount + 1, 0);
+        for (std::size_t g = 0; g < genomeCount; g++) {
+            if (plans[g]->getInputSize() != inputSize || plans[g]->getOutputSize() != outputSize) {
+                throw std::invalid_argument("PopulationGraph<dType, T2>::PopulationGraph - plans differ in input or output size");
+            }
+            firstNode[g + 1] = firstNode[g] + plans[g]->getNodeCount();
+        }
+        const std::uint32_t nodeCount = firstNode[genomeCount];
+        std::vector<Entry> entries;
+        entries.reserve(nodeCount);
+        std::vector<std::uint32_t> levels;
+        for (std::size_t g = 0; g < genomeCount; g++) {
+            const ExecutionPlan<dType, T2>& plan = *plans[g];
+            const std::vector<std::uint32_t>& offsets = plan.getEdgeOffsets();
+            const std::vector<std::uint32_t>& sources = plan.getEdgeSources();
+            levels.assign(plan.getNodeCount(), 0);
+            for (std::uint32_t slot = 0; slot < plan.getNodeCount(); slot++) {
+                for (std::uint32_t e = offsets[slot]; e < offsets[slot + 1]; e++) {
+                    levels[slot] = std::max(levels[slot], levels[sources[e]] + 1);
+                }
+                entries.push_back({ levels[slot], plan.getActivations()[slot], firstNode[g] + slot });
+            }
+        }
+        // 2. number nodes level by level, by activation function within a level, genome order breaks ties
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            if (a.level != b.level) return a.level < b.level;
+            return a.activation < b.activation;
+            });
+        std::vector<std::uint32_t> nodeOf(nodeCount);
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            nodeOf[entries[i].node] = i;
+        }
+        // 3. biases and incoming edges in the new numbering
+        biases.resize(nodeCount);
+        edgeOffsets.assign(nodeCount + 1, 0);
+        for (std::size_t g = 0; g < genomeCount; g++) {
+            const ExecutionPlan<dType, T2>& plan = *plans[g];
+            const std::vector<std::uint32_t>& offsets = plan.getEdgeOffsets();
+            for (std::uint32_t slot = 0; slot < plan.getNodeCount(); slot++) {
+                const std::uint32_t node = nodeOf[firstNode[g] + slot];
+                biases[node] = plan.getBiases()[slot];
+                edgeOffsets[node + 1] = offsets[slot + 1] - offsets[slot];
+            }
+        }
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            edgeOffsets[i + 1] += edgeOffsets[i];
+        }
+        edgeSources.resize(edgeOffsets[nodeCount]);
+        edgeWeights.resize(edgeOffsets[nodeCount]);
+        for (std::size_t g = 0; g < genomeCount; g++) {
+            const ExecutionPlan<dType, T2>& plan = *plans[g];
+            const std::vector<std::uint32_t>& offsets = plan.getEdgeOffsets();
+            for (std::uint32_t slot = 0; slot < plan.getNodeCount(); slot++) {
+                std::uint32_t cursor = edgeOffsets[nodeOf[firstNode[g] + slot]];
+                for (std::uint32_t e = offsets[slot]; e < offsets[slot + 1]; e++, cursor++) {
+                    edgeSources[cursor] = nodeOf[firstNode[g] + plan.getEdgeSources()[e]];
+                    edgeWeights[cursor] = plan.getEdgeWeights()[e];
+                }
+            }
+        }
+        // 4. segments of equal level and activation function, at most SEGMENT_SIZE nodes each
+        for (std::uint32_t i = 0; i < nodeCount; i++) {
+            const Entry& entry = entries[i];
+            if (i == 0 || entry.level != entries[i - 1].level) {
+                levelOffsets.push_back(static_cast<std::uint32_t>(segments.size()));
+            }
+            if (i == 0 || entry.level != entries[i - 1].level || entry.activation != segments.back().activation || i - segments.back().begin == SEGMENT_SIZE) {
+                segments.push_back({ i, i, entry.activation });
+            }
+            segments.back().end = i + 1;
+        }
+        levelOffsets.push_back(static_cast<std::uint32_t>(segments.size()));
+        // 5. inputs and outputs
+        inputNodes.reserve(genomeCount * static_cast<std::size_t>(inputSize));
+        outputNodes.reserve(genomeCount * static_cast<std::size_t>(outputSize));
+        for (std::size_t g = 0; g < genomeCount; g++) {
+            for (std::uint32_t slot : plans[g]->getInputSlots()) {
+                inputNodes.push_back(nodeOf[firstNode[g] + slot]);
+            }
+            for (std::uint32_t slot : plans[g]->getOutputSlots()) {
+                outputNodes.push_back(nodeOf[firstNode[g] + slot]);
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    void PopulationGraph<dType, T2>::evaluate(const dType* inputs, dType* outputs, ActivationWorkspace<dType>& workspace, ThreadPool* pool) const {
+        std::vector<dType>& values = workspace.values;
+        values.assign(getNodeCount(), 0);
+        for (std::size_t i = 0; i < inputNodes.size(); i++) {
+            values[inputNodes[i]] = inputs[i];
+        }
+        for (std::uint32_t level = 0; level < getLevelCount(); level++) {
+            const std::uint32_t firstSegment = levelOffsets[level];
+            const std::function<void(std::size_t, unsigned int)> task = [&](std::size_t index, unsigned int) {
+                const Segment& segment = segments[firstSegment + index];
+                for (std::uint32_t node = segment.begin; node < segment.end; node++) {
+                    dType sum = values[node] + biases[node];
+                    for (std::uint32_t e = edgeOffsets[node]; e < edgeOffsets[node + 1]; e++) {
+                        sum += edgeWeights[e] * values[edgeSources[e]];
+                    }
+                    values[node] = sum;
+                }
+                SimdKernels::activate(segment.activation, values.data() + segment.begin, segment.end - segment.begin);
+                };
+            const std::size_t segmentCount = levelOffsets[level + 1] - firstSegment;
+            if (pool != nullptr) {
+                pool->parallelFor(segmentCount, task);
+            } else {
+                for (std::size_t index = 0; index < segmentCount; index++) {
+                    task(index, 0);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < outputNodes.size(); i++) {
+            outputs[i] = values[outputNodes[i]];
+        }
+    }
+
+    template <typename dType, typename T2>
+    void PopulationGraph<dType, T2>::evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace, ThreadPool* pool) const {
+        const std::size_t inputCount = static_cast<std::size_t>(inputSize);
+        const std::size_t outputCount = static_cast<std::size_t>(outputSize);
+        // node values are node-major, the value of every node is a contiguous vector over the batch
+        std::vector<dType>& values = workspace.values;
+        values.assign(static_cast<std::size_t>(getNodeCount()) * rows, 0);
+        for (std::size_t i = 0; i < inputNodes.size(); i++) {
+            dType* target = values.data() + static_cast<std::size_t>(inputNodes[i]) * rows;
+            for (std::size_t r = 0; r < rows; r++) {
+                target[r] = inputs[r * inputCount + i % inputCount];
+            }
+        }
+        for (std::uint32_t level = 0; level < getLevelCount(); level++) {
+            const std::uint32_t firstSegment = levelOffsets[level];
+            const std::function<void(std::size_t, unsigned int)> task = [&](std::size_t index, unsigned int) {
+                thread_local std::vector<const dType*> sources;
+                const Segment& segment = segments[firstSegment + index];
+                for (std::uint32_t node = segment.begin; node < segment.end; node++) {
+                    sources.clear();
+                    for (std::uint32_t e = edgeOffsets[node]; e < edgeOffsets[node + 1]; e++) {
+                        sources.push_back(values.data() + static_cast<std::size_t>(edgeSources[e]) * rows);
+                    }
+                    SimdKernels::weightedSum(values.data() + static_cast<std::size_t>(node) * rows, rows, biases[node], sources.data(),
+                        edgeWeights.data() + edgeOffsets[node], sources.size());
+                }
+                SimdKernels::activate(segment.activation, values.data() + static_cast<std::size_t>(segment.begin) * rows,
+                    static_cast<std::size_t>(segment.end - segment.begin) * rows);
+                };
+            const std::size_t segmentCount = levelOffsets[level + 1] - firstSegment;
+            if (pool != nullptr) {
+                pool->parallelFor(segmentCount, task);
+            } else {
+                for (std::size_t index = 0; index < segmentCount; index++) {
+                    task(index, 0);
+                }
+            }
+        }
+        for (std::size_t g = 0; g < genomeCount; g++) {
+            for (std::size_t i = 0; i < outputCount; i++) {
+                const dType* source = values.data() + static_cast<std::size_t>(outputNodes[g * outputCount + i]) * rows;
+                dType* target = outputs + g * rows * outputCount + i;
+                for (std::size_t r = 0; r < rows; r++) {
+                    target[r * outputCount] = source[r];
+                }
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    std::size_t PopulationGraph<dType, T2>::getGenomeCount() const {
+        return genomeCount;
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t PopulationGraph<dType, T2>::getNodeCount() const {
+        return static_cast<std::uint32_t>(biases.size());
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t PopulationGraph<dType, T2>::getEdgeCount() const {
+        return static_cast<std::uint32_t>(edgeSources.size());
+    }
+
+    template <typename dType, typename T2>
+    std::uint32_t PopulationGraph<dType, T2>::getLevelCount() const {
+        return static_cast<std::uint32_t>(levelOffsets.size() - 1);
+    }
+
+    // Explicit instantiation
+    template class PopulationGraph<double, int>;
+    template class PopulationGraph<double, long>;
+    template class PopulationGraph<float, int>;
+    template class PopulationGraph<float, long>;
+}
@@ -0,0 +1,356 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/NEAT/QuantizedGenome.hpp"
+#include "../include/NEAT/ExecutionPlan.hpp"
+#include "../include/NEAT/Genome.hpp"
+
+namespace NEAT {
+
+    namespace {
+        // inputs of sigmoid and tanh beyond the range of their table round to the saturated value
+        const double SIGMOID_RANGE = 12;
+        const double TANH_RANGE = 6;
+
+        /**
+         * @brief Split a real multiplier into value * 2^-shift with value < 2^bits
+         *
+         */
+        void toFixedPoint(double multiplier, int bits, std::int64_t& value, std::uint8_t& shift) {
+            if (!(multiplier > 0)) {
+                value = 0;
+                shift = 1;
+                return;
+            }
+            int exponent;
+            const double mantissa = std::frexp(multiplier, &exponent);
+            std::int64_t fixed = static_cast<std::int64_t>(std::llround(mantissa * static_cast<double>(std::int64_t(1) << bits)));
+            int s = bits - exponent;
+            // keep the shift within (0, 62], large multipliers saturate, tiny ones round to zero
+            if (s < 1) {
+                fixed = std::int64_t(1) << bits;
+                s = 1;
+            }
+            if (s > 62) {
+                fixed >>= std::min(s - 62, 63);
+                s = 62;
+            }
+            value = fixed;
+            shift = static_cast<std::uint8_t>(s);
+        }
+
+        inline std::int64_t requantize(std::int64_t accumulator, std::int64_t multiplier, std::uint8_t shift) {
+            return (accumulator * multiplier + (std::int64_t(1) << (shift - 1))) >> shift;
+        }
+
+        template <typename qType>
+        inline qType saturate(std::int64_t value, std::int64_t low, std::int64_t high) {
+            return static_cast<qType>(std::min(std::max(value, low), high));
+        }
+    }
+
+    template <typename dType, typename T2, typename qType>
+    QuantizedGenome<dType, T2, qType>::QuantizedGenome(const Genome<dType, T2>& genome, const std::vector<dType>& calibrationInputs) :
+        QuantizedGenome(genome.getExecutionPlan(), calibrationInputs) {}
+
+    template <typename dType, typename T2, typename qType>
+    QuantizedGenome<dType, T2, qType>::QuantizedGenome(const ExecutionPlan<dType, T2>& plan, const std::vector<dType>& calibrationInputs) :
+        inputSize(plan.getInputSize()), outputSize(plan.getOutputSize()) {
+        quantize(plan, calibrationInputs);
+    }
+
+    template <typename dType, typename T2, typename qType>
+    void QuantizedGenome<dType, T2, qType>::quantize(const ExecutionPlan<dType, T2>& plan, const std::vector<dType>& calibrationInputs) {
+        const std::size_t columns = static_cast<std::size_t>(inputSize);
+        if (calibrationInputs.empty() || columns == 0 || calibrationInputs.size() % columns != 0) {
+            throw std::invalid_argument("QuantizedGenome<dType, T2, qType>::quantize - calibration inputs must be at least one row of inputSize values");
+        }
+        const std::uint32_t nodeCount = plan.getNodeCount();
+        const std::vector<std::uint32_t>& planOffsets = plan.getEdgeOffsets();
+        const std::vector<std::uint32_t>& planSources = plan.getEdgeSources();
+        const std::vector<dType>& planWeights = plan.getEdgeWeights();
+        const std::vector<dType>& planBiases = plan.getBiases();
+        const std::vector<ActivationType>& planActivations = plan.getActivations();
+        inputSlots = plan.getInputSlots();
+        outputSlots = plan.getOutputSlots();
+        edgeOffsets = planOffsets;
+        edgeSources = planSources;
+        activations = planActivations;
+        // 1. calibrate, largest input, pre-activation and value of every slot over the calibration rows
+        std::vector<double> maxInput(columns, 0);
+        std::vector<double> maxPre(nodeCount, 0);
+        std::vector<double> maxValue(nodeCount, 0);
+        std::vector<double> values(nodeCount);
+        const std::size_t rows = calibrationInputs.size() / columns;
+        for (std::size_t r = 0; r < rows; r++) {
+            std::fill(values.begin(), values.end(), 0);
+            for (std::size_t i = 0; i < columns; i++) {
+                const double input = calibrationInputs[r * columns + i];
+                values[inputSlots[i]] = input;
+                maxInput[i] = std::max(maxInput[i], std::fabs(input));
+            }
+            for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+                double sum = values[slot] + planBiases[slot];
+                for (std::uint32_t e = planOffsets[slot]; e < planOffsets[slot + 1]; e++) {
+                    sum += planWeights[e] * values[planSources[e]];
+                }
+                values[slot] = applyActivation(activations[slot], sum);
+                maxPre[slot] = std::max(maxPre[slot], std::fabs(sum));
+                maxValue[slot] = std::max(maxValue[slot], std::fabs(values[slot]));
+            }
+        }
+        inputScales.resize(columns);
+        for (std::size_t i = 0; i < columns; i++) {
+            inputScales[i] = static_cast<dType>((maxInput[i] > 0 ? maxInput[i] : 1) / QMAX);
+        }
+        std::vector<std::int64_t> inputSlotOf(nodeCount, -1);
+        for (std::size_t i = 0; i < columns; i++) {
+            inputSlotOf[inputSlots[i]] = static_cast<std::int64_t>(i);
+        }
+        // 2. value scale of every slot, fixed for bounded activations, calibrated otherwise
+        scales.resize(nodeCount);
+        tableOffsets.assign(nodeCount, 0);
+        std::uint32_t sigmoidTable = LUT_SIZE + 1;
+        std::uint32_t tanhTable = LUT_SIZE + 1;
+        std::vector<double> tableRanges(nodeCount, 0);
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            switch (activations[slot]) {
+            case ActivationType::SIGMOID:
+            case ActivationType::TANH:
+            case ActivationType::STEP:
+                scales[slot] = static_cast<dType>(1.0 / QMAX);
+                break;
+            case ActivationType::RELU:
+            case ActivationType::IDENTITY:
+                scales[slot] = static_cast<dType>((maxValue[slot] > 0 ? maxValue[slot] : 1) / QMAX);
+                break;
+            default: {
+                // user-defined, tabulated over the calibrated range, scaled by the largest value in the table
+                const double range = (maxPre[slot] > 0) ? maxPre[slot] : 1;
+                double largest = 0;
+                for (std::uint32_t j = 0; j <= LUT_SIZE; j++) {
+                    const double x = -range + 2 * range * j / LUT_SIZE;
+                    largest = std::max(largest, std::fabs(static_cast<double>(applyActivation(activations[slot], static_cast<dType>(x)))));
+                }
+                scales[slot] = static_cast<dType>((largest > 0 ? largest : 1) / QMAX);
+                tableRanges[slot] = range;
+                break;
+            }
+            }
+        }
+        // 3. weights of every slot with the scales of their sources folded in, quantized with one scale per slot
+        const int bits = QuantizationTraits<qType>::MULTIPLIER_BITS;
+        const std::int64_t accumulatorLimit = std::int64_t(1) << QuantizationTraits<qType>::BIAS_BITS;
+        edgeWeights.resize(planWeights.size());
+        inputWeights.assign(nodeCount, 0);
+        biases.resize(nodeCount);
+        multipliers.resize(nodeCount);
+        shifts.resize(nodeCount);
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            const double inputWeight = (inputSlotOf[slot] >= 0) ? static_cast<double>(inputScales[inputSlotOf[slot]]) : 0;
+            double largest = inputWeight;
+            for (std::uint32_t e = planOffsets[slot]; e < planOffsets[slot + 1]; e++) {
+                largest = std::max(largest, std::fabs(planWeights[e] * static_cast<double>(scales[planSources[e]])));
+            }
+            const double bias = planBiases[slot];
+            // scale of the accumulator, a slot without inputs only holds its bias
+            const double accumulatorScale = (largest > 0) ? largest / QMAX : ((bias != 0 ? std::fabs(bias) : 1) / (1 << 20));
+            inputWeights[slot] = saturate<qType>(std::llround(inputWeight / accumulatorScale), -QMAX, QMAX);
+            for (std::uint32_t e = planOffsets[slot]; e < planOffsets[slot + 1]; e++) {
+                const double weight = planWeights[e] * static_cast<double>(scales[planSources[e]]);
+                edgeWeights[e] = saturate<qType>(std::llround(weight / accumulatorScale), -QMAX, QMAX);
+            }
+            biases[slot] = static_cast<Accumulator>(std::min(std::max<std::int64_t>(std::llround(bias / accumulatorScale), -accumulatorLimit), accumulatorLimit));
+            // 4. requantization to a table position or to the value scale
+            double multiplier = 0;
+            switch (activations[slot]) {
+            case ActivationType::SIGMOID:
+                if (sigmoidTable > LUT_SIZE) sigmoidTable = addTable(ActivationType::SIGMOID, static_cast<dType>(SIGMOID_RANGE), scales[slot]);
+                tableOffsets[slot] = sigmoidTable;
+                multiplier = accumulatorScale * LUT_SIZE / (2 * SIGMOID_RANGE) * (1 << LUT_FRACTION_BITS);
+                break;
+            case ActivationType::TANH:
+                if (tanhTable > LUT_SIZE) tanhTable = addTable(ActivationType::TANH, static_cast<dType>(TANH_RANGE), scales[slot]);
+                tableOffsets[slot] = tanhTable;
+                multiplier = accumulatorScale * LUT_SIZE / (2 * TANH_RANGE) * (1 << LUT_FRACTION_BITS);
+                break;
+            case ActivationType::RELU:
+            case ActivationType::IDENTITY:
+                multiplier = accumulatorScale / scales[slot];
+                break;
+            case ActivationType::STEP:
+                multiplier = 1;
+                break;
+            default:
+                tableOffsets[slot] = addTable(activations[slot], static_cast<dType>(tableRanges[slot]), scales[slot]);
+                multiplier = accumulatorScale * LUT_SIZE / (2 * tableRanges[slot]) * (1 << LUT_FRACTION_BITS);
+                break;
+            }
+            toFixedPoint(multiplier, bits, multipliers[slot], shifts[slot]);
+        }
+    }
+
+    template <typename dType, typename T2, typename qType>
+    std::uint32_t QuantizedGenome<dType, T2, qType>::addTable(ActivationType type, dType range, dType scale) {
+        const std::uint32_t offset = static_cast<std::uint32_t>(tables.size());
+        for (std::uint32_t j = 0; j <= LUT_SIZE; j++) {
+            const double x = -static_cast<double>(range) + 2 * static_cast<double>(range) * j / LUT_SIZE;
+            const double value = applyActivation(type, static_cast<dType>(x)) / static_cast<double>(scale);
+            tables.push_back(saturate<qType>(std::llround(value), -QMAX, QMAX));
+        }
+        return offset;
+    }
+
+    template <typename dType, typename T2, typename qType>
+    void QuantizedGenome<dType, T2, qType>::evaluate(const dType* inputs, dType* outputs, QuantizedWorkspace<qType>& workspace) const {
+        std::vector<qType>& values = workspace.values;
+        const std::uint32_t nodeCount = getNodeCount();
+        values.assign(nodeCount, 0);
+        for (T2 i = 0; i < inputSize; i++) {
+            values[inputSlots[i]] = saturate<qType>(std::llround(inputs[i] / inputScales[i]), -QMAX, QMAX);
+        }
+        const std::int64_t tableEnd = static_cast<std::int64_t>(LUT_SIZE) << LUT_FRACTION_BITS;
+        const std::int64_t tableMiddle = tableEnd / 2;
+        const std::int64_t fractionMask = (std::int64_t(1) << LUT_FRACTION_BITS) - 1;
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            Accumulator sum = biases[slot] + static_cast<Accumulator>(inputWeights[slot]) * values[slot];
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                sum += static_cast<Accumulator>(edgeWeights[e]) * values[edgeSources[e]];
+            }
+            switch (activations[slot]) {
+            case ActivationType::RELU:
+                values[slot] = saturate<qType>(requantize(sum, multipliers[slot], shifts[slot]), 0, QMAX);
+                break;
+            case ActivationType::IDENTITY:
+                values[slot] = saturate<qType>(requantize(sum, multipliers[slot], shifts[slot]), -QMAX, QMAX);
+                break;
+            case ActivationType::STEP:
+                values[slot] = (sum > 0) ? QMAX : 0;
+                break;
+            default: {
+                // position in the table, linear interpolation between its two nearest entries
+                const std::int64_t position = std::min(std::max<std::int64_t>(requantize(sum, multipliers[slot], shifts[slot]) + tableMiddle, 0), tableEnd);
+                const qType* table = tables.data() + tableOffsets[slot];
+                const std::int64_t index = position >> LUT_FRACTION_BITS;
+                if (index == LUT_SIZE) {
+                    values[slot] = table[LUT_SIZE];
+                    break;
+                }
+                const std::int64_t low = table[index];
+                const std::int64_t high = table[index + 1];
+                values[slot] = static_cast<qType>(low + (((high - low) * (position & fractionMask) + (fractionMask + 1) / 2) >> LUT_FRACTION_BITS));
+                break;
+            }
+            }
+        }
+        for (T2 i = 0; i < outputSize; i++) {
+            outputs[i] = values[outputSlots[i]] * scales[outputSlots[i]];
+        }
+    }
+
+    template <typename dType, typename T2, typename qType>
+    std::vector<dType> QuantizedGenome<dType, T2, qType>::feedForward(const std::vector<dType>& inputs) const {
+        if (static_cast<T2>(inputs.size()) != inputSize) {
+            throw std::invalid_argument("QuantizedGenome<dType, T2, qType>::feedForward - input size does not match");
+        }
+        thread_local QuantizedWorkspace<qType> workspace;
+        std::vector<dType> outputs(outputSize);
+        evaluate(inputs.data(), outputs.data(), workspace);
+        return outputs;
+    }
+
+    template <typename dType, typename T2, typename qType>
+    T2 QuantizedGenome<dType, T2, qType>::predict(const std::vector<dType>& inputs) const {
+        const std::vector<dType> outputs = feedForward(inputs);
+        T2 maxIndex = 0;
+        for (T2 i = 0; i < outputSize; i++) {
+            if (outputs[i] > outputs[maxIndex]) {
+                maxIndex = i;
+            }
+        }
+        return maxIndex;
+    }
+
+    template <typename dType, typename T2, typename qType>
+    QuantizationReport<dType> QuantizedGenome<dType, T2, qType>::compare(const Genome<dType, T2>& genome, const std::vector<dType>& inputs) const {
+        const std::size_t columns = static_cast<std::size_t>(inputSize);
+        if (genome.getInputSize() != inputSize || genome.getOutputSize() != outputSize) {
+            throw std::invalid_argument("QuantizedGenome<dType, T2, qType>::compare - genome size does not match");
+        }
+        if (columns == 0 || inputs.size() % columns != 0) {
+            throw std::invalid_argument("QuantizedGenome<dType, T2, qType>::compare - inputs must be rows of inputSize values");
+        }
+        QuantizationReport<dType> report;
+        report.rows = inputs.size() / columns;
+        if (report.rows == 0) return report;
+        ActivationWorkspace<dType> workspace;
+        QuantizedWorkspace<qType> quantizedWorkspace;
+        std::vector<dType> row(columns);
+        std::vector<dType> expected;
+        std::vector<dType> actual(outputSize);
+        double errorSum = 0;
+        std::size_t agreements = 0;
+        for (std::size_t r = 0; r < report.rows; r++) {
+            row.assign(inputs.begin() + r * columns, inputs.begin() + (r + 1) * columns);
+            expected.clear();
+            genome.feedForward(row, expected, workspace);
+            evaluate(row.data(), actual.data(), quantizedWorkspace);
+            T2 expectedIndex = 0;
+            T2 actualIndex = 0;
+            for (T2 i = 0; i < outputSize; i++) {
+                const dType error = std::fabs(expected[i] - actual[i]);
+                report.maxAbsoluteError = std::max(report.maxAbsoluteError, error);
+                errorSum += error;
+                if (expected[i] > expected[expectedIndex]) expectedIndex = i;
+                if (actual[i] > actual[actualIndex]) actualIndex = i;
+            }
+            if (expectedIndex == actualIndex) agreements++;
+        }
+        report.meanAbsoluteError = static_cast<dType>(errorSum / (report.rows * static_cast<std::size_t>(outputSize)));
+        report.argmaxAgreement = static_cast<dType>(static_cast<double>(agreements) / report.rows);
+        return report;
+    }
+
+    template <typename dType, typename T2, typename qType>
+    const T2& QuantizedGenome<dType, T2, qType>::getInputSize() const {
+        return inputSize;
+    }
+
+    template <typename dType, typename T2, typename qType>
+    const T2& QuantizedGenome<dType, T2, qType>::getOutputSize() const {
+        return outputSize;
+    }
+
+    template <typename dType, typename T2, typename qType>
+    std::uint32_t QuantizedGenome<dType, T2, qType>::getNodeCount() const {
+        return static_cast<std::uint32_t>(activations.size());
+    }
+
+    template <typename dType, typename T2, typename qType>
+    std::uint32_t QuantizedGenome<dType, T2, qType>::getEdgeCount() const {
+        return static_cast<std::uint32_t>(edgeSources.size());
+    }
+
+    template <typename dType, typename T2, typename qType>
+    std::size_t QuantizedGenome<dType, T2, qType>::getMemoryUsage() const {
+        return edgeOffsets.size() * sizeof(std::uint32_t) + edgeSources.size() * sizeof(std::uint32_t)
+            + edgeWeights.size() * sizeof(qType) + inputWeights.size() * sizeof(qType)
+            + biases.size() * sizeof(Accumulator) + multipliers.size() * sizeof(std::int64_t)
+            + shifts.size() * sizeof(std::uint8_t) + activations.size() * sizeof(ActivationType)
+            + tableOffsets.size() * sizeof(std::uint32_t) + tables.size() * sizeof(qType)
+            + scales.size() * sizeof(dType) + inputScales.size() * sizeof(dType)
+            + inputSlots.size() * sizeof(std::uint32_t) + outputSlots.size() * sizeof(std::uint32_t);
+    }
+
+    // Explicit instantiation
+    template class QuantizedGenome<double, int, std::int8_t>;
+    template class QuantizedGenome<double, int, std::int16_t>;
+    template class QuantizedGenome<double, long, std::int8_t>;
+    template class QuantizedGenome<double, long, std::int16_t>;
+    template class QuantizedGenome<float, int, std::int8_t>;
+    template class QuantizedGenome<float, int, std::int16_t>;
+    template class QuantizedGenome<float, long, std::int8_t>;
+    template class QuantizedGenome<float, long, std::int16_t>;
+}
@@ -0,0 +1,397 @@
+#include <atomic>
+#include <algorithm>
+
+#include "../include/NEAT/SimdKernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NEAT_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// compile the functions of a region for an instruction set, the cpu is checked before they are called
+#if defined(__clang__)
+#define NEAT_SIMD_TARGET_PUSH(isa) _Pragma(NEAT_SIMD_STRINGIFY(clang attribute push(__attribute__((target(isa))), apply_to = function)))
+#define NEAT_SIMD_TARGET_POP _Pragma("clang attribute pop")
+#else
+#define NEAT_SIMD_TARGET_PUSH(isa) _Pragma("GCC push_options") _Pragma(NEAT_SIMD_STRINGIFY(GCC target(isa)))
+#define NEAT_SIMD_TARGET_POP _Pragma("GCC pop_options")
+#endif
+#define NEAT_SIMD_STRINGIFY(x) #x
+
+namespace NEAT {
+
+#ifdef NEAT_SIMD_X86
+
+    NEAT_SIMD_TARGET_PUSH("sse2")
+    namespace sse2 {
+        struct DoubleOps {
+            typedef double Value;
+            typedef __m128d Vec;
+            static constexpr std::size_t LANES = 2;
+            static constexpr int EXP_DEGREE = 12;
+            static constexpr double EXP_MIN = -708;
+            static constexpr double EXP_MAX = 708;
+            static constexpr double EXP_SHIFTER = 6755399441055744.0; // 1.5 * 2^52
+            static constexpr double LOG2E = 1.4426950408889634;
+            static constexpr double LN2_HI = 6.93147180369123816490e-01;
+            static constexpr double LN2_LO = 1.90821492927058770002e-10;
+            static Vec load(const double* p) { return _mm_loadu_pd(p); }
+            static void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+            static Vec set1(double v) { return _mm_set1_pd(v); }
+            static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+            static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+            static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+            static Vec div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+            static Vec fmadd(Vec a, Vec b, Vec c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+            static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+            static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+            static Vec step(Vec x) { return _mm_and_pd(_mm_cmpgt_pd(x, _mm_setzero_pd()), _mm_set1_pd(1)); }
+            static Vec pow2(Vec shifted) {
+                // the low bits of shifted hold k, move them into the exponent
+                return _mm_castsi128_pd(_mm_add_epi64(_mm_slli_epi64(_mm_castpd_si128(shifted), 52), _mm_set1_epi64x(1023LL << 52)));
+            }
+        };
+        struct FloatOps {
+            typedef float Value;
+            typedef __m128 Vec;
+            static constexpr std::size_t LANES = 4;
+            static constexpr int EXP_DEGREE = 7;
+            static constexpr float EXP_MIN = -87;
+            static constexpr float EXP_MAX = 87;
+            static constexpr float EXP_SHIFTER = 12582912.0f; // 1.5 * 2^23
+            static constexpr float LOG2E = 1.44269504f;
+            static constexpr float LN2_HI = 0.693359375f;
+            static constexpr float LN2_LO = -2.12194440e-4f;
+            static Vec load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+            static Vec set1(float v) { return _mm_set1_ps(v); }
+            static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+            static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+            static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+            static Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+            static Vec fmadd(Vec a, Vec b, Vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+            static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+            static Vec step(Vec x) { return _mm_and_ps(_mm_cmpgt_ps(x, _mm_setzero_ps()), _mm_set1_ps(1)); }
+            static Vec pow2(Vec shifted) {
+                return _mm_castsi128_ps(_mm_add_epi32(_mm_slli_epi32(_mm_castps_si128(shifted), 23), _mm_set1_epi32(127 << 23)));
+            }
+        };
+#include "./SimdKernels.inl"
+        inline bool activate(ActivationType type, double* values, std::size_t count) {
+            return activateVec<DoubleOps>(type, values, count);
+        }
+        inline bool activate(ActivationType type, float* values, std::size_t count) {
+            return activateVec<FloatOps>(type, values, count);
+        }
+        inline void weightedSum(double* target, std::size_t count, double bias, const double* const* sources, const double* weights, std::size_t edgeCount) {
+            weightedSumVec<DoubleOps>(target, count, bias, sources, weights, edgeCount);
+        }
+        inline void weightedSum(float* target, std::size_t count, float bias, const float* const* sources, const float* weights, std::size_t edgeCount) {
+            weightedSumVec<FloatOps>(target, count, bias, sources, weights, edgeCount);
+        }
+        inline void laneWeightedSum(double* target, std::size_t count, const double* biases, const double* const* sources, const double* weights, std::size_t edgeCount) {
+            laneWeightedSumVec<DoubleOps>(target, count, biases, sources, weights, edgeCount);
+        }
+        inline void laneWeightedSum(float* target, std::size_t count, const float* biases, const float* const* sources, const float* weights, std::size_t edgeCount) {
+            laneWeightedSumVec<FloatOps>(target, count, biases, sources, weights, edgeCount);
+        }
+    }
+    NEAT_SIMD_TARGET_POP
+
+    NEAT_SIMD_TARGET_PUSH("avx2,fma")
+    namespace avx2 {
+        struct DoubleOps {
+            typedef double Value;
+            typedef __m256d Vec;
+            static constexpr std::size_t LANES = 4;
+            static constexpr int EXP_DEGREE = sse2::DoubleOps::EXP_DEGREE;
+            static constexpr double EXP_MIN = sse2::DoubleOps::EXP_MIN;
+            static constexpr double EXP_MAX = sse2::DoubleOps::EXP_MAX;
+            static constexpr double EXP_SHIFTER = sse2::DoubleOps::EXP_SHIFTER;
+            static constexpr double LOG2E = sse2::DoubleOps::LOG2E;
+            static constexpr double LN2_HI = sse2::DoubleOps::LN2_HI;
+            static constexpr double LN2_LO = sse2::DoubleOps::LN2_LO;
+            static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+            static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+            static Vec set1(double v) { return _mm256_set1_pd(v); }
+            static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+            static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+            static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+            static Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+            static Vec fmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_pd(a, b, c); }
+            static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+            static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+            static Vec step(Vec x) { return _mm256_and_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ), _mm256_set1_pd(1)); }
+            static Vec pow2(Vec shifted) {
+                return _mm256_castsi256_pd(_mm256_add_epi64(_mm256_slli_epi64(_mm256_castpd_si256(shifted), 52), _mm256_set1_epi64x(1023LL << 52)));
+            }
+        };
+        struct FloatOps {
+            typedef float Value;
+            typedef __m256 Vec;
+            static constexpr std::size_t LANES = 8;
+            static constexpr int EXP_DEGREE = sse2::FloatOps::EXP_DEGREE;
+            static constexpr float EXP_MIN = sse2::FloatOps::EXP_MIN;
+            static constexpr float EXP_MAX = sse2::FloatOps::EXP_MAX;
+            static constexpr float EXP_SHIFTER = sse2::FloatOps::EXP_SHIFTER;
+            static constexpr float LOG2E = sse2::FloatOps::LOG2E;
+            static constexpr float LN2_HI = sse2::FloatOps::LN2_HI;
+            static constexpr float LN2_LO = sse2::FloatOps::LN2_LO;
+            static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+            static Vec set1(float v) { return _mm256_set1_ps(v); }
+            static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+            static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+            static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+            static Vec div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+            static Vec fmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+            static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+            static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+            static Vec step(Vec x) { return _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_set1_ps(1)); }
+            static Vec pow2(Vec shifted) {
+                return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_slli_epi32(_mm256_castps_si256(shifted), 23), _mm256_set1_epi32(127 << 23)));
+            }
+        };
+#include "./SimdKernels.inl"
+        inline bool activate(ActivationType type, double* values, std::size_t count) {
+            return activateVec<DoubleOps>(type, values, count);
+        }
+        inline bool activate(ActivationType type, float* values, std::size_t count) {
+            return activateVec<FloatOps>(type, values, count);
+        }
+        inline void weightedSum(double* target, std::size_t count, double bias, const double* const* sources, const double* weights, std::size_t edgeCount) {
+            weightedSumVec<DoubleOps>(target, count, bias, sources, weights, edgeCount);
+        }
+        inline void weightedSum(float* target, std::size_t count, float bias, const float* const* sources, const float* weights, std::size_t edgeCount) {
+            weightedSumVec<FloatOps>(target, count, bias, sources, weights, edgeCount);
+        }
+        inline void laneWeightedSum(double* target, std::size_t count, const double* biases, const double* const* sources, const double* weights, std::size_t edgeCount) {
+            laneWeightedSumVec<DoubleOps>(target, count, biases, sources, weights, edgeCount);
+        }
+        inline void laneWeightedSum(float* target, std::size_t count, const float* biases, const float* const* sources, const float* weights, std::size_t edgeCount) {
+            laneWeightedSumVec<FloatOps>(target, count, biases, sources, weights, edgeCount);
+        }
+    }
+    NEAT_SIMD_TARGET_POP
+
+    // the avx512 intrinsics of gcc 12 start from _mm512_undefined_pd, which trips -Wmaybe-uninitialized
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    NEAT_SIMD_TARGET_PUSH("avx512f")
+    namespace avx512 {
+        struct DoubleOps {
+            typedef double Value;
+            typedef __m512d Vec;
+            static constexpr std::size_t LANES = 8;
+            static constexpr int EXP_DEGREE = sse2::DoubleOps::EXP_DEGREE;
+            static constexpr double EXP_MIN = sse2::DoubleOps::EXP_MIN;
+            static constexpr double EXP_MAX = sse2::DoubleOps::EXP_MAX;
+            static constexpr double EXP_SHIFTER = sse2::DoubleOps::EXP_SHIFTER;
+            static constexpr double LOG2E = sse2::DoubleOps::LOG2E;
+            static constexpr double LN2_HI = sse2::DoubleOps::LN2_HI;
+            static constexpr double LN2_LO = sse2::DoubleOps::LN2_LO;
+            static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+            static void store(double* p, Vec v) { _mm512_storeu_pd(p, v); }
+            static Vec set1(double v) { return _mm512_set1_pd(v); }
+            static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+            static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+            static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+            static Vec div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+            static Vec fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_pd(a, b, c); }
+            static Vec max(Vec a, Vec b) { return _mm512_max_pd(a, b); }
+            static Vec min(Vec a, Vec b) { return _mm512_min_pd(a, b); }
+            static Vec step(Vec x) { return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ), _mm512_set1_pd(1)); }
+            static Vec pow2(Vec shifted) {
+                return _mm512_castsi512_pd(_mm512_add_epi64(_mm512_slli_epi64(_mm512_castpd_si512(shifted), 52), _mm512_set1_epi64(1023LL << 52)));
+            }
+        };
+        struct FloatOps {
+            typedef float Value;
+            typedef __m512 Vec;
+            static constexpr std::size_t LANES = 16;
+            static constexpr int EXP_DEGREE = sse2::FloatOps::EXP_DEGREE;
+            static constexpr float EXP_MIN = sse2::FloatOps::EXP_MIN;
+            static constexpr float EXP_MAX = sse2::FloatOps::EXP_MAX;
+            static constexpr float EXP_SHIFTER = sse2::FloatOps::EXP_SHIFTER;
+            static constexpr float LOG2E = sse2::FloatOps::LOG2E;
+            static constexpr float LN2_HI = sse2::FloatOps::LN2_HI;
+            static constexpr float LN2_LO = sse2::FloatOps::LN2_LO;
+            static Vec load(const float* p) { return _mm512_loadu_ps(p); }
+            static void store(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+            static Vec set1(float v) { return _mm512_set1_ps(v); }
+            static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+            static Vec sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+            static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+            static Vec div(Vec a, Vec b) { return _mm512_div_ps(a, b); }
+            static Vec fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_ps(a, b, c); }
+            static Vec max(Vec a, Vec b) { return _mm512_max_ps(a, b); }
+            static Vec min(Vec a, Vec b) { return _mm512_min_ps(a, b); }
+            static Vec step(Vec x) { return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ), _mm512_set1_ps(1)); }
+            static Vec pow2(Vec shifted) {
+                return _mm512_castsi512_ps(_mm512_add_epi32(_mm512_slli_epi32(_mm512_castps_si512(shifted), 23), _mm512_set1_epi32(127 << 23)));
+            }
+        };
+#include "./SimdKernels.inl"
+        inline bool activate(ActivationType type, double* values, std::size_t count) {
+            return activateVec<DoubleOps>(type, values, count);
+        }
+        inline bool activate(ActivationType type, float* values, std::size_t count) {
+            return activateVec<FloatOps>(type, values, count);
+        }
+        inline void weightedSum(double* target, std::size_t count, double bias, const double* const* sources, const double* weights, std::size_t edgeCount) {
+            weightedSumVec<DoubleOps>(target, count, bias, sources, weights, edgeCount);
+        }
+        inline void weightedSum(float* target, std::size_t count, float bias, const float* const* sources, const float* weights, std::size_t edgeCount) {
+            weightedSumVec<FloatOps>(target, count, bias, sources, weights, edgeCount);
+        }
+        inline void laneWeightedSum(double* target, std::size_t count, const double* biases, const double* const* sources, const double* weights, std::size_t edgeCount) {
+            laneWeightedSumVec<DoubleOps>(target, count, biases, sources, weights, edgeCount);
+        }
+        inline void laneWeightedSum(float* target, std::size_t count, const float* biases, const float* const* sources, const float* weights, std::size_t edgeCount) {
+            laneWeightedSumVec<FloatOps>(target, count, biases, sources, weights, edgeCount);
+        }
+    }
+    NEAT_SIMD_TARGET_POP
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // NEAT_SIMD_X86
+
+    namespace {
+        InstructionSet detectInstructionSet() {
+#ifdef NEAT_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return InstructionSet::AVX512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return InstructionSet::AVX2;
+            if (__builtin_cpu_supports("sse2")) return InstructionSet::SSE2;
+#endif
+            return InstructionSet::SCALAR;
+        }
+
+        std::atomic<InstructionSet>& currentInstructionSet() {
+            static std::atomic<InstructionSet> instructionSet { SimdKernels::getSupportedInstructionSet() };
+            return instructionSet;
+        }
+
+        template <typename Value>
+        void activateDispatch(ActivationType type, Value* values, std::size_t count) {
+            switch (SimdKernels::getInstructionSet()) {
+#ifdef NEAT_SIMD_X86
+            case InstructionSet::AVX512:
+                if (avx512::activate(type, values, count)) return;
+                break;
+            case InstructionSet::AVX2:
+                if (avx2::activate(type, values, count)) return;
+                break;
+            case InstructionSet::SSE2:
+                if (sse2::activate(type, values, count)) return;
+                break;
+#endif
+            default:
+                break;
+            }
+            applyActivation(type, values, count);
+        }
+
+        template <typename Value>
+        void weightedSumDispatch(Value* target, std::size_t count, Value bias, const Value* const* sources, const Value* weights, std::size_t edgeCount) {
+            switch (SimdKernels::getInstructionSet()) {
+#ifdef NEAT_SIMD_X86
+            case InstructionSet::AVX512:
+                avx512::weightedSum(target, count, bias, sources, weights, edgeCount);
+                return;
+            case InstructionSet::AVX2:
+                avx2::weightedSum(target, count, bias, sources, weights, edgeCount);
+                return;
+            case InstructionSet::SSE2:
+                sse2::weightedSum(target, count, bias, sources, weights, edgeCount);
+                return;
+#endif
+            default:
+                break;
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                target[i] += bias;
+            }
+            for (std::size_t e = 0; e < edgeCount; e++) {
+                const Value* source = sources[e];
+                const Value weight = weights[e];
+                for (std::size_t i = 0; i < count; i++) {
+                    target[i] += weight * source[i];
+                }
+            }
+        }
+
+        template <typename Value>
+        void laneWeightedSumDispatch(Value* target, std::size_t count, const Value* biases, const Value* const* sources, const Value* weights, std::size_t edgeCount) {
+            switch (SimdKernels::getInstructionSet()) {
+#ifdef NEAT_SIMD_X86
+            case InstructionSet::AVX512:
+                avx512::laneWeightedSum(target, count, biases, sources, weights, edgeCount);
+                return;
+            case InstructionSet::AVX2:
+                avx2::laneWeightedSum(target, count, biases, sources, weights, edgeCount);
+                return;
+            case InstructionSet::SSE2:
+                sse2::laneWeightedSum(target, count, biases, sources, weights, edgeCount);
+                return;
+#endif
+            default:
+                break;
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                target[i] += biases[i];
+            }
+            for (std::size_t e = 0; e < edgeCount; e++) {
+                const Value* source = sources[e];
+                const Value* weight = weights + e * count;
+                for (std::size_t i = 0; i < count; i++) {
+                    target[i] += weight[i] * source[i];
+                }
+            }
+        }
+    }
+
+    InstructionSet SimdKernels::getSupportedInstructionSet() {
+        static const InstructionSet supported = detectInstructionSet();
+        return supported;
+    }
+
+    InstructionSet SimdKernels::getInstructionSet() {
+        return currentInstructionSet().load(std::memory_order_relaxed);
+    }
+
+    InstructionSet SimdKernels::setInstructionSet(InstructionSet instructionSet) {
+        instructionSet = std::min(instructionSet, getSupportedInstructionSet());
+        currentInstructionSet().store(instructionSet, std::memory_order_relaxed);
+        return instructionSet;
+    }
+
+    void SimdKernels::activate(ActivationType type, double* values, std::size_t count) {
+        activateDispatch(type, values, count);
+    }
+
+    void SimdKernels::activate(ActivationType type, float* values, std::size_t count) {
+        activateDispatch(type, values, count);
+    }
+
+    void SimdKernels::weightedSum(double* target, std::size_t count, double bias, const double* const* sources, const double* weights, std::size_t edgeCount) {
+        weightedSumDispatch(target, count, bias, sources, weights, edgeCount);
+    }
+
+    void SimdKernels::weightedSum(float* target, std::size_t count, float bias, const float* const* sources, const float* weights, std::size_t edgeCount) {
+        weightedSumDispatch(target, count, bias, sources, weights, edgeCount);
+    }
+
+    void SimdKernels::laneWeightedSum(double* target, std::size_t count, const double* biases, const double* const* sources, const double* weights, std::size_t edgeCount) {
+        laneWeightedSumDispatch(target, count, biases, sources, weights, edgeCount);
+    }
+
+    void SimdKernels::laneWeightedSum(float* target, std::size_t count, const float* biases, const float* const* sources, const float* weights, std::size_t edgeCount) {
+        laneWeightedSumDispatch(target, count, biases, sources, weights, edgeCount);
+    }
+}
@@ -0,0 +1,155 @@
+// Kernels shared by all instruction sets, included by SimdKernels.cpp once per instruction set,
+// inside a region compiled for that instruction set and after the Ops structs of the region are defined.
+//
+// Ops provides:
+//   Value, Vec, LANES
+//   load, store, set1, add, sub, mul, div, fmadd(a, b, c) = a * b + c
+//   max, min, returning the second operand if either is NaN
+//   step(x) = x > 0 ? 1 : 0
+//   pow2(shifted), 2^k for shifted = k + EXP_SHIFTER
+//   EXP_MIN, EXP_MAX, EXP_SHIFTER, LOG2E, LN2_HI, LN2_LO, EXP_DEGREE
+
+template <typename Value, int DEGREE>
+struct ExpCoefficients {
+    // c[k] = 1 / k!
+    Value c[DEGREE + 1];
+    constexpr ExpCoefficients() : c() {
+        Value factorial = 1;
+        for (int k = 0; k <= DEGREE; k++) {
+            if (k > 0) factorial *= k;
+            c[k] = 1 / factorial;
+        }
+    }
+};
+
+// exp(x) = 2^k * exp(r), r = x - k * ln2 with |r| <= ln2 / 2, exp(r) by a Taylor polynomial
+template <typename Ops>
+inline typename Ops::Vec expVec(typename Ops::Vec x) {
+    typedef typename Ops::Vec Vec;
+    static constexpr ExpCoefficients<typename Ops::Value, Ops::EXP_DEGREE> coefficients {};
+    // operand order keeps NaN
+    x = Ops::min(Ops::set1(Ops::EXP_MAX), Ops::max(Ops::set1(Ops::EXP_MIN), x));
+    const Vec shifted = Ops::fmadd(x, Ops::set1(Ops::LOG2E), Ops::set1(Ops::EXP_SHIFTER));
+    const Vec k = Ops::sub(shifted, Ops::set1(Ops::EXP_SHIFTER));
+    Vec r = Ops::fmadd(k, Ops::set1(-Ops::LN2_HI), x);
+    r = Ops::fmadd(k, Ops::set1(-Ops::LN2_LO), r);
+    Vec p = Ops::set1(coefficients.c[Ops::EXP_DEGREE]);
+    for (int i = Ops::EXP_DEGREE - 1; i >= 0; i--) {
+        p = Ops::fmadd(p, r, Ops::set1(coefficients.c[i]));
+    }
+    return Ops::mul(p, Ops::pow2(shifted));
+}
+
+template <typename Ops>
+struct SigmoidVec {
+    static typename Ops::Vec apply(typename Ops::Vec x) {
+        const typename Ops::Vec one = Ops::set1(1);
+        return Ops::div(one, Ops::add(one, expVec<Ops>(Ops::sub(Ops::set1(0), x))));
+    }
+};
+
+// tanh(x) = 1 - 2 / (exp(2x) + 1)
+template <typename Ops>
+struct TanhVec {
+    static typename Ops::Vec apply(typename Ops::Vec x) {
+        const typename Ops::Vec one = Ops::set1(1);
+        return Ops::sub(one, Ops::div(Ops::set1(2), Ops::add(expVec<Ops>(Ops::add(x, x)), one)));
+    }
+};
+
+template <typename Ops>
+struct ReLUVec {
+    static typename Ops::Vec apply(typename Ops::Vec x) {
+        return Ops::max(x, Ops::set1(0));
+    }
+};
+
+template <typename Ops>
+struct StepVec {
+    static typename Ops::Vec apply(typename Ops::Vec x) {
+        return Ops::step(x);
+    }
+};
+
+// apply a kernel to contiguous values, the tail is padded to a full vector
+template <typename Ops, typename Kernel>
+inline void mapVec(typename Ops::Value* values, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + Ops::LANES <= count; i += Ops::LANES) {
+        Ops::store(values + i, Kernel::apply(Ops::load(values + i)));
+    }
+    if (i == count) return;
+    typename Ops::Value tail[Ops::LANES] = {};
+    std::copy(values + i, values + count, tail);
+    Ops::store(tail, Kernel::apply(Ops::load(tail)));
+    std::copy(tail, tail + (count - i), values + i);
+}
+
+template <typename Ops>
+inline bool activateVec(ActivationType type, typename Ops::Value* values, std::size_t count) {
+    switch (type) {
+    case ActivationType::SIGMOID: mapVec<Ops, SigmoidVec<Ops>>(values, count); return true;
+    case ActivationType::TANH: mapVec<Ops, TanhVec<Ops>>(values, count); return true;
+    case ActivationType::RELU: mapVec<Ops, ReLUVec<Ops>>(values, count); return true;
+    case ActivationType::STEP: mapVec<Ops, StepVec<Ops>>(values, count); return true;
+    case ActivationType::IDENTITY: return true;
+    default: return false;
+    }
+}
+
+template <typename Ops>
+inline void weightedSumVec(typename Ops::Value* target, std::size_t count, typename Ops::Value bias,
+    const typename Ops::Value* const* sources, const typename Ops::Value* weights, std::size_t edgeCount) {
+    typedef typename Ops::Vec Vec;
+    const Vec biasVec = Ops::set1(bias);
+    std::size_t i = 0;
+    for (; i + Ops::LANES <= count; i += Ops::LANES) {
+        Vec sum = Ops::add(Ops::load(target + i), biasVec);
+        for (std::size_t e = 0; e < edgeCount; e++) {
+            sum = Ops::fmadd(Ops::set1(weights[e]), Ops::load(sources[e] + i), sum);
+        }
+        Ops::store(target + i, sum);
+    }
+    if (i == count) return;
+    const std::size_t rest = count - i;
+    typename Ops::Value tail[Ops::LANES] = {};
+    typename Ops::Value source[Ops::LANES] = {};
+    std::copy(target + i, target + count, tail);
+    Vec sum = Ops::add(Ops::load(tail), biasVec);
+    for (std::size_t e = 0; e < edgeCount; e++) {
+        std::copy(sources[e] + i, sources[e] + count, source);
+        sum = Ops::fmadd(Ops::set1(weights[e]), Ops::load(source), sum);
+    }
+    Ops::store(tail, sum);
+    std::copy(tail, tail + rest, target + i);
+}
+
+// each value has its own bias and weights, weights of edge e are the count values at weights + e * count
+template <typename Ops>
+inline void laneWeightedSumVec(typename Ops::Value* target, std::size_t count, const typename Ops::Value* biases,
+    const typename Ops::Value* const* sources, const typename Ops::Value* weights, std::size_t edgeCount) {
+    typedef typename Ops::Vec Vec;
+    std::size_t i = 0;
+    for (; i + Ops::LANES <= count; i += Ops::LANES) {
+        Vec sum = Ops::add(Ops::load(target + i), Ops::load(biases + i));
+        for (std::size_t e = 0; e < edgeCount; e++) {
+            sum = Ops::fmadd(Ops::load(weights + e * count + i), Ops::load(sources[e] + i), sum);
+        }
+        Ops::store(target + i, sum);
+    }
+    if (i == count) return;
+    const std::size_t rest = count - i;
+    typename Ops::Value tail[Ops::LANES] = {};
+    typename Ops::Value source[Ops::LANES] = {};
+    typename Ops::Value weight[Ops::LANES] = {};
+    std::copy(target + i, target + count, tail);
+    std::copy(biases + i, biases + count, source);
+    Vec sum = Ops::add(Ops::load(tail), Ops::load(source));
+    for (std::size_t e = 0; e < edgeCount; e++) {
+        std::copy(sources[e] + i, sources[e] + count, source);
+        std::copy(weights + e * count + i, weights + e * count + count, weight);
+        sum = Ops::fmadd(Ops::load(weight), Ops::load(source), sum);
+    }
+    Ops::store(tail, sum);
+    std::copy(tail, tail + rest, target + i);
+}
@@ -4,9 +4,11 @@
 #include <math.h>
 #include <set>
 #include <algorithm>
+#include <stdexcept>
 
 #include "../include/NEAT/Species.hpp"
 #include "../include/NEAT/Genome.hpp"
+#include "../include/NEAT/FlatGenome.hpp"
 #include "../include/NEAT/Helper.hpp"
 
 namespace NEAT {
@@ -18,27 +20,78 @@ namespace NEAT {
     class Edge;
 
     template <typename dType, typename T2>
-    Species<dType, T2>::Species(Genome<dType, T2>* representative) {
+    Species<dType, T2>::Species(Genome<dType, T2>* genome, T2 id) : id(id) {
         this->genomes = std::vector<Genome<dType, T2>*>();
-        this->genomes.push_back(representative);
-        this->representative = representative;
-        this->totalFitness = representative->getFitness();
+        this->genomes.push_back(genome);
+        this->representative = genome->clone();
+        this->totalFitness = genome->getFitness();
+    }
+
+    template <typename dType, typename T2>
+    Species<dType, T2>::~Species() {
+        delete this->representative;
     }
 
     template <typename dType, typename T2>
     void Species<dType, T2>::addGenome(Genome<dType, T2>* genome) {
-        if (genome->getFitness() > this->representative->getFitness()) {
-            this->representative = genome;
-        }
         this->genomes.push_back(genome);
         this->totalFitness += genome->getFitness();
     }
 
+    template <typename dType, typename T2>
+    void Species<dType, T2>::clearGenomes() {
+        this->genomes.clear();
+        this->totalFitness = 0;
+    }
+
+    template <typename dType, typename T2>
+    void Species<dType, T2>::updateStatistics() {
+        if (this->genomes.empty()) return;
+        const Genome<dType, T2>* fittest = this->genomes.front();
+        for (const Genome<dType, T2>* genome : this->genomes) {
+            if (genome->getFitness() > fittest->getFitness()) fittest = genome;
+        }
+        this->age++;
+        if (fittest->getFitness() > this->bestFitness) {
+            this->bestFitness = fittest->getFitness();
+            this->stagnation = 0;
+        } else {
+            this->stagnation++;
+        }
+        delete this->representative;
+        this->representative = fittest->clone();
+    }
+
     template <typename dType, typename T2>
     const Genome<dType, T2>* Species<dType, T2>::getRepresentative() const {
         return this->representative;
     }
 
+    template <typename dType, typename T2>
+    const std::vector<Genome<dType, T2>*>& Species<dType, T2>::getGenomes() const {
+        return this->genomes;
+    }
+
+    template <typename dType, typename T2>
+    const T2& Species<dType, T2>::getId() const {
+        return this->id;
+    }
+
+    template <typename dType, typename T2>
+    const T2& Species<dType, T2>::getAge() const {
+        return this->age;
+    }
+
+    template <typename dType, typename T2>
+    const dType& Species<dType, T2>::getBestFitness() const {
+        return this->bestFitness;
+    }
+
+    template <typename dType, typename T2>
+    const T2& Species<dType, T2>::getStagnation() const {
+        return this->stagnation;
+    }
+
     template <typename dType, typename T2>
     dType Species<dType, T2>::getDistance(const Genome<dType, T2>* genome, dType c1, dType c2, dType c3) const {
         // T2 maxId_representative = this->representative->getMaxInnovationNumber();
@@ -58,9 +111,9 @@ namespace NEAT {
         // // 
         // dType excessDifference = this->getExcessDifference(incompatibleEdges, maxId_representative, maxId_target);
         // dType disjointDifference = this->getDisjointDifference(incompatibleEdges, maxId_representative, maxId_target);
-        EdgeDifference<dType, T2> edgeDifference = this->getEdgeDifference(this->representative, genome);
-        dType excessDifference = edgeDifference.excess.size();
-        dType disjointDifference = edgeDifference.disjoint.size();
+        const EdgeDifferenceCount<dType, T2> edgeDifference = this->getEdgeDifferenceCount(this->representative, genome);
+        dType excessDifference = edgeDifference.excess;
+        dType disjointDifference = edgeDifference.disjoint;
         dType averageWeightDifference = this->getAverageWeightDifference(genome);
         // 
         T2 genes_representative = this->representative->getNumberOfGenes();
@@ -77,41 +130,77 @@ namespace NEAT {
         return (distance < threshold) ? distance : -1;
     }
 
-    template <typename dType, typename T2>
-    EdgeDifference<dType, T2> Species<dType, T2>::getEdgeDifference(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2) const {
-        if (genome1 == nullptr) {
-            std::cout << "genome1 is null" << std::endl;
+    /**
+     * @brief Walk the edges of genome1 against genome2 in innovation order
+     *
+     * visit(kind, edge1, edge2) is called for every edge of genome1 in order, kind is 0 for matching,
+     * 1 for disjoint and 2 for excess, edge2 is the matching edge of genome2 or nullptr.
+     */
+    template <typename dType, typename T2, typename Visitor>
+    static void walkEdgeDifference(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2, Visitor visit) {
+        if (genome1 == nullptr || genome2 == nullptr) {
+            throw std::invalid_argument("Species<dType, T2>::getEdgeDifference - genome is null");
         }
-        if (genome2 == nullptr) {
-            std::cout << "genome2 is null" << std::endl;
+        const T2 maxIdTarget = genome2->getMaxInnovationNumber();
+        const std::map<T2, Edge<dType, T2>*>& genome1Edge = genome1->getEdges();
+        const std::map<T2, Edge<dType, T2>*>& genome2Edge = genome2->getEdges();
+        typename std::map<T2, Edge<dType, T2>*>::const_iterator it2 = genome2Edge.begin();
+        for (const std::pair<const T2, Edge<dType, T2>*>& edgePair1 : genome1Edge) {
+            while (it2 != genome2Edge.end() && it2->first < edgePair1.first) {
+                ++it2;
+            }
+            if (it2 != genome2Edge.end() && it2->first == edgePair1.first) {
+                visit(0, edgePair1.second, it2->second);
+            } else if (edgePair1.first > maxIdTarget) {
+                visit(2, edgePair1.second, nullptr);
+            } else {
+                visit(1, edgePair1.second, nullptr);
+            }
         }
-        T2 maxIdTarget = genome2->getMaxInnovationNumber();
+    }
+
+    template <typename dType, typename T2>
+    EdgeDifference<dType, T2> Species<dType, T2>::getEdgeDifference(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2) const {
         EdgeDifference<dType, T2> edgeDifference;
-        const std::map<T2, NEAT::Edge<dType, T2>*>& genome1Edge = genome1->getEdges();
-        const std::map<T2, NEAT::Edge<dType, T2>*>& genome2Edge = genome2->getEdges();
-        for (const std::pair<const T2, Edge<dType, T2>*>& edgePair1 : genome1Edge) {
-            bool foundMatching = false;
-            const Edge<dType, T2>* edge1 = edgePair1.second;
-            if (edge1 == nullptr) {
-                std::cout << "edge1 is null" << std::endl;
+        walkEdgeDifference(genome1, genome2, [&edgeDifference](int kind, const Edge<dType, T2>* edge1, const Edge<dType, T2>*) {
+            if (kind == 0) {
+                edgeDifference.matching.push_back(edge1);
+            } else if (kind == 1) {
+                edgeDifference.disjoint.push_back(edge1);
+            } else {
+                edgeDifference.excess.push_back(edge1);
             }
-            for (const std::pair<const T2, Edge<dType, T2>*>& edgePair2 : genome2Edge) {
-                const Edge<dType, T2>* edge2 = edgePair2.second;
-                if (edge2 == nullptr) {
-                    std::cout << "edge2 is null" << std::endl;
-                }
-                if (edge1->getInnovationNumber() == edge2->getInnovationNumber()) {
-                    foundMatching = true;
-                    edgeDifference.matching.push_back(edge1);
-                    break;
-                }
+            });
+        return edgeDifference;
+    }
+
+    template <typename dType, typename T2>
+    EdgeDifferenceCount<dType, T2> Species<dType, T2>::getEdgeDifferenceCount(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2) const {
+        if (genome1 == nullptr || genome2 == nullptr) {
+            throw std::invalid_argument("Species<dType, T2>::getEdgeDifferenceCount - genome is null");
+        }
+        // same walk as walkEdgeDifference, over the innovation arrays of the flat genomes
+        EdgeDifferenceCount<dType, T2> edgeDifference;
+        const T2 maxIdTarget = genome2->getMaxInnovationNumber();
+        const FlatGenome<dType, T2>& flat1 = genome1->getFlatGenome();
+        const FlatGenome<dType, T2>& flat2 = genome2->getFlatGenome();
+        const std::vector<T2>& innovations1 = flat1.getInnovations();
+        const std::vector<T2>& innovations2 = flat2.getInnovations();
+        const std::vector<dType>& weights1 = flat1.getEdgeWeights();
+        const std::vector<dType>& weights2 = flat2.getEdgeWeights();
+        const std::size_t size2 = innovations2.size();
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < innovations1.size(); i++) {
+            while (j < size2 && innovations2[j] < innovations1[i]) {
+                j++;
             }
-            if (!foundMatching) {
-                if (edge1->getInnovationNumber() > maxIdTarget) {
-                    edgeDifference.excess.push_back(edge1);
-                } else {
-                    edgeDifference.disjoint.push_back(edge1);
-                }
+            if (j < size2 && innovations2[j] == innovations1[i]) {
+                edgeDifference.matching++;
+                edgeDifference.weightDifference += std::abs(weights1[i] - weights2[j]);
+            } else if (innovations1[i] > maxIdTarget) {
+                edgeDifference.excess++;
+            } else {
+                edgeDifference.disjoint++;
             }
         }
         return edgeDifference;
@@ -146,17 +235,10 @@ namespace NEAT {
 
     template <typename dType, typename T2>
     dType Species<dType, T2>::getAverageWeightDifference(const Genome<dType, T2>* genome) const {
-        dType averageWeight_target = 0;
-        dType averageWeight_representative = 0;
+        dType averageWeight_target = genome->getFlatGenome().getWeightSum();
+        dType averageWeight_representative = this->representative->getFlatGenome().getWeightSum();
         T2 genes_target = genome->getNumberOfGenes();
         T2 genes_representative = this->representative->getNumberOfGenes();
-        // 
-        for (std::pair<T2, Edge<dType, T2>*> edgePair : genome->getEdges()) {
-            averageWeight_target += edgePair.second->getWeight();
-        }
-        for (std::pair<T2, Edge<dType, T2>*> edgePair : this->representative->getEdges()) {
-            averageWeight_representative += edgePair.second->getWeight();
-        }
         // prevent division by zero
         const dType epsilon = 0.0000001;
         averageWeight_target /= genes_target + epsilon;
@@ -171,7 +253,7 @@ namespace NEAT {
         for (Genome<dType, T2>* genome : this->genomes) {
             genome->setFitness(genome->getFitness() / N);
         }
-        // totalFitness /= N;
+        totalFitness /= N;
     }
 
     template <typename dType, typename T2>
@@ -185,111 +267,76 @@ namespace NEAT {
     template <typename dType, typename T2>
     std::vector<Genome<dType, T2>*> Species<dType, T2>::generateNextGeneration(GeneHistory<dType, T2>& geneHistory, T2 n, const MutationConfig<dType>& mutationConfig) {
         std::vector<Genome<dType, T2>*> nextGeneration;
-        if (n == 1 || genomes.size() == 1) {
-            nextGeneration.push_back(this->getRandomGenome()->clone());
-            return nextGeneration;
-        }
-        if (n == 2 || genomes.size() == 2) {
-            nextGeneration.push_back(this->getRandomGenome()->clone());
-            nextGeneration.push_back(this->getRandomGenome()->clone());
-            return nextGeneration;
-        }
+        if (n <= 0) return nextGeneration;
         nextGeneration.reserve(n);
         sortGenomes();
         for (T2 i = 0; i < n; i++) {
-            std::vector<Genome<dType, T2>*> genomeList = this->genomes;
-            Genome<dType, T2>* newGenome = nullptr;
-            // TODO: break out of inf loop selecting the same genome
-            // TODO: vector of genome pointer to prevent while true loop
-            // std::cout << "Generating genome " << i << " of " << n << std::endl;
-            if (uniformDistribution<dType>(0, 1) < 0.25) { // 25% chance to get the same genome instead of getting one from crossover
-                newGenome = this->getRandomGenome()->clone();
-            } else {
-                const Genome<dType, T2>* genome1, * genome2;
-                genome1 = this->getRandomGenome();
-                genomeList.erase(std::find(genomeList.begin(), genomeList.end(), genome1));
-                genome2 = this->getRandomGenome(&genomeList);
-                newGenome = this->crossover(genome1, genome2);
-            }
-            newGenome->mutate(geneHistory, mutationConfig);
+            Genome<dType, T2>* newGenome = this->generateOffspring(n);
+            if (n > 2) newGenome->mutate(geneHistory, mutationConfig);
             nextGeneration.push_back(newGenome);
         }
         return nextGeneration;
     }
 
+    template <typename dType, typename T2>
+    Genome<dType, T2>* Species<dType, T2>::generateOffspring(T2 n) const {
+        // small quotas keep copies of their genomes
+        if (n <= 2) {
+            return this->getRandomGenome()->clone();
+        }
+        // TODO: break out of inf loop selecting the same genome
+        // TODO: vector of genome pointer to prevent while true loop
+        // 25% chance to get the same genome instead of getting one from crossover, crossover needs 2 genomes
+        if (genomes.size() < 2 || uniformDistribution<dType>(0, 1) < 0.25) {
+            return this->getRandomGenome()->clone();
+        }
+        std::vector<Genome<dType, T2>*> genomeList = this->genomes;
+        const Genome<dType, T2>* genome1, * genome2;
+        genome1 = this->getRandomGenome();
+        genomeList.erase(std::find(genomeList.begin(), genomeList.end(), genome1));
+        genome2 = this->getRandomGenome(&genomeList);
+        return this->crossover(genome1, genome2);
+    }
+
     template <typename dType, typename T2>
     Genome<dType, T2>* Species<dType, T2>::crossover(const Genome<dType, T2>* genome1, const Genome<dType, T2>* genome2) const {
-        // std::cout << "crossover" << std::endl;
-        // TODO: optimize
         // 1. get the genome with the higher fitness
         const Genome<dType, T2>* genome_higherFitness = (genome1->getFitness() > genome2->getFitness()) ? genome1 : genome2;
         const Genome<dType, T2>* genome_lowerFitness = (genome1->getFitness() > genome2->getFitness()) ? genome2 : genome1;
-        // 2. get the disjoint and excess genes of the genome with the higher fitness
-        const EdgeDifference<dType, T2> edgeDifference = getEdgeDifference(genome_higherFitness, genome_lowerFitness);
-        const std::vector<const Edge<dType, T2>*>& disjointGenes = edgeDifference.disjoint;
-        const std::vector<const Edge<dType, T2>*>& excessGenes = edgeDifference.excess;
-        // 3. get the matching genes of both genomes
-        const std::vector<const Edge<dType, T2>*>& matchingGenes = edgeDifference.matching;
-        // 4. clone edges of the disjoint and excess genome from the genome with the higher fitness
-        Genome<dType, T2>* offspring = new Genome<dType, T2>(genome_higherFitness->getInputSize(), genome_higherFitness->getOutputSize(), false);
-        for (const Edge<dType, T2>* edge : disjointGenes) {
-            offspring->addCloneEdge(edge);
-        }
-        for (const Edge<dType, T2>* edge : excessGenes) {
-            offspring->addCloneEdge(edge);
+        const FlatGenome<dType, T2>& fitter = genome_higherFitness->getFlatGenome();
+        const FlatGenome<dType, T2>& other = genome_lowerFitness->getFlatGenome();
+        std::shared_ptr<FlatGenome<dType, T2>> offspring = std::make_shared<FlatGenome<dType, T2>>(fitter.getInputSize(), fitter.getOutputSize());
+        // 2. every edge of the offspring comes from the genome with the higher fitness, so do its nodes,
+        //    node indices of the offspring are the node indices of that genome
+        const std::vector<T2>& nodeIds = fitter.getNodeIds();
+        for (std::uint32_t i = 0; i < fitter.getNodeCount(); i++) {
+            offspring->addNode(nodeIds[i], fitter.getNodeTypes()[i], fitter.getNodeLayers()[i], fitter.getNodeBiases()[i], fitter.getNodeActivations()[i]);
         }
-        // 5. clone edges of the matching genome from a random genome
-        for (const Edge<dType, T2>* edge : matchingGenes) {
-            const Genome<dType, T2>* randomGenome = (uniformDistribution<dType>(0, 1) < 0.5) ? genome1 : genome2;
-            Edge <dType, T2>* randomEdge = randomGenome->getEdge(edge->getInnovationNumber());
-            offspring->addCloneEdge(randomEdge);
-        }
-        // 6. build nodes from the edges
-        for (std::pair<T2, Edge<dType, T2>*> edgePair : offspring->getEdges()) {
-            const Edge<dType, T2>* edge = edgePair.second;
-            // do not use clone, because the edges will be cloned many times
-            // 1. check if the from node is within the offspring
-            // const Node<dType, T2>* originalFromNode = edge->getFrom(offspring); // TODO: should get from original genome
-            Node<dType, T2>* originalFromNode = edge->getFrom(genome_higherFitness);
-            if (originalFromNode == nullptr) {
-                originalFromNode = edge->getFrom(genome_lowerFitness);
-            }
-            Node<dType, T2>* fromNode = offspring->getNode(originalFromNode->getId());
-            if (fromNode == nullptr) {
-                // 2. if not, re produce the node
-                const T2& id = originalFromNode->getId();
-                const NodeType nodeType = originalFromNode->getType();
-                const dType bias = originalFromNode->getBias();
-                const int layer = originalFromNode->getLayer();
-                ActivationFunction<dType>* activationFunction = originalFromNode->getActivationFunction();
-                fromNode = new Node<dType, T2>(id, nodeType, layer, bias, activationFunction);
-                fromNode->addOutgoingEdge(const_cast<Edge<dType, T2>*>(edge));
-                offspring->addNode_noClone(fromNode);
-            } else {
-                fromNode->addOutgoingEdge(const_cast<Edge<dType, T2>*>(edge));
-            }
-            // 3. check if the to node is within the offspring
-            // const Node<dType, T2>* originalToNode = edge->getTo(offspring); // TODO: should get from original genome
-            Node<dType, T2>* originalToNode = edge->getTo(genome_higherFitness);
-            if (originalToNode == nullptr) {
-                originalToNode = edge->getTo(genome_lowerFitness);
+        // 3. merge walk, disjoint and excess edges are taken from the genome with the higher fitness,
+        //    matching edges from a random genome
+        const std::vector<T2>& innovations = fitter.getInnovations();
+        const std::vector<T2>& otherInnovations = other.getInnovations();
+        const std::uint32_t otherEdgeCount = other.getEdgeCount();
+        std::uint32_t j = 0;
+        for (std::uint32_t i = 0; i < fitter.getEdgeCount(); i++) {
+            while (j < otherEdgeCount && otherInnovations[j] < innovations[i]) {
+                j++;
             }
-            Node<dType, T2>* toNode = offspring->getNode(originalToNode->getId());
-            if (toNode == nullptr) {
-                // 4. if not, re produce the node
-                const T2& id = originalToNode->getId();
-                const NodeType nodeType = originalToNode->getType();
-                const dType bias = originalToNode->getBias();
-                const int layer = originalToNode->getLayer();
-                ActivationFunction<dType>* activationFunction = originalToNode->getActivationFunction();
-                toNode = new Node<dType, T2>(id, nodeType, layer, bias, activationFunction);
-                toNode->addIncomingEdge(const_cast<Edge<dType, T2>*>(edge));
-                offspring->addNode_noClone(toNode);
-            } else {
-                toNode->addIncomingEdge(const_cast<Edge<dType, T2>*>(edge));
+            dType weight = fitter.getEdgeWeights()[i];
+            bool enabled = fitter.isEnabled(i);
+            if (j < otherEdgeCount && otherInnovations[j] == innovations[i]) {
+                const Genome<dType, T2>* randomGenome = (uniformDistribution<dType>(0, 1) < 0.5) ? genome1 : genome2;
+                if (randomGenome == genome_lowerFitness) {
+                    weight = other.getEdgeWeights()[j];
+                    enabled = other.isEnabled(j);
+                }
             }
+            offspring->addEdge(innovations[i], fitter.getEdgeFrom()[i], fitter.getEdgeTo()[i], weight, enabled);
         }
-        return offspring;
+        // the edges are a subset of the edges of the genome with the higher fitness, so is its topological order
+        offspring->setNodeOrder(fitter.getNodeOrder());
+        // the offspring is stored as flat genes
+        return new Genome<dType, T2>(offspring);
     }
 
     template <typename dType, typename T2>
@@ -327,5 +374,7 @@ namespace NEAT {
     // Explicit instantiation
     template class Species<double, int>;
     template class Species<double, long>;
+    template class Species<float, int>;
+    template class Species<float, long>;
 
 }
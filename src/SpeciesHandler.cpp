@@ -1,6 +1,9 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
 // TODO: iostream should also output to python console
 
 #include "../include/NEAT/SpeciesHandler.hpp"
@@ -8,6 +11,9 @@
 #include "../include/NEAT/Genome.hpp"
 #include "../include/NEAT/Edge.hpp"
 #include "../include/NEAT/GeneHistory.hpp"
+#include "../include/NEAT/ThreadPool.hpp"
+#include "../include/NEAT/GeneArena.hpp"
+#include "../include/NEAT/Helper.hpp"
 
 namespace NEAT {
 
@@ -38,11 +44,20 @@ namespace NEAT {
     }
 
     template <typename dType, typename T2>
-    SpeciesHandler<dType, T2>::SpeciesHandler(std::vector<Genome<dType, T2>*>& genome, SpeciesConfig<dType> speciesConfig) :
+    SpeciesHandler<dType, T2>::SpeciesHandler(std::vector<Genome<dType, T2>*>& genome, SpeciesConfig<dType> speciesConfig, ThreadPool* threadPool) :
         c1(speciesConfig.c1), c2(speciesConfig.c2), c3(speciesConfig.c3), threshold(speciesConfig.threshold) {
-        this->addGenome(genome);
+        if (threadPool != nullptr) {
+            this->addGenome(genome, *threadPool);
+        } else {
+            this->addGenome(genome);
+        }
     }
 
+    template <typename dType, typename T2>
+    SpeciesHandler<dType, T2>::SpeciesHandler(SpeciesConfig<dType> speciesConfig) :
+        c1(speciesConfig.c1), c2(speciesConfig.c2), c3(speciesConfig.c3), threshold(speciesConfig.threshold),
+        stagnationLimit(speciesConfig.stagnationLimit) {}
+
     template <typename dType, typename T2>
     SpeciesHandler<dType, T2>::~SpeciesHandler() {
         for (Species<dType, T2>* s : species) {
@@ -50,9 +65,14 @@ namespace NEAT {
         }
     }
 
-
     template <typename dType, typename T2>
     void SpeciesHandler<dType, T2>::addGenome(Genome<dType, T2>* genome) {
+        // most genomes belong to the species of their parent
+        Species<dType, T2>* hint = this->findSpecies(genome->getSpeciesId());
+        if (hint != nullptr && hint->getDistance(genome, c1, c2, c3) <= threshold) {
+            hint->addGenome(genome);
+            return;
+        }
         dType distance = -1;
         Species<dType, T2>* closest = nullptr;
         for (Species<dType, T2>* s : species) {
@@ -62,11 +82,7 @@ namespace NEAT {
                 closest = s;
             }
         }
-        if (closest == nullptr || distance > threshold) {
-            species.push_back(new Species<dType, T2>(genome));
-        } else {
-            closest->addGenome(genome);
-        }
+        this->placeGenome(genome, closest, distance);
     }
 
     template <typename dType, typename T2>
@@ -77,33 +93,238 @@ namespace NEAT {
     }
 
     template <typename dType, typename T2>
-    std::vector<Genome<dType, T2>*> SpeciesHandler<dType, T2>::reproduce(T2 n, const MutationConfig<dType>& mutationConfig) const {
-        GeneHistory<dType, T2> geneHistory = GeneHistory<dType, T2>();
-        //TODO: threading
+    void SpeciesHandler<dType, T2>::addGenome(std::vector<Genome<dType, T2>*>& genomes, ThreadPool& threadPool) {
+        const std::size_t count = genomes.size();
+        std::vector<Species<dType, T2>*> assigned(count, nullptr);
+        // 1. distances to the species of the parents
+        std::vector<Species<dType, T2>*> hints(count, nullptr);
+        std::vector<dType> hintDistances(count, 0);
+        for (std::size_t i = 0; i < count; i++) {
+            hints[i] = this->findSpecies(genomes[i]->getSpeciesId());
+        }
+        threadPool.parallelFor(count, [&](std::size_t i, unsigned int) {
+            if (hints[i] != nullptr) hintDistances[i] = hints[i]->getDistance(genomes[i], c1, c2, c3);
+            });
+        std::vector<std::size_t> misses;
+        for (std::size_t i = 0; i < count; i++) {
+            if (hints[i] != nullptr && hintDistances[i] <= threshold) {
+                assigned[i] = hints[i];
+            } else {
+                misses.push_back(i);
+            }
+        }
+        // 2. distances of a block of the remaining genomes to all species
+        // number of distances computed per block, small blocks keep the cached distances fresh
+        const std::size_t blockSize = static_cast<std::size_t>(threadPool.getNumThreads()) * 1024;
+        std::vector<dType> distances;
+        std::size_t next = 0;
+        while (next < misses.size()) {
+            const std::size_t columns = species.size();
+            if (columns == 0) {
+                Genome<dType, T2>* genome = genomes[misses[next]];
+                assigned[misses[next++]] = this->placeGenome(genome, nullptr, -1);
+                continue;
+            }
+            const std::size_t rows = std::min(misses.size() - next, std::max<std::size_t>(1, blockSize / columns));
+            distances.resize(rows * columns);
+            threadPool.parallelFor(rows * columns, [&](std::size_t i, unsigned int) {
+                distances[i] = species[i % columns]->getDistance(genomes[misses[next + i / columns]], c1, c2, c3);
+                });
+            // 3. place the genomes in order, species created within the block are compared on the calling thread
+            // the block ends early once half as many species have been created as there were at its start
+            const std::size_t maxCreated = std::max<std::size_t>(1, columns / 2);
+            std::size_t row = 0;
+            while (row < rows && species.size() - columns < maxCreated) {
+                Genome<dType, T2>* genome = genomes[misses[next + row]];
+                dType distance = -1;
+                Species<dType, T2>* closest = nullptr;
+                for (std::size_t c = 0; c < species.size(); c++) {
+                    Species<dType, T2>* s = species[c];
+                    dType temp_distance = (c < columns) ? distances[row * columns + c] : s->getDistance(genome, c1, c2, c3);
+                    if (distance == -1 || temp_distance < distance) {
+                        distance = temp_distance;
+                        closest = s;
+                    }
+                }
+                assigned[misses[next + row]] = this->placeGenome(genome, closest, distance);
+                row++;
+            }
+            next += row;
+        }
+        // 4. add the genomes in population order, the same order as adding them one by one
+        for (Species<dType, T2>* s : species) {
+            s->clearGenomes();
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            assigned[i]->addGenome(genomes[i]);
+        }
+    }
+
+    template <typename dType, typename T2>
+    Species<dType, T2>* SpeciesHandler<dType, T2>::placeGenome(Genome<dType, T2>* genome, Species<dType, T2>* closest, dType distance) {
+        if (closest == nullptr || distance > threshold) {
+            Species<dType, T2>* s = new Species<dType, T2>(genome, nextSpeciesId++);
+            species.push_back(s);
+            speciesById[s->getId()] = s;
+            return s;
+        }
+        closest->addGenome(genome);
+        return closest;
+    }
+
+    template <typename dType, typename T2>
+    Species<dType, T2>* SpeciesHandler<dType, T2>::findSpecies(T2 id) const {
+        typename std::unordered_map<T2, Species<dType, T2>*>::const_iterator it = speciesById.find(id);
+        return (it == speciesById.end()) ? nullptr : it->second;
+    }
+
+    template <typename dType, typename T2>
+    void SpeciesHandler<dType, T2>::speciate(std::vector<Genome<dType, T2>*>& genomes, ThreadPool* threadPool) {
+        // 1. species keep their representative from the last generation
+        this->clearGenomes();
+        if (threadPool != nullptr) {
+            this->addGenome(genomes, *threadPool);
+        } else {
+            this->addGenome(genomes);
+        }
+        // 2. remove species without genomes and update the statistics of the others
+        std::vector<Species<dType, T2>*> alive;
+        alive.reserve(species.size());
+        for (Species<dType, T2>* s : species) {
+            if (s->getGenomes().empty()) {
+                speciesById.erase(s->getId());
+                delete s;
+                continue;
+            }
+            s->updateStatistics();
+            alive.push_back(s);
+        }
+        species.swap(alive);
+        // 3. cull stagnant species, the species with the best fitness is always kept
+        if (stagnationLimit == 0 || species.empty()) return;
+        Species<dType, T2>* best = species[0];
+        for (Species<dType, T2>* s : species) {
+            if (s->getBestFitness() > best->getBestFitness()) best = s;
+        }
+        alive.clear();
+        for (Species<dType, T2>* s : species) {
+            if (s != best && s->getStagnation() >= static_cast<T2>(stagnationLimit)) {
+                speciesById.erase(s->getId());
+                delete s;
+                continue;
+            }
+            alive.push_back(s);
+        }
+        species.swap(alive);
+    }
+
+    template <typename dType, typename T2>
+    void SpeciesHandler<dType, T2>::clearGenomes() {
+        for (Species<dType, T2>* s : species) {
+            s->clearGenomes();
+        }
+    }
+
+    template <typename dType, typename T2>
+    void SpeciesHandler<dType, T2>::setSpeciesConfig(SpeciesConfig<dType> speciesConfig) {
+        this->c1 = speciesConfig.c1;
+        this->c2 = speciesConfig.c2;
+        this->c3 = speciesConfig.c3;
+        this->threshold = speciesConfig.threshold;
+        this->stagnationLimit = speciesConfig.stagnationLimit;
+    }
+
+    template <typename dType, typename T2>
+    const std::vector<Species<dType, T2>*>& SpeciesHandler<dType, T2>::getSpecies() const {
+        return species;
+    }
+
+    template <typename dType, typename T2>
+    std::vector<Genome<dType, T2>*> SpeciesHandler<dType, T2>::reproduce(T2 n, const MutationConfig<dType>& mutationConfig, GeneHistory<dType, T2>& geneHistory, T2 generation, ThreadPool* threadPool) const {
         if (n <= 0) {
             n = 200;
             std::cout << "Warning: n <= 0, setting n to 200" << std::endl;
         }
         std::vector<Genome<dType, T2>*> nextGeneration = std::vector<Genome<dType, T2>*>();
+        nextGeneration.reserve(n);
+        const std::size_t speciesSize = species.size();
+        if (speciesSize == 0) return nextGeneration;
         // fitness sharing
         for (Species<dType, T2>* s : species) {
             s->fitnessShare();
         }
-        // reproduce
-        const dType averageFitness = this->getAverageFitnessSum();
-        const int speciesSize = species.size();
-        int produced = 0;
-        for (int i = 0; i < speciesSize; i++) {
-            Species<dType, T2>* s = species[i];
-            T2 numberToReproduce = static_cast<T2>(s->getAverageFitness() / (averageFitness * n + 0.00000000001));
-            if (speciesSize == i + 1) {
-                numberToReproduce = n - produced;
-                numberToReproduce = numberToReproduce < 0 ? 0 : numberToReproduce;
+        // number of offspring is proportional to the average shared fitness, remainders go to the largest fractions
+        std::vector<dType> shares(speciesSize);
+        dType shareSum = 0;
+        for (std::size_t i = 0; i < speciesSize; i++) {
+            shares[i] = std::max<dType>(0, species[i]->getAverageFitness());
+            shareSum += shares[i];
+        }
+        std::vector<T2> numberToReproduce(speciesSize);
+        std::vector<std::pair<dType, std::size_t>> remainders(speciesSize);
+        T2 produced = 0;
+        for (std::size_t i = 0; i < speciesSize; i++) {
+            const dType exact = (shareSum > 0) ? shares[i] * n / shareSum : static_cast<dType>(n) / speciesSize;
+            numberToReproduce[i] = static_cast<T2>(exact);
+            remainders[i] = { exact - numberToReproduce[i], i };
+            produced += numberToReproduce[i];
+        }
+        std::stable_sort(remainders.begin(), remainders.end(), [](const std::pair<dType, std::size_t>& a, const std::pair<dType, std::size_t>& b) {
+            return a.first > b.first;
+            });
+        for (std::size_t i = 0; produced < n; i = (i + 1) % speciesSize, produced++) {
+            numberToReproduce[remainders[i].second]++;
+        }
+        // parent species and quota of every offspring
+        std::vector<const Species<dType, T2>*> parents;
+        std::vector<T2> quotas;
+        parents.reserve(n);
+        quotas.reserve(n);
+        for (std::size_t i = 0; i < speciesSize; i++) {
+            species[i]->sortGenomes();
+            for (T2 j = 0; j < numberToReproduce[i]; j++) {
+                parents.push_back(species[i]);
+                quotas.push_back(numberToReproduce[i]);
+            }
+        }
+        const std::size_t offspringCount = parents.size();
+        nextGeneration.resize(offspringCount, nullptr);
+        // every offspring draws from its own stream per phase, so the result does not depend on the thread count
+        const std::uint64_t seed = getSeed();
+        // workers allocate the offspring from the arena of the calling thread
+        GeneArena* arena = GeneArena::getActive();
+        const std::function<void(std::size_t, const std::function<void(std::size_t)>&)> forEachOffspring =
+            [threadPool, arena](std::size_t count, const std::function<void(std::size_t)>& task) {
+            if (threadPool == nullptr) {
+                for (std::size_t k = 0; k < count; k++) task(k);
+            } else {
+                threadPool->parallelFor(count, [&task, arena](std::size_t k, unsigned int) {
+                    GeneArenaScope arenaScope(arena);
+                    task(k);
+                    });
             }
-            std::vector<Genome<dType, T2>*> tempGeneration = s->generateNextGeneration(geneHistory, numberToReproduce, mutationConfig);
-            nextGeneration.insert(nextGeneration.end(), tempGeneration.begin(), tempGeneration.end());
-            produced += numberToReproduce;
+            };
+        // 1. crossover, only reads the parents
+        forEachOffspring(offspringCount, [&](std::size_t k) {
+            RandomStream stream(seed, generation, k, 0);
+            RandomStreamScope scope(stream);
+            nextGeneration[k] = parents[k]->generateOffspring(quotas[k]);
+            nextGeneration[k]->setSpeciesId(parents[k]->getId());
+            });
+        // 2. structural mutation in offspring order, the gene history gives out innovation numbers in this order
+        for (std::size_t k = 0; k < offspringCount; k++) {
+            if (quotas[k] <= 2) continue;
+            RandomStream stream(seed, generation, k, 1);
+            RandomStreamScope scope(stream);
+            nextGeneration[k]->mutateStructure(geneHistory, mutationConfig);
         }
+        // 3. parameter mutation, only touches the offspring
+        forEachOffspring(offspringCount, [&](std::size_t k) {
+            if (quotas[k] <= 2) return;
+            RandomStream stream(seed, generation, k, 2);
+            RandomStreamScope scope(stream);
+            nextGeneration[k]->mutateParameters(mutationConfig);
+            });
         return nextGeneration;
     }
 
@@ -129,4 +350,6 @@ namespace NEAT {
     // Explicit instantiation
     template class SpeciesHandler<double, int>;
     template class SpeciesHandler<double, long>;
+    template class SpeciesHandler<float, int>;
+    template class SpeciesHandler<float, long>;
 }
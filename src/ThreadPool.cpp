@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "../include/NEAT/ThreadPool.hpp"
+
+namespace NEAT {
+
+    // set while a thread is running tasks of a loop, nested loops then run serially
+    static thread_local bool insideLoop = false;
+
+    ThreadPool::ThreadPool(unsigned int numThreads) : numThreads(resolveNumThreads(numThreads)) {
+        workers.reserve(this->numThreads - 1);
+        for (unsigned int i = 1; i < this->numThreads; i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeCondition.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned int ThreadPool::getNumThreads() const {
+        return numThreads;
+    }
+
+    unsigned int ThreadPool::resolveNumThreads(unsigned int numThreads) {
+        if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+        return numThreads == 0 ? 1 : numThreads;
+    }
+
+    void ThreadPool::parallelFor(std::size_t n, const std::function<void(std::size_t, unsigned int)>& task) {
+        if (n == 0) return;
+        if (workers.empty() || insideLoop || n == 1) {
+            for (std::size_t i = 0; i < n; i++) {
+                task(i, 0);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> runLock(runMutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->task = &task;
+            this->taskCount = n;
+            // several chunks per thread keep the load balanced without contending on the counter
+            this->chunkSize = std::max<std::size_t>(1, n / (static_cast<std::size_t>(numThreads) * 8));
+            this->exception = nullptr;
+            this->pendingWorkers = static_cast<unsigned int>(workers.size());
+            this->nextIndex.store(0);
+            this->jobId++;
+        }
+        wakeCondition.notify_all();
+        runTasks(0);
+        std::exception_ptr thrown;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            doneCondition.wait(lock, [this]() { return pendingWorkers == 0; });
+            this->task = nullptr;
+            thrown = this->exception;
+            this->exception = nullptr;
+        }
+        if (thrown) std::rethrow_exception(thrown);
+    }
+
+    void ThreadPool::workerLoop(unsigned int thread) {
+        std::uint64_t seenJob = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeCondition.wait(lock, [this, seenJob]() { return stopping || jobId != seenJob; });
+                if (stopping) return;
+                seenJob = jobId;
+            }
+            runTasks(thread);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pendingWorkers == 0) doneCondition.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::runTasks(unsigned int thread) {
+        insideLoop = true;
+        while (true) {
+            const std::size_t begin = nextIndex.fetch_add(chunkSize);
+            if (begin >= taskCount) break;
+            const std::size_t end = std::min(begin + chunkSize, taskCount);
+            try {
+                for (std::size_t i = begin; i < end; i++) {
+                    (*task)(i, thread);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!exception) exception = std::current_exception();
+                // skip the remaining iterations
+                nextIndex.store(taskCount);
+            }
+        }
+        insideLoop = false;
+    }
+}
@@ -0,0 +1,129 @@
+#include <stdexcept>
+
+#include "../include/NEAT/TopologyGroup.hpp"
+#include "../include/NEAT/SimdKernels.hpp"
+
+namespace NEAT {
+
+    template <typename dType, typename T2>
+    TopologyGroup<dType, T2>::TopologyGroup(const std::vector<std::shared_ptr<const ExecutionPlan<dType, T2>>>& plans) :
+        structure(plans.empty() ? nullptr : plans[0]), lanes(plans.size()) {
+        if (structure == nullptr) {
+            throw std::invalid_argument("TopologyGroup<dType, T2>::TopologyGroup - no plans");
+        }
+        const std::uint32_t nodeCount = structure->getNodeCount();
+        const std::uint32_t edgeCount = structure->getEdgeCount();
+        biases.resize(static_cast<std::size_t>(nodeCount) * lanes);
+        weights.resize(static_cast<std::size_t>(edgeCount) * lanes);
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            const ExecutionPlan<dType, T2>& plan = *plans[lane];
+            if (!plan.hasSameStructure(*structure)) {
+                throw std::invalid_argument("TopologyGroup<dType, T2>::TopologyGroup - plans differ in structure");
+            }
+            for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+                biases[slot * lanes + lane] = plan.getBiases()[slot];
+            }
+            for (std::uint32_t e = 0; e < edgeCount; e++) {
+                weights[e * lanes + lane] = plan.getEdgeWeights()[e];
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    void TopologyGroup<dType, T2>::evaluate(const dType* inputs, dType* outputs, const std::size_t* rows, ActivationWorkspace<dType>& workspace) const {
+        const std::uint32_t nodeCount = structure->getNodeCount();
+        const std::size_t inputSize = static_cast<std::size_t>(structure->getInputSize());
+        const std::size_t outputSize = static_cast<std::size_t>(structure->getOutputSize());
+        const std::vector<std::uint32_t>& edgeOffsets = structure->getEdgeOffsets();
+        const std::vector<std::uint32_t>& edgeSources = structure->getEdgeSources();
+        const std::vector<ActivationType>& activations = structure->getActivations();
+        const std::vector<std::uint32_t>& inputSlots = structure->getInputSlots();
+        const std::vector<std::uint32_t>& outputSlots = structure->getOutputSlots();
+        // node values are slot-major, the value of a slot is a contiguous vector over the lanes
+        std::vector<dType>& values = workspace.values;
+        values.assign(static_cast<std::size_t>(nodeCount) * lanes, 0);
+        for (std::size_t i = 0; i < inputSize; i++) {
+            dType* target = values.data() + static_cast<std::size_t>(inputSlots[i]) * lanes;
+            for (std::size_t lane = 0; lane < lanes; lane++) {
+                target[lane] = inputs[rows[lane] * inputSize + i];
+            }
+        }
+        std::vector<const dType*>& sources = workspace.sources;
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            dType* target = values.data() + static_cast<std::size_t>(slot) * lanes;
+            sources.clear();
+            for (std::uint32_t e = edgeOffsets[slot]; e < edgeOffsets[slot + 1]; e++) {
+                sources.push_back(values.data() + static_cast<std::size_t>(edgeSources[e]) * lanes);
+            }
+            SimdKernels::laneWeightedSum(target, lanes, biases.data() + static_cast<std::size_t>(slot) * lanes, sources.data(),
+                weights.data() + static_cast<std::size_t>(edgeOffsets[slot]) * lanes, sources.size());
+            SimdKernels::activate(activations[slot], target, lanes);
+        }
+        for (std::size_t i = 0; i < outputSize; i++) {
+            const dType* source = values.data() + static_cast<std::size_t>(outputSlots[i]) * lanes;
+            for (std::size_t lane = 0; lane < lanes; lane++) {
+                outputs[rows[lane] * outputSize + i] = source[lane];
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    void TopologyGroup<dType, T2>::evaluateBatch(const dType* inputs, std::size_t rows, dType* outputs, ActivationWorkspace<dType>& workspace) const {
+        const std::uint32_t nodeCount = structure->getNodeCount();
+        const std::size_t inputSize = static_cast<std::size_t>(structure->getInputSize());
+        const std::size_t outputSize = static_cast<std::size_t>(structure->getOutputSize());
+        const std::vector<std::uint32_t>& edgeOffsets = structure->getEdgeOffsets();
+        const std::vector<std::uint32_t>& edgeSources = structure->getEdgeSources();
+        const std::vector<ActivationType>& activations = structure->getActivations();
+        const std::vector<std::uint32_t>& inputSlots = structure->getInputSlots();
+        const std::vector<std::uint32_t>& outputSlots = structure->getOutputSlots();
+        // node values are slot-major, then row-major, the value of a slot in a row is a contiguous vector over the lanes
+        const std::size_t slotSize = rows * lanes;
+        std::vector<dType>& values = workspace.values;
+        values.assign(static_cast<std::size_t>(nodeCount) * slotSize, 0);
+        for (std::size_t i = 0; i < inputSize; i++) {
+            dType* target = values.data() + static_cast<std::size_t>(inputSlots[i]) * slotSize;
+            for (std::size_t r = 0; r < rows; r++) {
+                std::fill(target + r * lanes, target + (r + 1) * lanes, inputs[r * inputSize + i]);
+            }
+        }
+        std::vector<const dType*>& sources = workspace.sources;
+        for (std::uint32_t slot = 0; slot < nodeCount; slot++) {
+            dType* target = values.data() + static_cast<std::size_t>(slot) * slotSize;
+            const std::uint32_t edgeCount = edgeOffsets[slot + 1] - edgeOffsets[slot];
+            sources.resize(edgeCount);
+            for (std::size_t r = 0; r < rows; r++) {
+                for (std::uint32_t e = 0; e < edgeCount; e++) {
+                    sources[e] = values.data() + static_cast<std::size_t>(edgeSources[edgeOffsets[slot] + e]) * slotSize + r * lanes;
+                }
+                SimdKernels::laneWeightedSum(target + r * lanes, lanes, biases.data() + static_cast<std::size_t>(slot) * lanes, sources.data(),
+                    weights.data() + static_cast<std::size_t>(edgeOffsets[slot]) * lanes, edgeCount);
+            }
+            SimdKernels::activate(activations[slot], target, slotSize);
+        }
+        for (std::size_t i = 0; i < outputSize; i++) {
+            const dType* source = values.data() + static_cast<std::size_t>(outputSlots[i]) * slotSize;
+            for (std::size_t r = 0; r < rows; r++) {
+                for (std::size_t lane = 0; lane < lanes; lane++) {
+                    outputs[(lane * rows + r) * outputSize + i] = source[r * lanes + lane];
+                }
+            }
+        }
+    }
+
+    template <typename dType, typename T2>
+    std::size_t TopologyGroup<dType, T2>::getLaneCount() const {
+        return lanes;
+    }
+
+    template <typename dType, typename T2>
+    const ExecutionPlan<dType, T2>& TopologyGroup<dType, T2>::getStructure() const {
+        return *structure;
+    }
+
+    // Explicit instantiation
+    template class TopologyGroup<double, int>;
+    template class TopologyGroup<double, long>;
+    template class TopologyGroup<float, int>;
+    template class TopologyGroup<float, long>;
+}
@@ -4,11 +4,13 @@
 #include "../lib/pybind11/include/pybind11/pybind11.h"
 #include "../lib/pybind11/include/pybind11/stl.h"
 #include "../lib/pybind11/include/pybind11/functional.h"
+#include "../lib/pybind11/include/pybind11/numpy.h"
 // 
 #include "../include/NEAT/Genome.hpp"
 #include "../include/NEAT/Population.hpp"
 #include "../include/NEAT/SpeciesHandler.hpp"
 #include "../include/NEAT/Helper.hpp"
+#include "../include/NEAT/HeaderExporter.hpp"
 // 
 
 namespace py = pybind11;
@@ -17,56 +19,206 @@ int add(int i, int j) {
   return i + j;
 }
 
-PYBIND11_MODULE(_neatcpy, m) {
-  m.doc() = "NEATCPP Python Bindings";
+/**
+ * @brief C-contiguous NumPy array of dType, arrays of another type or layout are converted once
+ *
+ * @tparam dType type of data
+ */
+template <typename dType>
+using NumpyArray = py::array_t<dType, py::array::c_style | py::array::forcecast>;
 
-  m.def("add", &add, "A function which adds two numbers");
+/**
+ * @brief Evaluate a genome for every row of a 2-D array, reading the inputs in place and writing into a new array
+ *
+ * @param genome genome to evaluate
+ * @param inputs array of shape (rows, inputSize)
+ * @return py::array_t<dType> array of shape (rows, outputSize)
+ */
+template <typename dType>
+py::array_t<dType> feedForwardBatch(const NEAT::Genome<dType, int>& genome, const NumpyArray<dType>& inputs) {
+  if (inputs.ndim() != 2 || inputs.shape(1) != genome.getInputSize()) {
+    throw std::invalid_argument("Genome.feedForwardBatch - inputs must be a 2-D array of shape (rows, inputSize)");
+  }
+  const std::size_t rows = static_cast<std::size_t>(inputs.shape(0));
+  py::array_t<dType> outputs({ static_cast<py::ssize_t>(rows), static_cast<py::ssize_t>(genome.getOutputSize()) });
+  const dType* inputData = inputs.data();
+  dType* outputData = outputs.mutable_data();
+  {
+    py::gil_scoped_release release;
+    // the const overload keeps concurrent calls from python threads on one genome apart
+    thread_local NEAT::ActivationWorkspace<dType> workspace;
+    genome.feedForwardBatch(inputData, rows, outputData, workspace);
+  }
+  return outputs;
+}
+
+/**
+ * @brief Set the fitness of the genomes from a 1-D array read in place and start the next generation
+ *
+ * @param population population to advance
+ * @param populationSize size of the next generation
+ * @param fitnesses array of at least populationSize fitness values
+ */
+template <typename dType>
+const std::vector<NEAT::Genome<dType, int>*>& startNextGeneration(NEAT::Population<dType, int>& population, int populationSize, const NumpyArray<dType>& fitnesses) {
+  if (fitnesses.ndim() != 1) {
+    throw std::invalid_argument("Population.startNextGeneration - fitnesses must be a 1-D array");
+  }
+  const dType* data = fitnesses.data();
+  const std::size_t count = static_cast<std::size_t>(fitnesses.shape(0));
+  py::gil_scoped_release release;
+  return population.startNextGeneration(populationSize, data, count);
+}
+
+/**
+ * @brief Evaluate all genomes with a Python fitness function
+ *
+ * The genomes are passed by reference, pybind11 would copy a Genome& otherwise. The GIL is released while the
+ * threads run and taken by each call of the fitness function.
+ *
+ * @param population population to evaluate
+ * @param fitnessFunction callable taking a Genome and returning its fitness
+ * @param numThreads number of threads, 0 uses the hardware concurrency
+ */
+template <typename dType>
+void evaluate(NEAT::Population<dType, int>& population, const py::function& fitnessFunction, unsigned int numThreads) {
+  py::gil_scoped_release release;
+  population.evaluate([&fitnessFunction](NEAT::Genome<dType, int>& genome) {
+    py::gil_scoped_acquire acquire;
+    return fitnessFunction(py::cast(&genome, py::return_value_policy::reference)).template cast<dType>();
+    }, numThreads);
+}
+
+/**
+ * @brief Evaluate all genomes on a supervised dataset of 2-D arrays read in place
+ *
+ * @param population population to evaluate
+ * @param inputs array of shape (rows, inputSize)
+ * @param targets array of shape (rows, outputSize)
+ * @param numThreads number of threads, 0 uses the hardware concurrency
+ */
+template <typename dType>
+void evaluateSupervised(NEAT::Population<dType, int>& population, const NumpyArray<dType>& inputs, const NumpyArray<dType>& targets, unsigned int numThreads) {
+  if (inputs.ndim() != 2 || inputs.shape(1) != population.getInputSize()) {
+    throw std::invalid_argument("Population.evaluateSupervised - inputs must be a 2-D array of shape (rows, inputSize)");
+  }
+  if (targets.ndim() != 2 || targets.shape(0) != inputs.shape(0) || targets.shape(1) != population.getOutputSize()) {
+    throw std::invalid_argument("Population.evaluateSupervised - targets must be a 2-D array of shape (rows, outputSize)");
+  }
+  const dType* inputData = inputs.data();
+  const dType* targetData = targets.data();
+  const std::size_t rows = static_cast<std::size_t>(inputs.shape(0));
+  py::gil_scoped_release release;
+  population.evaluateSupervised(inputData, targetData, rows, numThreads);
+}
 
+/**
+ * @brief Check that observations hold one row of inputSize values per genome
+ *
+ */
+template <typename dType>
+void checkObservations(const NEAT::Population<dType, int>& population, const NumpyArray<dType>& observations) {
+  if (observations.ndim() != 2 || observations.shape(0) != static_cast<py::ssize_t>(population.getGenomes().size()) || observations.shape(1) != population.getInputSize()) {
+    throw std::invalid_argument("Population.step - observations must be a 2-D array of shape (genomes, inputSize)");
+  }
+}
 
-  auto pyMutationConfig = py::class_ <NEAT::MutationConfig<double>>(m, "MutationConfig");
-  auto pySpeciesConfig = py::class_ <NEAT::SpeciesConfig<double>>(m, "SpeciesConfig");
-  auto pyPopulation = py::class_<NEAT::Population<double, int>>(m, "Population");
-  auto pyGenome = py::class_<NEAT::Genome<double, int>>(m, "Genome");
-  auto pyEdge = py::class_<NEAT::Edge<double, int>>(m, "Edge");
-  auto pyNode = py::class_<NEAT::Node<double, int>>(m, "Node");
-  auto pyGeneHistory = py::class_<NEAT::GeneHistory<double, int>>(m, "GeneHistory");
+/**
+ * @brief Evaluate every genome on its own row of observations, one crossing into C++ per step
+ *
+ * @param population population to evaluate
+ * @param observations array of shape (genomes, inputSize)
+ * @param numThreads number of threads, 0 uses the hardware concurrency
+ * @return py::array_t<dType> actions of shape (genomes, outputSize)
+ */
+template <typename dType>
+py::array_t<dType> step(NEAT::Population<dType, int>& population, const NumpyArray<dType>& observations, unsigned int numThreads) {
+  checkObservations(population, observations);
+  py::array_t<dType> actions({ observations.shape(0), static_cast<py::ssize_t>(population.getOutputSize()) });
+  const dType* observationData = observations.data();
+  dType* actionData = actions.mutable_data();
+  {
+    py::gil_scoped_release release;
+    population.step(observationData, actionData, numThreads);
+  }
+  return actions;
+}
+
+/**
+ * @brief Get the index of the largest output of every genome on its own row of observations
+ *
+ * @param population population to evaluate
+ * @param observations array of shape (genomes, inputSize)
+ * @param numThreads number of threads, 0 uses the hardware concurrency
+ * @return py::array_t<int> index of the largest output of each genome
+ */
+template <typename dType>
+py::array_t<int> stepPredict(NEAT::Population<dType, int>& population, const NumpyArray<dType>& observations, unsigned int numThreads) {
+  checkObservations(population, observations);
+  py::array_t<int> actions(observations.shape(0));
+  const dType* observationData = observations.data();
+  int* actionData = actions.mutable_data();
+  {
+    py::gil_scoped_release release;
+    population.stepPredict(observationData, actionData, numThreads);
+  }
+  return actions;
+}
+
+/**
+ * @brief Bind the classes of one data type into a module
+ *
+ * @tparam dType type of data of the bound classes
+ */
+template <typename dType>
+void defineModule(py::module_& m) {
+  auto pyMutationConfig = py::class_ <NEAT::MutationConfig<dType>>(m, "MutationConfig");
+  auto pySpeciesConfig = py::class_ <NEAT::SpeciesConfig<dType>>(m, "SpeciesConfig");
+  auto pyPopulation = py::class_<NEAT::Population<dType, int>>(m, "Population");
+  auto pyGenome = py::class_<NEAT::Genome<dType, int>>(m, "Genome");
+  auto pyEdge = py::class_<NEAT::Edge<dType, int>>(m, "Edge");
+  auto pyNode = py::class_<NEAT::Node<dType, int>>(m, "Node");
+  auto pyGeneHistory = py::class_<NEAT::GeneHistory<dType, int>>(m, "GeneHistory");
   // 
 
-  m.def("gaussianDistribution", &NEAT::gaussianDistribution<double>, py::arg("mean"), py::arg("stdDeviation"));
+  m.def("gaussianDistribution", &NEAT::gaussianDistribution<dType>, py::arg("mean"), py::arg("stdDeviation"));
 
-  m.def("setRandomSeed", &NEAT::setRandomSeed);
-  m.def("setSeed", &NEAT::setSeed);
-  m.def("getSeed", &NEAT::getSeed, py::return_value_policy::copy);
   // 
-  pyMutationConfig.def(py::init<double, double, double, double, double, double>(),
+  pyMutationConfig.def(py::init<dType, dType, dType, dType, dType, dType, unsigned int>(),
     py::arg("nodeMutationChance") = 0.03,
     py::arg("edgeMutationChance") = 0.05,
     py::arg("toggleEdgeMutationChance") = 0.05,
     py::arg("weightMutationChance") = 0.8,
     py::arg("activationMutationChance") = 0.1,
-    py::arg("biasMutationChance") = 0.1
+    py::arg("biasMutationChance") = 0.1,
+    py::arg("innovationMaxAge") = 1
   )
-    .def_readwrite("nodeMutationChance", &NEAT::MutationConfig<double>::mutateAddNodeProbability)
-    .def_readwrite("edgeMutationChance", &NEAT::MutationConfig<double>::mutateAddEdgeProbability)
-    .def_readwrite("toggleEdgeMutationChance", &NEAT::MutationConfig<double>::mutateToggleEdgeProbability)
-    .def_readwrite("weightMutationChance", &NEAT::MutationConfig<double>::mutateWeightProbability)
-    .def_readwrite("activationMutationChance", &NEAT::MutationConfig<double>::mutateActivationFunctionProbability)
-    .def_readwrite("biasMutationChance", &NEAT::MutationConfig<double>::mutateBiasProbability);
-
-  pySpeciesConfig.def(py::init<double, double, double, double>(),
+    .def_readwrite("nodeMutationChance", &NEAT::MutationConfig<dType>::mutateAddNodeProbability)
+    .def_readwrite("edgeMutationChance", &NEAT::MutationConfig<dType>::mutateAddEdgeProbability)
+    .def_readwrite("toggleEdgeMutationChance", &NEAT::MutationConfig<dType>::mutateToggleEdgeProbability)
+    .def_readwrite("weightMutationChance", &NEAT::MutationConfig<dType>::mutateWeightProbability)
+    .def_readwrite("activationMutationChance", &NEAT::MutationConfig<dType>::mutateActivationFunctionProbability)
+    .def_readwrite("biasMutationChance", &NEAT::MutationConfig<dType>::mutateBiasProbability)
+    .def_readwrite("innovationMaxAge", &NEAT::MutationConfig<dType>::innovationMaxAge);
+
+  pySpeciesConfig.def(py::init<dType, dType, dType, dType, unsigned int, unsigned int>(),
     py::arg("c1") = 1,
     py::arg("c2") = 1,
     py::arg("c3") = 0.4,
-    py::arg("threshold") = 3
+    py::arg("threshold") = 3,
+    py::arg("numThreads") = 1,
+    py::arg("stagnationLimit") = 15
   )
-    .def_readwrite("c1", &NEAT::SpeciesConfig<double>::c1)
-    .def_readwrite("c2", &NEAT::SpeciesConfig<double>::c2)
-    .def_readwrite("c3", &NEAT::SpeciesConfig<double>::c3)
-    .def_readwrite("threshold", &NEAT::SpeciesConfig<double>::threshold);
+    .def_readwrite("c1", &NEAT::SpeciesConfig<dType>::c1)
+    .def_readwrite("c2", &NEAT::SpeciesConfig<dType>::c2)
+    .def_readwrite("c3", &NEAT::SpeciesConfig<dType>::c3)
+    .def_readwrite("threshold", &NEAT::SpeciesConfig<dType>::threshold)
+    .def_readwrite("numThreads", &NEAT::SpeciesConfig<dType>::numThreads)
+    .def_readwrite("stagnationLimit", &NEAT::SpeciesConfig<dType>::stagnationLimit);
   // 
 
   pyPopulation.def(
-    py::init<int, int, int, NEAT::MutationConfig<double>, NEAT::SpeciesConfig<double>>(),
+    py::init<int, int, int, NEAT::MutationConfig<dType>, NEAT::SpeciesConfig<dType>>(),
     py::arg("inputSize"),
     py::arg("outputSize"),
     py::arg("populationSize"),
@@ -74,84 +226,138 @@ PYBIND11_MODULE(_neatcpy, m) {
     py::arg("speciesConfig")
   )
     .def("startNextGeneration",
-      py::overload_cast<>(&NEAT::Population<double, int>::startNextGeneration), py::return_value_policy::reference
+      py::overload_cast<>(&NEAT::Population<dType, int>::startNextGeneration), py::return_value_policy::reference
     )
     .def("startNextGeneration",
-      py::overload_cast<int>(&NEAT::Population<double, int>::startNextGeneration), py::arg("populationSize"), py::return_value_policy::reference
+      py::overload_cast<int>(&NEAT::Population<dType, int>::startNextGeneration), py::arg("populationSize"), py::return_value_policy::reference
     )
+    // NumPy overloads come first, so arrays of another dtype or layout are cast by NumPy in the converting pass
+    // instead of being converted element-wise into a list
     .def("startNextGeneration",
-      py::overload_cast<std::vector<double>>(&NEAT::Population<double, int>::startNextGeneration), py::arg("fitnesses"), py::return_value_policy::reference
+      [](NEAT::Population<dType, int>& population, const NumpyArray<dType>& fitnesses) -> const std::vector<NEAT::Genome<dType, int>*>& {
+        return startNextGeneration<dType>(population, population.getPopulationSize(), fitnesses);
+      }, py::arg("fitnesses"), py::return_value_policy::reference
+    )
+    .def("startNextGeneration", &startNextGeneration<dType>,
+      py::arg("populationSize"), py::arg("fitnesses"), py::return_value_policy::reference
     )
     .def("startNextGeneration",
-      py::overload_cast<int, std::vector<double>>(&NEAT::Population<double, int>::startNextGeneration), py::arg("populationSize"), py::arg("fitnesses"), py::return_value_policy::reference
+      py::overload_cast<const std::vector<dType>&>(&NEAT::Population<dType, int>::startNextGeneration), py::arg("fitnesses"), py::return_value_policy::reference
+    )
+    .def("startNextGeneration",
+      py::overload_cast<int, const std::vector<dType>&>(&NEAT::Population<dType, int>::startNextGeneration), py::arg("populationSize"), py::arg("fitnesses"), py::return_value_policy::reference
+    )
+    .def("evaluate", &evaluate<dType>, py::arg("fitnessFunction"), py::arg("numThreads") = 0)
+    .def("evaluateSupervised", &evaluateSupervised<dType>,
+      py::arg("inputs"), py::arg("targets"), py::arg("numThreads") = 0
     )
+    .def("evaluateSupervised",
+      py::overload_cast<const std::vector<dType>&, const std::vector<dType>&, unsigned int>(&NEAT::Population<dType, int>::evaluateSupervised),
+      py::arg("inputs"), py::arg("targets"), py::arg("numThreads") = 0,
+      py::call_guard<py::gil_scoped_release>()
+    )
+    .def("step", &step<dType>, py::arg("observations"), py::arg("numThreads") = 0)
+    .def("stepPredict", &stepPredict<dType>, py::arg("observations"), py::arg("numThreads") = 0)
     // 
-    .def("getGenomes", &NEAT::Population<double, int>::getGenomes, py::return_value_policy::reference)
-    .def("getGenome", &NEAT::Population<double, int>::getGenome, py::arg("index"), py::return_value_policy::reference)
+    .def("getGenomes", &NEAT::Population<dType, int>::getGenomes, py::return_value_policy::reference)
+    .def("getGenome", &NEAT::Population<dType, int>::getGenome, py::arg("index"), py::return_value_policy::reference)
     // 
-    .def("getPopulationSize", &NEAT::Population<double, int>::getPopulationSize, py::return_value_policy::reference)
-    .def("getInputSize", &NEAT::Population<double, int>::getInputSize, py::return_value_policy::reference)
-    .def("getOutputSize", &NEAT::Population<double, int>::getOutputSize, py::return_value_policy::reference)
-    .def("getGeneration", &NEAT::Population<double, int>::getGeneration, py::return_value_policy::reference)
-    .def("getMutationConfig", &NEAT::Population<double, int>::getMutationConfig, py::return_value_policy::reference)
-    .def("getSpeciesConfig", &NEAT::Population<double, int>::getSpeciesConfig, py::return_value_policy::reference)
+    .def("getPopulationSize", &NEAT::Population<dType, int>::getPopulationSize, py::return_value_policy::reference)
+    .def("getInputSize", &NEAT::Population<dType, int>::getInputSize, py::return_value_policy::reference)
+    .def("getOutputSize", &NEAT::Population<dType, int>::getOutputSize, py::return_value_policy::reference)
+    .def("getGeneration", &NEAT::Population<dType, int>::getGeneration, py::return_value_policy::reference)
+    .def("getMutationConfig", &NEAT::Population<dType, int>::getMutationConfig, py::return_value_policy::reference)
+    .def("getSpeciesConfig", &NEAT::Population<dType, int>::getSpeciesConfig, py::return_value_policy::reference)
+    .def("getNumberOfSpecies", &NEAT::Population<dType, int>::getNumberOfSpecies)
+    .def("getGeneHistory", &NEAT::Population<dType, int>::getGeneHistory, py::return_value_policy::reference_internal)
     // 
-    .def("getBestFitnessHistory", &NEAT::Population<double, int>::getBestFitnessHistory, py::return_value_policy::reference)
-    .def("getAverageFitnessHistory", &NEAT::Population<double, int>::getAverageFitnessHistory, py::return_value_policy::reference)
-    .def("getWorstFitnessHistory", &NEAT::Population<double, int>::getWorstFitnessHistory, py::return_value_policy::reference)
-    .def("getBestGenomeHistory", &NEAT::Population<double, int>::getBestGenomeHistory, py::return_value_policy::reference)
+    .def("getBestFitnessHistory", &NEAT::Population<dType, int>::getBestFitnessHistory, py::return_value_policy::reference)
+    .def("getAverageFitnessHistory", &NEAT::Population<dType, int>::getAverageFitnessHistory, py::return_value_policy::reference)
+    .def("getWorstFitnessHistory", &NEAT::Population<dType, int>::getWorstFitnessHistory, py::return_value_policy::reference)
+    .def("getBestGenomeHistory", &NEAT::Population<dType, int>::getBestGenomeHistory, py::return_value_policy::reference)
     // 
-    .def("setMutationConfig", &NEAT::Population<double, int>::setMutationConfig, py::arg("mutationConfig"))
-    .def("setSpeciesConfig", &NEAT::Population<double, int>::setSpeciesConfig, py::arg("speciesConfig"))
+    .def("setMutationConfig", &NEAT::Population<dType, int>::setMutationConfig, py::arg("mutationConfig"))
+    .def("setSpeciesConfig", &NEAT::Population<dType, int>::setSpeciesConfig, py::arg("speciesConfig"))
+    .def("setEvaluationMode", &NEAT::Population<dType, int>::setEvaluationMode, py::arg("evaluationMode"))
+    .def("getEvaluationMode", &NEAT::Population<dType, int>::getEvaluationMode)
     // 
-    .def("print", &NEAT::Population<double, int>::print, py::arg("tabSize") = 0);
+    .def("print", &NEAT::Population<dType, int>::print, py::arg("tabSize") = 0);
   // 
   // 
   pyGenome.def(py::init<int, int, bool>(), py::arg("inputSize"), py::arg("outputSize"), py::arg("init") = true)
-    .def("getInputSize", &NEAT::Genome<double, int>::getInputSize, py::return_value_policy::reference)
-    .def("getOutputSize", &NEAT::Genome<double, int>::getOutputSize, py::return_value_policy::reference)
+    .def("getInputSize", &NEAT::Genome<dType, int>::getInputSize, py::return_value_policy::reference)
+    .def("getOutputSize", &NEAT::Genome<dType, int>::getOutputSize, py::return_value_policy::reference)
     // 
-    .def("getNodes", &NEAT::Genome<double, int>::getNodes, py::return_value_policy::reference)
-    .def("getEdges", &NEAT::Genome<double, int>::getEdges, py::return_value_policy::reference)
-    .def("getEdge", &NEAT::Genome<double, int>::getEdge,
+    .def("getNodes", &NEAT::Genome<dType, int>::getNodes, py::return_value_policy::reference)
+    .def("getEdges", &NEAT::Genome<dType, int>::getEdges, py::return_value_policy::reference)
+    .def("getEdge", &NEAT::Genome<dType, int>::getEdge,
       py::arg("innovationNumber"),
       py::return_value_policy::reference)
-    .def("getNode", &NEAT::Genome<double, int>::getNode,
+    .def("getNode", &NEAT::Genome<dType, int>::getNode,
       py::arg("id"),
       py::return_value_policy::reference)
     // 
-    .def("addCloneEdge", &NEAT::Genome<double, int>::addCloneEdge,
+    .def("addCloneEdge", &NEAT::Genome<dType, int>::addCloneEdge,
       py::arg("edge"),
       py::return_value_policy::reference)
-    .def("addCloneNode", &NEAT::Genome<double, int>::addCloneNode,
+    .def("addCloneNode", &NEAT::Genome<dType, int>::addCloneNode,
       py::arg("node"), py::return_value_policy::reference)
-    .def("addNode_noClone", &NEAT::Genome<double, int>::addNode_noClone,
+    .def("addNode_noClone", &NEAT::Genome<dType, int>::addNode_noClone,
       py::arg("node"), py::return_value_policy::reference)
-    .def("disableEdge", &NEAT::Genome<double, int>::disableEdge,
+    .def("disableEdge", &NEAT::Genome<dType, int>::disableEdge,
       py::arg("innovationNumber"))
-    .def("enableEdge", &NEAT::Genome<double, int>::enableEdge,
+    .def("enableEdge", &NEAT::Genome<dType, int>::enableEdge,
       py::arg("innovationNumber"))
-    .def("toggleEdge", &NEAT::Genome<double, int>::toggleEdge,
+    .def("toggleEdge", &NEAT::Genome<dType, int>::toggleEdge,
       py::arg("innovationNumber"))
     // 
-    .def("getMaxInnovationNumber", &NEAT::Genome<double, int>::getMaxInnovationNumber)
-    .def("getNumberOfGenes", &NEAT::Genome<double, int>::getNumberOfGenes)
+    .def("getMaxInnovationNumber", &NEAT::Genome<dType, int>::getMaxInnovationNumber)
+    .def("getNumberOfGenes", &NEAT::Genome<dType, int>::getNumberOfGenes)
     // 
-    .def("setFitness", &NEAT::Genome<double, int>::setFitness, py::arg("fitness"))
-    .def("getFitness", &NEAT::Genome<double, int>::getFitness, py::return_value_policy::reference)
+    .def("setFitness", &NEAT::Genome<dType, int>::setFitness, py::arg("fitness"))
+    .def("getFitness", &NEAT::Genome<dType, int>::getFitness, py::return_value_policy::reference)
+    .def("getSpeciesId", &NEAT::Genome<dType, int>::getSpeciesId)
     // 
-    .def("mutate", &NEAT::Genome<double, int>::mutate,
+    .def("mutate", &NEAT::Genome<dType, int>::mutate,
       py::arg("geneHistory"),
-      py::arg("mutationConfig") = NEAT::MutationConfig<double>()
+      py::arg("mutationConfig") = NEAT::MutationConfig<dType>()
     )
-    .def("feedForward", py::overload_cast<const std::vector<double>&>(&NEAT::Genome<double, int>::feedForward),
+    .def("feedForward", py::overload_cast<const std::vector<dType>&>(&NEAT::Genome<dType, int>::feedForward),
       py::arg("inputs")
     )
-    .def("predict", &NEAT::Genome<double, int>::predict,
+    .def("predict", py::overload_cast<const std::vector<dType>&>(&NEAT::Genome<dType, int>::predict),
       py::arg("inputs")
     )
-    .def("clone", &NEAT::Genome<double, int>::clone)
-    .def("print", &NEAT::Genome<double, int>::print, py::arg("tabSize") = 0);
+    .def("feedForwardBatch", &feedForwardBatch<dType>, py::arg("inputs"))
+    .def("exportHeader", &NEAT::HeaderExporter<dType, int>::write, py::arg("path"), py::arg("name"))
+    .def("clone", &NEAT::Genome<dType, int>::clone)
+    .def("print", &NEAT::Genome<dType, int>::print, py::arg("tabSize") = 0);
+  // 
+  pyGeneHistory.def(py::init<>())
+    .def("init", &NEAT::GeneHistory<dType, int>::init, py::arg("inputSize"), py::arg("outputSize"))
+    .def("setGeneration", &NEAT::GeneHistory<dType, int>::setGeneration, py::arg("generation"))
+    .def("getGeneration", &NEAT::GeneHistory<dType, int>::getGeneration)
+    .def("expire", &NEAT::GeneHistory<dType, int>::expire, py::arg("maxAge"))
+    .def("size", &NEAT::GeneHistory<dType, int>::size);
+}
+
+PYBIND11_MODULE(_neatcpy, m) {
+  m.doc() = "NEATCPP Python Bindings";
+
+  m.def("add", &add, "A function which adds two numbers");
+
+
+  m.def("setRandomSeed", &NEAT::setRandomSeed);
+  m.def("setSeed", &NEAT::setSeed);
+  m.def("getSeed", &NEAT::getSeed, py::return_value_policy::copy);
+  // types without data type are bound once and shared with the float32 module
+  py::enum_<NEAT::EvaluationMode>(m, "EvaluationMode")
+    .value("GENOME", NEAT::EvaluationMode::GENOME)
+    .value("TOPOLOGY_GROUPS", NEAT::EvaluationMode::TOPOLOGY_GROUPS)
+    .value("POPULATION_GRAPH", NEAT::EvaluationMode::POPULATION_GRAPH);
   // 
-  pyGeneHistory.def(py::init<>());
+  defineModule<double>(m);
+  py::module_ float32 = m.def_submodule("float32", "NEATCPP Python Bindings with single precision (float) data");
+  float32.attr("EvaluationMode") = m.attr("EvaluationMode");
+  defineModule<float>(float32);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 from __future__ import annotations
 from ._neatcpy import (
     Edge,
+    EvaluationMode,
     GeneHistory,
     Genome,
     MutationConfig,
@@ -13,9 +14,11 @@ from ._neatcpy import (
     setSeed
     
 )
+from . import float32
 
 __all__: list = [
     "Edge",
+    "EvaluationMode",
     "GeneHistory",
     "Genome",
     "MutationConfig",
@@ -25,5 +28,6 @@ __all__: list = [
     "add",
     "gaussianDistribution",
     "getSeed",
-    "setSeed"
+    "setSeed",
+    "float32"
 ]
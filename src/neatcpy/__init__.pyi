@@ -1,5 +1,6 @@
 from __future__ import annotations
 from neatcpy._neatcpy import Edge
+from neatcpy._neatcpy import EvaluationMode
 from neatcpy._neatcpy import GeneHistory
 from neatcpy._neatcpy import Genome
 from neatcpy._neatcpy import MutationConfig
@@ -11,4 +12,5 @@ from neatcpy._neatcpy import gaussianDistribution
 from neatcpy._neatcpy import getSeed
 from neatcpy._neatcpy import setSeed
 from . import _neatcpy
-__all__: list = ['Edge', 'GeneHistory', 'Genome', 'MutationConfig', 'Node', 'Population', 'SpeciesConfig', 'add', 'gaussianDistribution', 'getSeed', 'setSeed']
+from . import float32
+__all__: list = ['Edge', 'EvaluationMode', 'GeneHistory', 'Genome', 'MutationConfig', 'Node', 'Population', 'SpeciesConfig', 'add', 'gaussianDistribution', 'getSeed', 'setSeed', 'float32']
@@ -0,0 +1,27 @@
+"""
+NEATCPP Python Bindings with single precision (float) data, same classes as neatcpy with half the memory per value
+"""
+from __future__ import annotations
+from ._neatcpy import float32 as _float32
+
+Edge = _float32.Edge
+EvaluationMode = _float32.EvaluationMode
+GeneHistory = _float32.GeneHistory
+Genome = _float32.Genome
+MutationConfig = _float32.MutationConfig
+Node = _float32.Node
+Population = _float32.Population
+SpeciesConfig = _float32.SpeciesConfig
+gaussianDistribution = _float32.gaussianDistribution
+
+__all__: list = [
+    "Edge",
+    "EvaluationMode",
+    "GeneHistory",
+    "Genome",
+    "MutationConfig",
+    "Node",
+    "Population",
+    "SpeciesConfig",
+    "gaussianDistribution"
+]
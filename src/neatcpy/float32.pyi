@@ -0,0 +1,205 @@
+"""
+NEATCPP Python Bindings with single precision (float) data
+"""
+from __future__ import annotations
+import numpy
+import typing
+__all__ = ['Edge', 'EvaluationMode', 'GeneHistory', 'Genome', 'MutationConfig', 'Node', 'Population', 'SpeciesConfig', 'gaussianDistribution']
+class Edge:
+    pass
+class EvaluationMode:
+    """
+    Members:
+    
+      GENOME
+    
+      TOPOLOGY_GROUPS
+    
+      POPULATION_GRAPH
+    """
+    GENOME: typing.ClassVar[EvaluationMode]  # value = <EvaluationMode.GENOME: 0>
+    POPULATION_GRAPH: typing.ClassVar[EvaluationMode]  # value = <EvaluationMode.POPULATION_GRAPH: 2>
+    TOPOLOGY_GROUPS: typing.ClassVar[EvaluationMode]  # value = <EvaluationMode.TOPOLOGY_GROUPS: 1>
+    __members__: typing.ClassVar[dict[str, EvaluationMode]]  # value = {'GENOME': <EvaluationMode.GENOME: 0>, 'TOPOLOGY_GROUPS': <EvaluationMode.TOPOLOGY_GROUPS: 1>, 'POPULATION_GRAPH': <EvaluationMode.POPULATION_GRAPH: 2>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: int) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: int) -> None:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class GeneHistory:
+    def __init__(self) -> None:
+        ...
+    def expire(self, maxAge: int) -> int:
+        ...
+    def getGeneration(self) -> int:
+        ...
+    def init(self, inputSize: int, outputSize: int) -> None:
+        ...
+    def setGeneration(self, generation: int) -> None:
+        ...
+    def size(self) -> int:
+        ...
+class Genome:
+    def __init__(self, inputSize: int, outputSize: int, init: bool = ...) -> None:
+        ...
+    def addCloneEdge(self, edge: Edge) -> bool:
+        ...
+    def addCloneNode(self, node: Node) -> bool:
+        ...
+    def addNode_noClone(self, node: Node) -> bool:
+        ...
+    def clone(self) -> Genome:
+        ...
+    def disableEdge(self, innovationNumber: int) -> None:
+        ...
+    def enableEdge(self, innovationNumber: int) -> None:
+        ...
+    def exportHeader(self, path: str, name: str) -> None:
+        ...
+    def feedForward(self, inputs: list[float]) -> list[float]:
+        ...
+    def feedForwardBatch(self, inputs: numpy.ndarray[numpy.float32]) -> numpy.ndarray[numpy.float32]:
+        ...
+    def getEdge(self, innovationNumber: int) -> Edge:
+        ...
+    def getEdges(self) -> dict[int, Edge]:
+        ...
+    def getFitness(self) -> float:
+        ...
+    def getInputSize(self) -> int:
+        ...
+    def getMaxInnovationNumber(self) -> int:
+        ...
+    def getNode(self, id: int) -> Node:
+        ...
+    def getNodes(self) -> dict[int, Node]:
+        ...
+    def getNumberOfGenes(self) -> int:
+        ...
+    def getOutputSize(self) -> int:
+        ...
+    def getSpeciesId(self) -> int:
+        ...
+    def mutate(self, geneHistory: GeneHistory, mutationConfig: MutationConfig = ...) -> None:
+        ...
+    def predict(self, inputs: list[float]) -> int:
+        ...
+    def print(self, tabSize: int = ...) -> None:
+        ...
+    def setFitness(self, fitness: float) -> None:
+        ...
+    def toggleEdge(self, innovationNumber: int) -> None:
+        ...
+class MutationConfig:
+    activationMutationChance: float
+    biasMutationChance: float
+    edgeMutationChance: float
+    innovationMaxAge: int
+    nodeMutationChance: float
+    toggleEdgeMutationChance: float
+    weightMutationChance: float
+    def __init__(self, nodeMutationChance: float = ..., edgeMutationChance: float = ..., toggleEdgeMutationChance: float = ..., weightMutationChance: float = ..., activationMutationChance: float = ..., biasMutationChance: float = ..., innovationMaxAge: int = ...) -> None:
+        ...
+class Node:
+    pass
+class Population:
+    def __init__(self, inputSize: int, outputSize: int, populationSize: int, mutationConfig: MutationConfig, speciesConfig: SpeciesConfig) -> None:
+        ...
+    def evaluate(self, fitnessFunction: typing.Callable[[Genome], float], numThreads: int = ...) -> None:
+        ...
+    @typing.overload
+    def evaluateSupervised(self, inputs: numpy.ndarray[numpy.float32], targets: numpy.ndarray[numpy.float32], numThreads: int = ...) -> None:
+        ...
+    @typing.overload
+    def evaluateSupervised(self, inputs: list[float], targets: list[float], numThreads: int = ...) -> None:
+        ...
+    def getAverageFitnessHistory(self) -> list[float]:
+        ...
+    def getEvaluationMode(self) -> EvaluationMode:
+        ...
+    def getBestFitnessHistory(self) -> list[float]:
+        ...
+    def getBestGenomeHistory(self) -> list[Genome]:
+        ...
+    def getGeneHistory(self) -> GeneHistory:
+        ...
+    def getGeneration(self) -> int:
+        ...
+    def getGenome(self, index: int) -> Genome:
+        ...
+    def getGenomes(self) -> list[Genome]:
+        ...
+    def getInputSize(self) -> int:
+        ...
+    def getMutationConfig(self) -> MutationConfig:
+        ...
+    def getNumberOfSpecies(self) -> int:
+        ...
+    def getOutputSize(self) -> int:
+        ...
+    def getPopulationSize(self) -> int:
+        ...
+    def getSpeciesConfig(self) -> SpeciesConfig:
+        ...
+    def getWorstFitnessHistory(self) -> list[float]:
+        ...
+    def print(self, tabSize: int = ...) -> None:
+        ...
+    def setEvaluationMode(self, evaluationMode: EvaluationMode) -> None:
+        ...
+    def setMutationConfig(self, mutationConfig: MutationConfig) -> None:
+        ...
+    def setSpeciesConfig(self, speciesConfig: SpeciesConfig) -> None:
+        ...
+    def step(self, observations: numpy.ndarray[numpy.float32], numThreads: int = ...) -> numpy.ndarray[numpy.float32]:
+        ...
+    def stepPredict(self, observations: numpy.ndarray[numpy.float32], numThreads: int = ...) -> numpy.ndarray[numpy.int32]:
+        ...
+    @typing.overload
+    def startNextGeneration(self) -> list[Genome]:
+        ...
+    @typing.overload
+    def startNextGeneration(self, populationSize: int) -> list[Genome]:
+        ...
+    @typing.overload
+    def startNextGeneration(self, fitnesses: numpy.ndarray[numpy.float32]) -> list[Genome]:
+        ...
+    @typing.overload
+    def startNextGeneration(self, populationSize: int, fitnesses: numpy.ndarray[numpy.float32]) -> list[Genome]:
+        ...
+    @typing.overload
+    def startNextGeneration(self, fitnesses: list[float]) -> list[Genome]:
+        ...
+    @typing.overload
+    def startNextGeneration(self, populationSize: int, fitnesses: list[float]) -> list[Genome]:
+        ...
+class SpeciesConfig:
+    c1: float
+    c2: float
+    c3: float
+    numThreads: int
+    stagnationLimit: int
+    threshold: float
+    def __init__(self, c1: float = ..., c2: float = ..., c3: float = ..., threshold: float = ..., numThreads: int = ..., stagnationLimit: int = ...) -> None:
+        ...
+def gaussianDistribution(mean: float, stdDeviation: float) -> float:
+    ...